@@ -137,6 +137,8 @@ static void *MFC_Decoder_Init(int nMemoryType)
     pCtx->bStreamonOutbuf = VIDEO_FALSE;
 
     pCtx->nMemoryType = nMemoryType;
+    pCtx->bStatusExtCtrl = VIDEO_TRUE;
+    pCtx->bFrameTagValid = VIDEO_FALSE;
 
     pMutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
     if (pMutex == NULL) {
@@ -302,6 +304,13 @@ static int MFC_Decoder_Get_FrameTag(void *pHandle)
         goto EXIT;
     }
 
+    /* already fetched with the display status when the buffer was dequeued */
+    if (pCtx->bFrameTagValid == VIDEO_TRUE) {
+        pCtx->bFrameTagValid = VIDEO_FALSE;
+        frameTag = pCtx->frameTag;
+        goto EXIT;
+    }
+
     exynos_v4l2_g_ctrl(pCtx->hDec, V4L2_CID_MPEG_MFC51_VIDEO_FRAME_TAG, &frameTag);
 
 EXIT:
@@ -1581,6 +1590,40 @@ EXIT:
     return pInbuf;
 }
 
+/*
+ * Display status and frame tag of the output buffer just dequeued
+ */
+static int MFC_Decoder_Get_Outbuf_Status(ExynosVideoDecContext *pCtx)
+{
+    struct v4l2_ext_control  ext_ctrl[2];
+    struct v4l2_ext_controls ext_ctrls;
+    int value = -1;
+
+    if (pCtx->bStatusExtCtrl == VIDEO_TRUE) {
+        memset(ext_ctrl, 0, sizeof(ext_ctrl));
+        ext_ctrls.ctrl_class = V4L2_CTRL_CLASS_MPEG;
+        ext_ctrls.count = 2;
+        ext_ctrls.controls = ext_ctrl;
+        ext_ctrl[0].id = V4L2_CID_MPEG_MFC51_VIDEO_DISPLAY_STATUS;
+        ext_ctrl[1].id = V4L2_CID_MPEG_MFC51_VIDEO_FRAME_TAG;
+
+        if (exynos_v4l2_g_ext_ctrl(pCtx->hDec, &ext_ctrls) == 0) {
+            pCtx->frameTag = ext_ctrl[1].value;
+            pCtx->bFrameTagValid = VIDEO_TRUE;
+            return ext_ctrl[0].value;
+        }
+
+        /* driver without batched status, use one control per query from now on */
+        ALOGW("%s: G_EXT_CTRLS not supported, fall back to G_CTRL", __func__);
+        pCtx->bStatusExtCtrl = VIDEO_FALSE;
+    }
+
+    pCtx->bFrameTagValid = VIDEO_FALSE;
+    exynos_v4l2_g_ctrl(pCtx->hDec, V4L2_CID_MPEG_MFC51_VIDEO_DISPLAY_STATUS, &value);
+
+    return value;
+}
+
 /*
  * [Decoder Buffer OPS] Dequeue (Output)
  */
@@ -1623,7 +1666,7 @@ static ExynosVideoBuffer *MFC_Decoder_Dequeue_Outbuf(void *pHandle)
 
     pOutbuf = &pCtx->pOutbuf[buf.index];
 
-    exynos_v4l2_g_ctrl(pCtx->hDec, V4L2_CID_MPEG_MFC51_VIDEO_DISPLAY_STATUS, &value);
+    value = MFC_Decoder_Get_Outbuf_Status(pCtx);
 
     switch (value) {
     case 0:
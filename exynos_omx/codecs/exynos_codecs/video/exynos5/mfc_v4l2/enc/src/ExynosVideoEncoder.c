@@ -823,6 +823,67 @@ EXIT:
     return ret;
 }
 
+/*
+ * [Encoder OPS] Set Dynamic Params
+ * applies every runtime change of pDynamicParam->nDirtyMask in one call,
+ * so they all take effect from the same frame
+ */
+static ExynosVideoErrorType MFC_Encoder_Set_DynamicParams(
+    void                       *pHandle,
+    ExynosVideoEncDynamicParam *pDynamicParam)
+{
+    ExynosVideoEncContext *pCtx = (ExynosVideoEncContext *)pHandle;
+    ExynosVideoErrorType   ret  = VIDEO_ERROR_NONE;
+
+    struct v4l2_ext_control  ext_ctrl[4];
+    struct v4l2_ext_controls ext_ctrls;
+    int count = 0;
+
+    if ((pCtx == NULL) || (pDynamicParam == NULL)) {
+        ALOGE("%s: Video context info must be supplied", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    if (pDynamicParam->nDirtyMask & VIDEO_ENC_DYNAMIC_FRAME_TYPE) {
+        ext_ctrl[count].id = V4L2_CID_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE;
+        ext_ctrl[count].value = pDynamicParam->FrameType;
+        count++;
+    }
+    if (pDynamicParam->nDirtyMask & VIDEO_ENC_DYNAMIC_IDR_PERIOD) {
+        ext_ctrl[count].id = V4L2_CID_MPEG_MFC51_VIDEO_I_PERIOD_CH;
+        ext_ctrl[count].value = pDynamicParam->IDRPeriod;
+        count++;
+    }
+    if (pDynamicParam->nDirtyMask & VIDEO_ENC_DYNAMIC_BIT_RATE) {
+        ext_ctrl[count].id = V4L2_CID_MPEG_MFC51_VIDEO_BIT_RATE_CH;
+        ext_ctrl[count].value = pDynamicParam->Bitrate;
+        count++;
+    }
+    if (pDynamicParam->nDirtyMask & VIDEO_ENC_DYNAMIC_FRAME_RATE) {
+        ext_ctrl[count].id = V4L2_CID_MPEG_MFC51_VIDEO_FRAME_RATE_CH;
+        ext_ctrl[count].value = pDynamicParam->FrameRate;
+        count++;
+    }
+
+    if (count == 0)
+        goto EXIT;
+
+    memset(&ext_ctrls, 0, sizeof(ext_ctrls));
+    ext_ctrls.ctrl_class = V4L2_CTRL_CLASS_MPEG;
+    ext_ctrls.count = count;
+    ext_ctrls.controls = ext_ctrl;
+
+    if (exynos_v4l2_s_ext_ctrl(pCtx->hEnc, &ext_ctrls) != 0) {
+        ALOGE("%s: Failed to s_ext_ctrl", __func__);
+        ret = VIDEO_ERROR_APIFAIL;
+        goto EXIT;
+    }
+
+EXIT:
+    return ret;
+}
+
 /*
  * [Encoder Buffer OPS] Enable Cacheable (Input)
  */
@@ -2254,6 +2315,7 @@ static ExynosVideoEncOps defEncOps = {
     .Set_BitRate    = MFC_Encoder_Set_BitRate,
     .Set_FrameSkip  = MFC_Encoder_Set_FrameSkip,
     .Set_IDRPeriod  = MFC_Encoder_Set_IDRPeriod,
+    .Set_DynamicParams = MFC_Encoder_Set_DynamicParams,
     .Set_FrameTag   = MFC_Encoder_Set_FrameTag,
     .Get_FrameTag   = MFC_Encoder_Get_FrameTag,
 };
@@ -215,6 +215,21 @@ typedef struct _ExynosVideoEncParam {
     ExynosVideoEncCodecParam    codecParam;
 } ExynosVideoEncParam;
 
+typedef enum _ExynosVideoEncDynamicParamMask {
+    VIDEO_ENC_DYNAMIC_FRAME_TYPE = 0x1,
+    VIDEO_ENC_DYNAMIC_IDR_PERIOD = 0x2,
+    VIDEO_ENC_DYNAMIC_BIT_RATE   = 0x4,
+    VIDEO_ENC_DYNAMIC_FRAME_RATE = 0x8,
+} ExynosVideoEncDynamicParamMask;
+
+typedef struct _ExynosVideoEncDynamicParam {
+    unsigned int         nDirtyMask;    /* [IN] ExynosVideoEncDynamicParamMask bits to apply */
+    ExynosVideoFrameType FrameType;     /* [IN] forced type of the next frame */
+    int                  IDRPeriod;     /* [IN] GOP number(interval of I-frame) */
+    int                  Bitrate;       /* [IN] rate control parameter(bit rate) */
+    int                  FrameRate;     /* [IN] rate control parameter(frame rate) */
+} ExynosVideoEncDynamicParam;
+
 typedef struct _ExynosVideoDecOps {
     unsigned int            nSize;
 
@@ -247,6 +262,7 @@ typedef struct _ExynosVideoEncOps {
     ExynosVideoErrorType (*Set_BitRate)(void *pHandle, int bitRate);
     ExynosVideoErrorType (*Set_FrameSkip)(void *pHandle, int frameSkip);
     ExynosVideoErrorType (*Set_IDRPeriod)(void *pHandle, int period);
+    ExynosVideoErrorType (*Set_DynamicParams)(void *pHandle, ExynosVideoEncDynamicParam *pDynamicParam);
 } ExynosVideoEncOps;
 
 typedef struct _ExynosVideoDecBufferOps {
@@ -45,6 +45,9 @@ typedef struct _ExynosVideoDecContext {
     void                *pInMutex;
     void                *pOutMutex;
     int                  nMemoryType;
+    ExynosVideoBoolType  bStatusExtCtrl;    /* display status and frame tag in one G_EXT_CTRLS */
+    ExynosVideoBoolType  bFrameTagValid;
+    int                  frameTag;          /* of the last dequeued output buffer */
 } ExynosVideoDecContext;
 
 #endif /* _EXYNOS_VIDEO_DEC_H_ */
@@ -27,11 +27,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "Exynos_OMX_Resourcemanager.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OSAL_Memory.h"
 #include "Exynos_OSAL_Mutex.h"
+#include "Exynos_OSAL_Event.h"
 
 #undef  EXYNOS_LOG_TAG
 #define EXYNOS_LOG_TAG    "EXYNOS_RM"
@@ -42,6 +44,11 @@
 #define MAX_RESOURCE_VIDEO_DEC 3 /* for Android */
 #define MAX_RESOURCE_VIDEO_ENC 1 /* for Android */
 
+#define MAX_SCHED_DEPTH        3   /* MFC_INPUT_BUFFER_NUM_MAX of the video components */
+#define MAX_SCHED_WEIGHT       8   /* credits per round for group priority 0 */
+#define MAX_SCHED_WAIT_TIME    20  /* ms, then the frame goes in regardless */
+#define MAX_SCHED_STALL_TIME   100 /* ms without a returned frame, then the instance is not draining */
+
 /* Max allowable video scheduler component instance */
 static EXYNOS_OMX_RM_COMPONENT_LIST *gpVideoDecRMComponentList = NULL;
 static EXYNOS_OMX_RM_COMPONENT_LIST *gpVideoDecRMWaitingList = NULL;
@@ -49,6 +56,10 @@ static EXYNOS_OMX_RM_COMPONENT_LIST *gpVideoEncRMComponentList = NULL;
 static EXYNOS_OMX_RM_COMPONENT_LIST *gpVideoEncRMWaitingList = NULL;
 static OMX_HANDLETYPE ghVideoRMComponentListMutex = NULL;
 
+/* MFC submission scheduler, shared by all video decoder and encoder instances */
+static EXYNOS_OMX_SCHED_COMPONENT *gpVideoSchedList = NULL;
+static OMX_HANDLETYPE ghVideoSchedMutex = NULL;
+
 
 OMX_ERRORTYPE addElementList(EXYNOS_OMX_RM_COMPONENT_LIST **ppList, OMX_COMPONENTTYPE *pOMXComponent)
 {
@@ -188,6 +199,202 @@ EXIT:
     return ret;
 }
 
+static OMX_TICKS getSchedTime()
+{
+    struct timespec now;
+
+    /* deadlines must not jump with wall-clock changes */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((OMX_TICKS)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+EXYNOS_OMX_SCHED_COMPONENT *findSchedComponent(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    EXYNOS_OMX_SCHED_COMPONENT *pTempComp = gpVideoSchedList;
+
+    while (pTempComp != NULL) {
+        if (pTempComp->pOMXStandComp == pOMXComponent)
+            break;
+        pTempComp = pTempComp->pNext;
+    }
+
+    return pTempComp;
+}
+
+void freeSchedComponent(EXYNOS_OMX_SCHED_COMPONENT *pSchedComp)
+{
+    Exynos_OSAL_SignalTerminate(pSchedComp->hGrantEvent);
+    Exynos_OSAL_Free(pSchedComp);
+}
+
+void wakeSchedComponent()
+{
+    EXYNOS_OMX_SCHED_COMPONENT *pTempComp = gpVideoSchedList;
+
+    while (pTempComp != NULL) {
+        if (pTempComp->bWaiting == OMX_TRUE)
+            Exynos_OSAL_SignalSet(pTempComp->hGrantEvent);
+        pTempComp = pTempComp->pNext;
+    }
+}
+
+/* waiting instance with credits left and the earliest deadline */
+EXYNOS_OMX_SCHED_COMPONENT *pickSchedComponent()
+{
+    EXYNOS_OMX_SCHED_COMPONENT *pTempComp = NULL;
+    EXYNOS_OMX_SCHED_COMPONENT *pCandidateComp = NULL;
+    OMX_BOOL bWaiting = OMX_FALSE;
+    int round;
+
+    for (round = 0; round < 2; round++) {
+        for (pTempComp = gpVideoSchedList; pTempComp != NULL; pTempComp = pTempComp->pNext) {
+            if (pTempComp->bWaiting == OMX_FALSE)
+                continue;
+            bWaiting = OMX_TRUE;
+            if (pTempComp->credit == 0)
+                continue;
+            if ((pCandidateComp == NULL) || (pTempComp->deadline < pCandidateComp->deadline))
+                pCandidateComp = pTempComp;
+        }
+        if ((pCandidateComp != NULL) || (bWaiting == OMX_FALSE))
+            break;
+
+        /* every waiting instance spent its credits, start the next round */
+        for (pTempComp = gpVideoSchedList; pTempComp != NULL; pTempComp = pTempComp->pNext)
+            pTempComp->credit = pTempComp->weight;
+    }
+
+    return pCandidateComp;
+}
+
+static OMX_BOOL isSchedDraining(EXYNOS_OMX_SCHED_COMPONENT *pSchedComp, OMX_TICKS now)
+{
+    if (pSchedComp->inflight == 0)
+        return OMX_TRUE;
+
+    return ((now - pSchedComp->lastReturn) < (MAX_SCHED_STALL_TIME * 1000)) ? OMX_TRUE : OMX_FALSE;
+}
+
+OMX_BOOL checkSchedGrant(EXYNOS_OMX_SCHED_COMPONENT *pSchedComp)
+{
+    EXYNOS_OMX_SCHED_COMPONENT *pTempComp = NULL;
+    OMX_TICKS now = getSchedTime();
+    OMX_U32 totalWeight = 0;
+    OMX_U32 totalDepth = 0;
+    OMX_U32 totalInflight = 0;
+    OMX_U32 share = 0;
+    int numElem = 0;
+
+    /*
+     * idle instances count too, so MFC keeps room for their next frame;
+     * one that holds frames without giving any back does not
+     */
+    for (pTempComp = gpVideoSchedList; pTempComp != NULL; pTempComp = pTempComp->pNext) {
+        if ((pTempComp != pSchedComp) && (isSchedDraining(pTempComp, now) == OMX_FALSE))
+            continue;
+        totalWeight += pTempComp->weight;
+        totalDepth += pTempComp->depth;
+        totalInflight += pTempComp->inflight;
+        numElem++;
+    }
+
+    /* alone on MFC, nothing to share */
+    if (numElem <= 1)
+        return OMX_TRUE;
+    if (totalInflight >= totalDepth)
+        return OMX_FALSE;
+
+    share = (totalDepth * pSchedComp->weight) / totalWeight;
+    if (share == 0)
+        share = 1;
+    if (pSchedComp->inflight < share)
+        return OMX_TRUE;
+
+    return (pickSchedComponent() == pSchedComp) ? OMX_TRUE : OMX_FALSE;
+}
+
+OMX_ERRORTYPE addSchedComponent(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE               ret = OMX_ErrorNone;
+    EXYNOS_OMX_BASECOMPONENT   *pExynosComponent = NULL;
+    EXYNOS_OMX_SCHED_COMPONENT *pSchedComp = NULL;
+    OMX_U32                     priority = 0;
+    OMX_U32                     depth = 0;
+
+    pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+
+    pSchedComp = (EXYNOS_OMX_SCHED_COMPONENT *)Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_SCHED_COMPONENT));
+    if (pSchedComp == NULL) {
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+    Exynos_OSAL_Memset(pSchedComp, 0, sizeof(EXYNOS_OMX_SCHED_COMPONENT));
+
+    ret = Exynos_OSAL_SignalCreate(&pSchedComp->hGrantEvent);
+    if (ret != OMX_ErrorNone) {
+        Exynos_OSAL_Free(pSchedComp);
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+
+    /* a lower group priority value is the more important one */
+    priority = pExynosComponent->compPriority.nGroupPriority;
+    pSchedComp->pOMXStandComp = pOMXComponent;
+    pSchedComp->weight = (priority < 4) ? (MAX_SCHED_WEIGHT >> priority) : 1;
+    pSchedComp->credit = pSchedComp->weight;
+
+    /* MFC never holds more inputs than the port has buffers */
+    depth = pExynosComponent->pExynosPort[INPUT_PORT_INDEX].portDefinition.nBufferCountActual;
+    pSchedComp->depth = ((depth > 0) && (depth < MAX_SCHED_DEPTH)) ? depth : MAX_SCHED_DEPTH;
+
+    Exynos_OSAL_MutexLock(ghVideoSchedMutex);
+    pSchedComp->pNext = gpVideoSchedList;
+    gpVideoSchedList = pSchedComp;
+    Exynos_OSAL_MutexUnlock(ghVideoSchedMutex);
+
+EXIT:
+    return ret;
+}
+
+OMX_ERRORTYPE removeSchedComponent(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE               ret = OMX_ErrorNone;
+    EXYNOS_OMX_SCHED_COMPONENT *pCurrComp = NULL;
+    EXYNOS_OMX_SCHED_COMPONENT *pPrevComp = NULL;
+
+    Exynos_OSAL_MutexLock(ghVideoSchedMutex);
+
+    pCurrComp = gpVideoSchedList;
+    while ((pCurrComp != NULL) && (pCurrComp->pOMXStandComp != pOMXComponent)) {
+        pPrevComp = pCurrComp;
+        pCurrComp = pCurrComp->pNext;
+    }
+    if (pCurrComp == NULL) {
+        ret = OMX_ErrorComponentNotFound;
+        goto EXIT;
+    }
+
+    if (pPrevComp != NULL)
+        pPrevComp->pNext = pCurrComp->pNext;
+    else
+        gpVideoSchedList = pCurrComp->pNext;
+
+    /* a waiting thread still holds it, it frees the entry when woken */
+    if (pCurrComp->bWaiting == OMX_TRUE) {
+        pCurrComp->bRemoved = OMX_TRUE;
+        Exynos_OSAL_SignalSet(pCurrComp->hGrantEvent);
+    } else {
+        freeSchedComponent(pCurrComp);
+    }
+    wakeSchedComponent();
+
+EXIT:
+    Exynos_OSAL_MutexUnlock(ghVideoSchedMutex);
+
+    return ret;
+}
+
 
 OMX_ERRORTYPE Exynos_OMX_ResourceManager_Init()
 {
@@ -195,6 +402,8 @@ OMX_ERRORTYPE Exynos_OMX_ResourceManager_Init()
 
     FunctionIn();
     ret = Exynos_OSAL_MutexCreate(&ghVideoRMComponentListMutex);
+    if (ret == OMX_ErrorNone)
+        ret = Exynos_OSAL_MutexCreate(&ghVideoSchedMutex);
     FunctionOut();
 
     return ret;
@@ -253,6 +462,17 @@ OMX_ERRORTYPE Exynos_OMX_ResourceManager_Deinit()
     Exynos_OSAL_MutexTerminate(ghVideoRMComponentListMutex);
     ghVideoRMComponentListMutex = NULL;
 
+    Exynos_OSAL_MutexLock(ghVideoSchedMutex);
+    while (gpVideoSchedList != NULL) {
+        EXYNOS_OMX_SCHED_COMPONENT *pSchedComp = gpVideoSchedList;
+        gpVideoSchedList = pSchedComp->pNext;
+        freeSchedComponent(pSchedComp);
+    }
+    Exynos_OSAL_MutexUnlock(ghVideoSchedMutex);
+
+    Exynos_OSAL_MutexTerminate(ghVideoSchedMutex);
+    ghVideoSchedMutex = NULL;
+
     ret = OMX_ErrorNone;
 EXIT:
     FunctionOut();
@@ -348,6 +568,11 @@ OMX_ERRORTYPE Exynos_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent)
             }
         }
     }
+
+    if ((pExynosComponent->codecType == HW_VIDEO_DEC_CODEC) ||
+        (pExynosComponent->codecType == HW_VIDEO_ENC_CODEC))
+        addSchedComponent(pOMXComponent);
+
     ret = OMX_ErrorNone;
 
 EXIT:
@@ -372,7 +597,9 @@ OMX_ERRORTYPE Exynos_OMX_Release_Resource(OMX_COMPONENTTYPE *pOMXComponent)
     Exynos_OSAL_MutexLock(ghVideoRMComponentListMutex);
 
     pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
-    
+
+    removeSchedComponent(pOMXComponent);
+
     if (pExynosComponent->codecType == HW_VIDEO_DEC_CODEC) {
         pComponentTemp = gpVideoDecRMWaitingList;
         if (gpVideoDecRMComponentList == NULL) {
@@ -476,3 +703,127 @@ OMX_ERRORTYPE Exynos_OMX_Out_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent)
     return ret;
 }
 
+/*
+ * Called before a frame is queued to MFC. Returns at once while MFC has
+ * room or the instance is alone; otherwise waits for its turn, at most
+ * MAX_SCHED_WAIT_TIME so a stalled instance can never block the others.
+ */
+OMX_ERRORTYPE Exynos_OMX_Sched_Acquire(OMX_COMPONENTTYPE *pOMXComponent, OMX_TICKS timeStamp)
+{
+    OMX_ERRORTYPE               ret = OMX_ErrorNone;
+    EXYNOS_OMX_SCHED_COMPONENT *pSchedComp = NULL;
+    OMX_TICKS                   now = 0;
+    OMX_TICKS                   waitEnd = 0;
+
+    FunctionIn();
+
+    Exynos_OSAL_MutexLock(ghVideoSchedMutex);
+
+    pSchedComp = findSchedComponent(pOMXComponent);
+    if (pSchedComp == NULL) {
+        ret = OMX_ErrorComponentNotFound;
+        goto EXIT;
+    }
+
+    now = getSchedTime();
+    if (pSchedComp->bAnchored == OMX_FALSE) {
+        pSchedComp->anchorTime = now;
+        pSchedComp->anchorStamp = timeStamp;
+        pSchedComp->bAnchored = OMX_TRUE;
+    }
+    pSchedComp->deadline = pSchedComp->anchorTime + (timeStamp - pSchedComp->anchorStamp);
+    pSchedComp->bWaiting = OMX_TRUE;
+
+    waitEnd = now + (MAX_SCHED_WAIT_TIME * 1000);
+    while (checkSchedGrant(pSchedComp) == OMX_FALSE) {
+        now = getSchedTime();
+        if (now >= waitEnd) {
+            Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "%s: no turn in %d ms, inflight %d", __FUNCTION__, MAX_SCHED_WAIT_TIME, pSchedComp->inflight);
+            break;
+        }
+
+        Exynos_OSAL_SignalReset(pSchedComp->hGrantEvent);
+        Exynos_OSAL_MutexUnlock(ghVideoSchedMutex);
+        Exynos_OSAL_SignalWait(pSchedComp->hGrantEvent, (OMX_U32)((waitEnd - now + 999) / 1000));
+        Exynos_OSAL_MutexLock(ghVideoSchedMutex);
+
+        if (pSchedComp->bRemoved == OMX_TRUE) {
+            freeSchedComponent(pSchedComp);
+            ret = OMX_ErrorComponentNotFound;
+            goto EXIT;
+        }
+    }
+
+    pSchedComp->bWaiting = OMX_FALSE;
+    if (pSchedComp->credit > 0)
+        pSchedComp->credit--;
+    /* the stall clock starts with the first frame MFC holds */
+    if (pSchedComp->inflight == 0)
+        pSchedComp->lastReturn = getSchedTime();
+    pSchedComp->inflight++;
+
+EXIT:
+    Exynos_OSAL_MutexUnlock(ghVideoSchedMutex);
+
+    FunctionOut();
+
+    return ret;
+}
+
+/* MFC gave a frame back, or a frame taken with Exynos_OMX_Sched_Acquire was never queued */
+OMX_ERRORTYPE Exynos_OMX_Sched_Release(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE               ret = OMX_ErrorNone;
+    EXYNOS_OMX_SCHED_COMPONENT *pSchedComp = NULL;
+
+    FunctionIn();
+
+    Exynos_OSAL_MutexLock(ghVideoSchedMutex);
+
+    pSchedComp = findSchedComponent(pOMXComponent);
+    if (pSchedComp == NULL) {
+        ret = OMX_ErrorComponentNotFound;
+        goto EXIT;
+    }
+
+    if (pSchedComp->inflight > 0)
+        pSchedComp->inflight--;
+    pSchedComp->lastReturn = getSchedTime();
+    wakeSchedComponent();
+
+EXIT:
+    Exynos_OSAL_MutexUnlock(ghVideoSchedMutex);
+
+    FunctionOut();
+
+    return ret;
+}
+
+/* input port flushed: MFC holds nothing of it and timestamps start over */
+OMX_ERRORTYPE Exynos_OMX_Sched_Flush(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE               ret = OMX_ErrorNone;
+    EXYNOS_OMX_SCHED_COMPONENT *pSchedComp = NULL;
+
+    FunctionIn();
+
+    Exynos_OSAL_MutexLock(ghVideoSchedMutex);
+
+    pSchedComp = findSchedComponent(pOMXComponent);
+    if (pSchedComp == NULL) {
+        ret = OMX_ErrorComponentNotFound;
+        goto EXIT;
+    }
+
+    pSchedComp->inflight = 0;
+    pSchedComp->bAnchored = OMX_FALSE;
+    wakeSchedComponent();
+
+EXIT:
+    Exynos_OSAL_MutexUnlock(ghVideoSchedMutex);
+
+    FunctionOut();
+
+    return ret;
+}
+
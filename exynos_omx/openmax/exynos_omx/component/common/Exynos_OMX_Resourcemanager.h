@@ -40,6 +40,31 @@ typedef struct _EXYNOS_OMX_RM_COMPONENT_LIST
     struct _EXYNOS_OMX_RM_COMPONENT_LIST *pNext;
 } EXYNOS_OMX_RM_COMPONENT_LIST;
 
+/*
+ * One MFC instance in the submission scheduler. Each round grants weight
+ * credits by group priority; between instances holding credits the earliest
+ * wall clock deadline of the next frame goes first. An instance that has
+ * frames queued but returned none for MAX_SCHED_STALL_TIME no longer counts
+ * against the others.
+ */
+typedef struct _EXYNOS_OMX_SCHED_COMPONENT
+{
+    OMX_COMPONENTTYPE         *pOMXStandComp;
+    OMX_U32                    weight;
+    OMX_U32                    credit;
+    OMX_U32                    inflight;      /* frames queued to MFC, not returned yet */
+    OMX_U32                    depth;         /* input buffers it can keep queued to MFC */
+    OMX_TICKS                  lastReturn;    /* wall clock of the last frame back from MFC, us */
+    OMX_BOOL                   bWaiting;
+    OMX_BOOL                   bRemoved;
+    OMX_BOOL                   bAnchored;
+    OMX_TICKS                  anchorTime;    /* wall clock when anchorStamp was submitted, us */
+    OMX_TICKS                  anchorStamp;
+    OMX_TICKS                  deadline;
+    OMX_HANDLETYPE             hGrantEvent;
+    struct _EXYNOS_OMX_SCHED_COMPONENT *pNext;
+} EXYNOS_OMX_SCHED_COMPONENT;
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -51,6 +76,9 @@ OMX_ERRORTYPE Exynos_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE Exynos_OMX_Release_Resource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE Exynos_OMX_In_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE Exynos_OMX_Out_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE Exynos_OMX_Sched_Acquire(OMX_COMPONENTTYPE *pOMXComponent, OMX_TICKS timeStamp);
+OMX_ERRORTYPE Exynos_OMX_Sched_Release(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE Exynos_OMX_Sched_Flush(OMX_COMPONENTTYPE *pOMXComponent);
 
 #ifdef __cplusplus
 };
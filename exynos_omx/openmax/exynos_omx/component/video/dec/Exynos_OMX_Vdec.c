@@ -34,6 +34,7 @@
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
 #include "Exynos_OMX_Basecomponent.h"
+#include "Exynos_OMX_Resourcemanager.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
@@ -172,6 +173,262 @@ OMX_ERRORTYPE Exynos_Output_CodecBufferToData(EXYNOS_OMX_BASECOMPONENT *pExynosC
     return ret;
 }
 
+OMX_ERRORTYPE Exynos_TimestampMap_Create(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_U32 nSize)
+{
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+
+    Exynos_OSAL_Memset(pMap, 0, sizeof(EXYNOS_OMX_TIMESTAMP_MAP));
+
+    ret = Exynos_OSAL_MutexCreate(&pMap->hMutex);
+    if (ret != OMX_ErrorNone)
+        goto EXIT;
+
+    ret = Exynos_TimestampMap_Resize(pMap, nSize);
+    if (ret != OMX_ErrorNone) {
+        Exynos_OSAL_MutexTerminate(pMap->hMutex);
+        pMap->hMutex = NULL;
+    }
+
+EXIT:
+    return ret;
+}
+
+/* only grows; tags already handed out keep their slot */
+OMX_ERRORTYPE Exynos_TimestampMap_Resize(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_U32 nSize)
+{
+    OMX_ERRORTYPE               ret = OMX_ErrorNone;
+    EXYNOS_OMX_TIMESTAMP_ENTRY *pEntry = NULL;
+
+    if (nSize < MAX_TIMESTAMP)
+        nSize = MAX_TIMESTAMP;
+    if (nSize > TIMESTAMP_MAP_SIZE_MAX)
+        nSize = TIMESTAMP_MAP_SIZE_MAX;
+
+    Exynos_OSAL_MutexLock(pMap->hMutex);
+
+    if (nSize <= pMap->nSize)
+        goto EXIT;
+
+    pEntry = (EXYNOS_OMX_TIMESTAMP_ENTRY *)Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_TIMESTAMP_ENTRY) * nSize);
+    if (pEntry == NULL) {
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+    Exynos_OSAL_Memset(pEntry, 0, sizeof(EXYNOS_OMX_TIMESTAMP_ENTRY) * nSize);
+
+    if (pMap->pEntry != NULL) {
+        Exynos_OSAL_Memcpy(pEntry, pMap->pEntry, sizeof(EXYNOS_OMX_TIMESTAMP_ENTRY) * pMap->nSize);
+        Exynos_OSAL_Free(pMap->pEntry);
+    }
+    pMap->pEntry = pEntry;
+    pMap->nSize = nSize;
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp map size: %d", nSize);
+
+EXIT:
+    Exynos_OSAL_MutexUnlock(pMap->hMutex);
+
+    return ret;
+}
+
+void Exynos_TimestampMap_Destroy(EXYNOS_OMX_TIMESTAMP_MAP *pMap)
+{
+    if (pMap->pEntry != NULL) {
+        Exynos_OSAL_Free(pMap->pEntry);
+        pMap->pEntry = NULL;
+    }
+    pMap->nSize = 0;
+
+    if (pMap->hMutex != NULL) {
+        Exynos_OSAL_MutexTerminate(pMap->hMutex);
+        pMap->hMutex = NULL;
+    }
+}
+
+/* forget every pending frame, tags still inside MFC will no longer match */
+void Exynos_TimestampMap_Flush(EXYNOS_OMX_TIMESTAMP_MAP *pMap)
+{
+    OMX_U32 i;
+
+    Exynos_OSAL_MutexLock(pMap->hMutex);
+
+    for (i = 0; i < pMap->nSize; i++)
+        pMap->pEntry[i].bUsed = OMX_FALSE;
+    pMap->nNextSlot = 0;
+    pMap->nGeneration = (pMap->nGeneration + 1) & TIMESTAMP_TAG_GENERATION_MASK;
+
+    Exynos_OSAL_MutexUnlock(pMap->hMutex);
+}
+
+OMX_S32 Exynos_TimestampMap_Put(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_TICKS timeStamp, OMX_U32 nFlags)
+{
+    EXYNOS_OMX_TIMESTAMP_ENTRY *pEntry = NULL;
+    OMX_U32 nSlot = 0;
+    OMX_U32 nOldest = 0;
+    OMX_S32 nTag = 0;
+    OMX_U32 i;
+
+    Exynos_OSAL_MutexLock(pMap->hMutex);
+
+    for (i = 0; i < pMap->nSize; i++) {
+        nSlot = (pMap->nNextSlot + i) % pMap->nSize;
+        if (pMap->pEntry[nSlot].bUsed == OMX_FALSE)
+            break;
+        /* a frame MFC never returned (dropped), oldest goes first */
+        if ((OMX_S32)(pMap->pEntry[nSlot].nSequence - pMap->pEntry[nOldest].nSequence) < 0)
+            nOldest = nSlot;
+    }
+    if (i == pMap->nSize) {
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp map full, drop tag slot %d", nOldest);
+        nSlot = nOldest;
+    }
+
+    pEntry = &pMap->pEntry[nSlot];
+    pEntry->timeStamp = timeStamp;
+    pEntry->nFlags = nFlags;
+    pEntry->nSequence = pMap->nSequence++;
+    pEntry->nGeneration = pMap->nGeneration;
+    pEntry->bUsed = OMX_TRUE;
+    pMap->nNextSlot = (nSlot + 1) % pMap->nSize;
+    nTag = (OMX_S32)((pEntry->nGeneration << TIMESTAMP_TAG_SLOT_BITS) | nSlot);
+
+    Exynos_OSAL_MutexUnlock(pMap->hMutex);
+
+    return nTag;
+}
+
+/* takes the entry of a tag reported by MFC, OMX_FALSE if it is unknown or stale */
+OMX_BOOL Exynos_TimestampMap_Get(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_S32 nTag, OMX_TICKS *pTimeStamp, OMX_U32 *pFlags)
+{
+    EXYNOS_OMX_TIMESTAMP_ENTRY *pEntry = NULL;
+    OMX_BOOL ret = OMX_FALSE;
+    OMX_U32  nSlot = 0;
+
+    if (nTag < 0)
+        return OMX_FALSE;
+
+    nSlot = (OMX_U32)nTag & TIMESTAMP_TAG_SLOT_MASK;
+
+    Exynos_OSAL_MutexLock(pMap->hMutex);
+
+    if (nSlot < pMap->nSize) {
+        pEntry = &pMap->pEntry[nSlot];
+        if ((pEntry->bUsed == OMX_TRUE) &&
+            (pEntry->nGeneration == ((OMX_U32)nTag >> TIMESTAMP_TAG_SLOT_BITS))) {
+            *pTimeStamp = pEntry->timeStamp;
+            *pFlags = pEntry->nFlags;
+            pEntry->bUsed = OMX_FALSE;
+            ret = OMX_TRUE;
+        }
+    }
+
+    Exynos_OSAL_MutexUnlock(pMap->hMutex);
+
+    return ret;
+}
+
+/* replaces the timestamp of a frame still inside MFC, OMX_FALSE if it already came out */
+OMX_BOOL Exynos_TimestampMap_Update(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_S32 nTag, OMX_TICKS timeStamp, OMX_U32 nFlags)
+{
+    EXYNOS_OMX_TIMESTAMP_ENTRY *pEntry = NULL;
+    OMX_BOOL ret = OMX_FALSE;
+    OMX_U32  nSlot = 0;
+
+    if (nTag < 0)
+        return OMX_FALSE;
+
+    nSlot = (OMX_U32)nTag & TIMESTAMP_TAG_SLOT_MASK;
+
+    Exynos_OSAL_MutexLock(pMap->hMutex);
+
+    if (nSlot < pMap->nSize) {
+        pEntry = &pMap->pEntry[nSlot];
+        if ((pEntry->bUsed == OMX_TRUE) &&
+            (pEntry->nGeneration == ((OMX_U32)nTag >> TIMESTAMP_TAG_SLOT_BITS))) {
+            pEntry->timeStamp = timeStamp;
+            pEntry->nFlags |= nFlags;
+            ret = OMX_TRUE;
+        }
+    }
+
+    Exynos_OSAL_MutexUnlock(pMap->hMutex);
+
+    return ret;
+}
+
+/*
+ * For an output whose tag was lost: the pending frame with the earliest
+ * timestamp is the next one in display order.
+ */
+OMX_BOOL Exynos_TimestampMap_GetNext(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_TICKS *pTimeStamp, OMX_U32 *pFlags)
+{
+    EXYNOS_OMX_TIMESTAMP_ENTRY *pEntry = NULL;
+    OMX_U32 i;
+
+    Exynos_OSAL_MutexLock(pMap->hMutex);
+
+    for (i = 0; i < pMap->nSize; i++) {
+        if (pMap->pEntry[i].bUsed != OMX_TRUE)
+            continue;
+        if ((pEntry == NULL) || (pMap->pEntry[i].timeStamp < pEntry->timeStamp))
+            pEntry = &pMap->pEntry[i];
+    }
+    if (pEntry != NULL) {
+        *pTimeStamp = pEntry->timeStamp;
+        *pFlags = pEntry->nFlags;
+        pEntry->bUsed = OMX_FALSE;
+    }
+
+    Exynos_OSAL_MutexUnlock(pMap->hMutex);
+
+    return (pEntry != NULL) ? OMX_TRUE : OMX_FALSE;
+}
+
+/*
+ * A frame before the seek target that no other frame references is never
+ * shown, so it is not worth sending to MFC at all.
+ */
+OMX_BOOL Exynos_Check_SeekTargetDrop(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEODEC_COMPONENT *pVideoDec = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+
+    if ((pVideoDec->bSeekTarget != OMX_TRUE) ||
+        (pVideoDec->exynos_checkNonReferenceFrame == NULL) ||
+        (pVideoDec->bDRMPlayerMode == OMX_TRUE))
+        return OMX_FALSE;
+
+    if ((pSrcInputData->dataLen == 0) ||
+        (pSrcInputData->timeStamp >= pVideoDec->seekTargetTime) ||
+        (pSrcInputData->nFlags & (OMX_BUFFERFLAG_EOS | OMX_BUFFERFLAG_CODECCONFIG)))
+        return OMX_FALSE;
+
+    /* the output side waits for this one to tell the seek is done */
+    if ((pExynosComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE) &&
+        (pExynosComponent->checkTimeStamp.startTimeStamp == pSrcInputData->timeStamp))
+        return OMX_FALSE;
+
+    return pVideoDec->exynos_checkNonReferenceFrame(pSrcInputData->buffer.singlePlaneBuffer.dataBuffer,
+                                                    pSrcInputData->dataLen);
+}
+
+/*
+ * Gives back an input that never reached MFC: the codec buffer goes back
+ * to the free queue in copy mode, the client buffer to the client in share mode.
+ */
+void Exynos_Input_ReturnData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData)
+{
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_BASEPORT      *exynosInputPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+
+    if ((exynosInputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
+        if (pSrcInputData->pPrivate != NULL)
+            Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, pSrcInputData->pPrivate);
+    } else if (pSrcInputData->bufferHeader != NULL) {
+        Exynos_OMX_InputBufferReturn(pOMXComponent, pSrcInputData->bufferHeader);
+    }
+    Exynos_ResetCodecData(pSrcInputData);
+}
+
 void Exynos_Wait_ProcessPause(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nPortIndex)
 {
     EXYNOS_OMX_BASEPORT *exynosOMXInputPort  = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
@@ -468,6 +725,19 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
             goto EXIT;
         }
 
+        if ((pVideoDec->bSeekTarget == OMX_TRUE) &&
+            ((dstOutputData->nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS)) {
+            if (dstOutputData->timeStamp < pVideoDec->seekTargetTime) {
+                /* skip the color conversion, the codec buffer goes straight back to MFC */
+                Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "drop frame before seek target %lld us", pVideoDec->seekTargetTime);
+                if (exynosOutputPort->bufferProcessType == BUFFER_SHARE)
+                    Exynos_OMX_FillThisBuffer(pOMXComponent, outputUseBuffer->bufferHeader);
+                ret = OMX_TRUE;
+                goto EXIT;
+            }
+            pVideoDec->bSeekTarget = OMX_FALSE;
+        }
+
         if ((exynosOutputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
             OMX_U32 width = 0, height = 0;
             int imageSize = 0;
@@ -597,10 +867,28 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
                     Exynos_OSAL_MutexUnlock(srcInputUseBuffer->bufferMutex);
                     break;
                 }
+
+                if (Exynos_Check_SeekTargetDrop(pOMXComponent, pSrcInputData) == OMX_TRUE) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "skip non-reference frame %lld us before seek target",
+                                    pSrcInputData->timeStamp);
+                    Exynos_Input_ReturnData(pOMXComponent, pSrcInputData);
+                    Exynos_OSAL_MutexUnlock(srcInputUseBuffer->bufferMutex);
+                    continue;
+                }
+
+                Exynos_OMX_Sched_Acquire(pOMXComponent, pSrcInputData->timeStamp);
             }
 
             ret = pVideoDec->exynos_codec_srcInputProcess(pOMXComponent, pSrcInputData);
+            if (ret == (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer) {
+                /* nothing went to MFC, so no source output will return the buffer or its credit */
+                Exynos_OMX_Sched_Release(pOMXComponent);
+                Exynos_Input_ReturnData(pOMXComponent, pSrcInputData);
+                ret = OMX_ErrorNone;
+            }
             if (ret != OMX_ErrorInputDataDecodeYet) {
+                if (ret != OMX_ErrorNone)
+                    Exynos_OMX_Sched_Release(pOMXComponent);
                 Exynos_ResetCodecData(pSrcInputData);
             }
             Exynos_OSAL_MutexUnlock(srcInputUseBuffer->bufferMutex);
@@ -645,6 +933,8 @@ OMX_ERRORTYPE Exynos_OMX_SrcOutputBufferProcess(OMX_HANDLETYPE hComponent)
             ret = pVideoDec->exynos_codec_srcOutputProcess(pOMXComponent, &srcOutputData);
 
             if (ret == OMX_ErrorNone) {
+                if ((srcOutputData.bufferHeader != NULL) || (srcOutputData.pPrivate != NULL))
+                    Exynos_OMX_Sched_Release(pOMXComponent);
                 if ((exynosInputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
                     OMX_PTR codecBuffer;
                     codecBuffer = srcOutputData.pPrivate;
@@ -1061,6 +1351,15 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeComponentInit(OMX_IN OMX_HANDLETYPE hCompone
     Exynos_OSAL_Memset(pVideoDec, 0, sizeof(EXYNOS_OMX_VIDEODEC_COMPONENT));
     pExynosComponent->hComponentHandle = (OMX_HANDLETYPE)pVideoDec;
 
+    ret = Exynos_TimestampMap_Create(&pVideoDec->timestampMap, MAX_TIMESTAMP);
+    if (ret != OMX_ErrorNone) {
+        Exynos_OSAL_Free(pVideoDec);
+        pExynosComponent->hComponentHandle = NULL;
+        Exynos_OMX_BaseComponent_Destructor(pOMXComponent);
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "OMX_ErrorInsufficientResources, Line:%d", __LINE__);
+        goto EXIT;
+    }
+
     pExynosComponent->bSaveFlagEOS = OMX_FALSE;
     pExynosComponent->bMultiThreadProcess = OMX_TRUE;
 
@@ -1156,6 +1455,7 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeComponentDeinit(OMX_IN OMX_HANDLETYPE hCompo
 
     pVideoDec = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
 
+    Exynos_TimestampMap_Destroy(&pVideoDec->timestampMap);
     Exynos_OSAL_Free(pVideoDec);
     pExynosComponent->hComponentHandle = pVideoDec = NULL;
 
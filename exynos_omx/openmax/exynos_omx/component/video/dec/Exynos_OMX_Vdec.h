@@ -82,6 +82,38 @@ typedef struct _DECODE_CODEC_EXTRA_BUFFERINFO
     OMX_COLOR_FORMATTYPE ColorFormat;
 } DECODE_CODEC_EXTRA_BUFFERINFO;
 
+/* frame tag = generation << TIMESTAMP_TAG_SLOT_BITS | slot */
+#define TIMESTAMP_TAG_SLOT_BITS             8
+#define TIMESTAMP_TAG_SLOT_MASK             ((1 << TIMESTAMP_TAG_SLOT_BITS) - 1)
+#define TIMESTAMP_TAG_GENERATION_MASK       0x7FFF
+#define TIMESTAMP_MAP_SIZE_MAX              TIMESTAMP_TAG_SLOT_MASK
+/* slot past the largest map, for frames that are decoded but never shown */
+#define TIMESTAMP_TAG_UNTRACKED             TIMESTAMP_TAG_SLOT_MASK
+
+typedef struct _EXYNOS_OMX_TIMESTAMP_ENTRY
+{
+    OMX_TICKS timeStamp;
+    OMX_U32   nFlags;
+    OMX_U32   nSequence;    /* input order */
+    OMX_U32   nGeneration;  /* flush generation, stale tags never match */
+    OMX_BOOL  bUsed;
+} EXYNOS_OMX_TIMESTAMP_ENTRY;
+
+/*
+ * Input timestamp and flags of every frame tagged to MFC, until the frame
+ * comes back on the output. Sized from the DPB, so deep reordering does not
+ * wrap onto frames still being decoded.
+ */
+typedef struct _EXYNOS_OMX_TIMESTAMP_MAP
+{
+    EXYNOS_OMX_TIMESTAMP_ENTRY *pEntry;
+    OMX_U32        nSize;
+    OMX_U32        nNextSlot;
+    OMX_U32        nSequence;
+    OMX_U32        nGeneration;
+    OMX_HANDLETYPE hMutex;
+} EXYNOS_OMX_TIMESTAMP_MAP;
+
 typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
 {
     OMX_HANDLETYPE hCodecHandle;
@@ -103,6 +135,13 @@ typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
     /* For DRM Play */
     OMX_BOOL bDRMPlayerMode;
 
+    /* MFC frame tag -> input timestamp, flags */
+    EXYNOS_OMX_TIMESTAMP_MAP timestampMap;
+
+    /* For seek: frames before the target are not shown */
+    OMX_BOOL  bSeekTarget;
+    OMX_TICKS seekTargetTime;
+
     /* CSC handle */
     OMX_PTR csc_handle;
     OMX_U32 csc_set_format;
@@ -119,6 +158,7 @@ typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
 
     int (*exynos_checkInputFrame) (OMX_U8 *pInputStream, OMX_U32 buffSize, OMX_U32 flag,
                                    OMX_BOOL bPreviousFrameEOF, OMX_BOOL *pbEndOfFrame);
+    OMX_BOOL (*exynos_checkNonReferenceFrame) (OMX_U8 *pInputStream, OMX_U32 buffSize);
     OMX_ERRORTYPE (*exynos_codec_getCodecInputPrivateData) (OMX_PTR codecBuffer, OMX_PTR addr, OMX_U32 *size);
     OMX_ERRORTYPE (*exynos_codec_getCodecOutputPrivateData) (OMX_PTR codecBuffer, OMX_PTR addr[], OMX_U32 size[]);
 } EXYNOS_OMX_VIDEODEC_COMPONENT;
@@ -132,6 +172,16 @@ inline void Exynos_UpdateFrameSize(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_BOOL Exynos_Check_BufferProcess_State(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nPortIndex);
 OMX_ERRORTYPE Exynos_Input_CodecBufferToData(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_PTR codecBuffer, EXYNOS_OMX_DATA *pData);
 OMX_ERRORTYPE Exynos_Output_CodecBufferToData(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_PTR codecBuffer, EXYNOS_OMX_DATA *pData);
+OMX_ERRORTYPE Exynos_TimestampMap_Create(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_U32 nSize);
+OMX_ERRORTYPE Exynos_TimestampMap_Resize(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_U32 nSize);
+void Exynos_TimestampMap_Destroy(EXYNOS_OMX_TIMESTAMP_MAP *pMap);
+void Exynos_TimestampMap_Flush(EXYNOS_OMX_TIMESTAMP_MAP *pMap);
+OMX_S32 Exynos_TimestampMap_Put(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_TICKS timeStamp, OMX_U32 nFlags);
+OMX_BOOL Exynos_TimestampMap_Get(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_S32 nTag, OMX_TICKS *pTimeStamp, OMX_U32 *pFlags);
+OMX_BOOL Exynos_TimestampMap_Update(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_S32 nTag, OMX_TICKS timeStamp, OMX_U32 nFlags);
+OMX_BOOL Exynos_TimestampMap_GetNext(EXYNOS_OMX_TIMESTAMP_MAP *pMap, OMX_TICKS *pTimeStamp, OMX_U32 *pFlags);
+OMX_BOOL Exynos_Check_SeekTargetDrop(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData);
+void Exynos_Input_ReturnData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData);
 
 OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_SrcOutputBufferProcess(OMX_HANDLETYPE hComponent);
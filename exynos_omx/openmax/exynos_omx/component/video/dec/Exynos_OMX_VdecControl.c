@@ -32,6 +32,7 @@
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
 #include "Exynos_OMX_Basecomponent.h"
+#include "Exynos_OMX_Resourcemanager.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
@@ -556,8 +557,8 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 n
         if (nPortIndex == INPUT_PORT_INDEX) {
             pExynosComponent->checkTimeStamp.needSetStartTimeStamp = OMX_TRUE;
             pExynosComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_FALSE;
-            Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-            Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
+            Exynos_TimestampMap_Flush(&pVideoDec->timestampMap);
+            Exynos_OMX_Sched_Flush(pOMXComponent);
             pExynosComponent->getAllDelayBuffer = OMX_FALSE;
             pExynosComponent->bSaveFlagEOS = OMX_FALSE;
             pExynosComponent->reInputData = OMX_FALSE;
@@ -1376,6 +1377,25 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeGetConfig(
     }
 
     switch (nIndex) {
+    case OMX_IndexConfigVideoSeekTarget:
+    {
+        EXYNOS_OMX_VIDEODEC_COMPONENT *pVideoDec = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+        EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET *pSeekTarget = (EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET *)pComponentConfigStructure;
+
+        ret = Exynos_OMX_Check_SizeVersion(pSeekTarget, sizeof(EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET));
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        if (pSeekTarget->nPortIndex != INPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        /* bEnable drops back to OMX_FALSE once the target frame is out */
+        pSeekTarget->bEnable = pVideoDec->bSeekTarget;
+        pSeekTarget->nTargetTime = pVideoDec->seekTargetTime;
+    }
+        break;
     default:
         ret = Exynos_OMX_GetConfig(hComponent, nIndex, pComponentConfigStructure);
         break;
@@ -1430,6 +1450,25 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeSetConfig(
         ret = OMX_ErrorNone;
     }
         break;
+    case OMX_IndexConfigVideoSeekTarget:
+    {
+        EXYNOS_OMX_VIDEODEC_COMPONENT *pVideoDec = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+        EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET *pSeekTarget = (EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET *)pComponentConfigStructure;
+
+        ret = Exynos_OMX_Check_SizeVersion(pSeekTarget, sizeof(EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET));
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        if (pSeekTarget->nPortIndex != INPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        pVideoDec->seekTargetTime = pSeekTarget->nTargetTime;
+        pVideoDec->bSeekTarget = pSeekTarget->bEnable;
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "seek target %lld us, enable: %d", pSeekTarget->nTargetTime, pSeekTarget->bEnable);
+    }
+        break;
     default:
         ret = Exynos_OMX_SetConfig(hComponent, nIndex, pComponentConfigStructure);
         break;
@@ -1477,6 +1516,11 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeGetExtensionIndex(
         goto EXIT;
     }
 
+    if (Exynos_OSAL_Strcmp(cParameterName, EXYNOS_INDEX_CONFIG_VIDEO_SEEK_TARGET) == 0) {
+        *pIndexType = (OMX_INDEXTYPE) OMX_IndexConfigVideoSeekTarget;
+        goto EXIT;
+    }
+
 #ifdef USE_ANB
     if (Exynos_OSAL_Strcmp(cParameterName, EXYNOS_INDEX_PARAM_ENABLE_ANB) == 0)
         *pIndexType = (OMX_INDEXTYPE) OMX_IndexParamEnableAndroidBuffers;
@@ -248,6 +248,27 @@ static OMX_BOOL Check_H264_StartCode(
     }
 }
 
+/* nal_ref_idc of the first slice, 0 means no other picture refers to this one */
+static OMX_BOOL Check_H264_NonReferenceFrame(
+    OMX_U8 *pInputStream,
+    OMX_U32 buffSize)
+{
+    OMX_U32 preThreeByte = 0xFFFFFF;
+    OMX_U32 i;
+
+    for (i = 0; i < buffSize; i++) {
+        if (preThreeByte == 0x000001) {
+            int naluType = pInputStream[i] & 0x1F;
+
+            if ((naluType >= 1) && (naluType <= 5))
+                return (((pInputStream[i] >> 5) & 0x3) == 0) ? OMX_TRUE : OMX_FALSE;
+        }
+        preThreeByte = ((preThreeByte << 8) | pInputStream[i]) & 0xFFFFFF;
+    }
+
+    return OMX_FALSE;
+}
+
 OMX_ERRORTYPE H264CodecOpen(EXYNOS_H264DEC_HANDLE *pH264Dec)
 {
     OMX_ERRORTYPE            ret        = OMX_ErrorNone;
@@ -615,7 +636,8 @@ OMX_ERRORTYPE H264CodecSrcSetup(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DAT
         OMXBuffer->nFlags = pSrcInputData->nFlags;
         Exynos_OMX_OutputBufferReturn(pOMXComponent, OMXBuffer);
 
-        ret = OMX_ErrorNone;
+        /* the empty input is done with, it never goes to MFC */
+        ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
         goto EXIT;
     }
 
@@ -728,6 +750,10 @@ OMX_ERRORTYPE H264CodecSrcSetup(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DAT
         pH264Dec->hMFCH264Handle.maxDPBNum += EXTRA_DPB_NUM;
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "H264CodecSetup nOutbufs: %d", pH264Dec->hMFCH264Handle.maxDPBNum);
 
+    /* every frame the MFC may still hold needs its own timestamp slot */
+    Exynos_TimestampMap_Resize(&pVideoDec->timestampMap,
+                               pH264Dec->hMFCH264Handle.maxDPBNum + pExynosInputPort->portDefinition.nBufferCountActual);
+
     pH264Dec->hMFCH264Handle.bConfiguredMFCSrc = OMX_TRUE;
 
     pExynosOutputPort->cropRectangle.nTop = pH264Dec->hMFCH264Handle.codecOutbufConf.cropRect.nTop;
@@ -1511,10 +1537,7 @@ OMX_ERRORTYPE Exynos_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pH264Dec->bDestinationStart = OMX_FALSE;
     Exynos_OSAL_SignalCreate(&pH264Dec->hDestinationStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-    Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
-    pH264Dec->hMFCH264Handle.indexTimestamp = 0;
-    pH264Dec->hMFCH264Handle.outputIndexTimestamp = 0;
+    Exynos_TimestampMap_Flush(&pVideoDec->timestampMap);
 
     pExynosComponent->getAllDelayBuffer = OMX_FALSE;
 
@@ -1636,6 +1659,7 @@ OMX_ERRORTYPE Exynos_H264Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
     ExynosVideoDecBufferOps *pInbufOps  = pH264Dec->hMFCH264Handle.pInbufOps;
     ExynosVideoDecBufferOps *pOutbufOps = pH264Dec->hMFCH264Handle.pOutbufOps;
     ExynosVideoErrorType codecReturn = VIDEO_ERROR_NONE;
+    OMX_S32 nTag = 0;
     int i;
 
     FunctionIn();
@@ -1651,12 +1675,9 @@ OMX_ERRORTYPE Exynos_H264Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
     if (((pVideoDec->bDRMPlayerMode == OMX_TRUE) ||
             (Check_H264_StartCode(pSrcInputData->buffer.singlePlaneBuffer.dataBuffer, oneFrameSize) == OMX_TRUE)) ||
         ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-        pExynosComponent->timeStamp[pH264Dec->hMFCH264Handle.indexTimestamp] = pSrcInputData->timeStamp;
-        pExynosComponent->nFlags[pH264Dec->hMFCH264Handle.indexTimestamp] = pSrcInputData->nFlags;
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pH264Dec->hMFCH264Handle.indexTimestamp, pSrcInputData->nFlags);
-        pDecOps->Set_FrameTag(hMFCHandle, pH264Dec->hMFCH264Handle.indexTimestamp);
-        pH264Dec->hMFCH264Handle.indexTimestamp++;
-        pH264Dec->hMFCH264Handle.indexTimestamp %= MAX_TIMESTAMP;
+        nTag = Exynos_TimestampMap_Put(&pVideoDec->timestampMap, pSrcInputData->timeStamp, pSrcInputData->nFlags);
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, nTag, pSrcInputData->nFlags);
+        pDecOps->Set_FrameTag(hMFCHandle, nTag);
 
         /* queue work for input buffer */
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "oneFrameSize: %d, bufferHeader: 0x%x, dataBuffer: 0x%x", oneFrameSize, pSrcInputData->bufferHeader, pSrcInputData->buffer.singlePlaneBuffer.dataBuffer);
@@ -1678,6 +1699,10 @@ OMX_ERRORTYPE Exynos_H264Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
             Exynos_OSAL_SignalSet(pH264Dec->hDestinationStartEvent);
             Exynos_OSAL_SleepMillisec(0);
         }
+    } else {
+        /* no start code, nothing for MFC to decode */
+        ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
+        goto EXIT;
     }
 
     ret = OMX_ErrorNone;
@@ -1839,9 +1864,6 @@ OMX_ERRORTYPE Exynos_H264Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
     if (ret != OMX_ErrorNone)
         goto EXIT;
 
-    pH264Dec->hMFCH264Handle.outputIndexTimestamp++;
-    pH264Dec->hMFCH264Handle.outputIndexTimestamp %= MAX_TIMESTAMP;
-
     pDstOutputData->allocSize = pDstOutputData->dataLen = 0;
     for (plane = 0; plane < MFC_OUTPUT_BUFFER_PLANE; plane++) {
         pDstOutputData->buffer.multiPlaneBuffer.dataBuffer[plane] = pVideoBuffer->planes[plane].addr;
@@ -1870,34 +1892,19 @@ OMX_ERRORTYPE Exynos_H264Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
 
     indexTimestamp = pDecOps->Get_FrameTag(hMFCHandle);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "out indexTimestamp: %d", indexTimestamp);
-    if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
+    if (Exynos_TimestampMap_Get(&pVideoDec->timestampMap, indexTimestamp,
+                                &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
         if ((pExynosComponent->checkTimeStamp.needSetStartTimeStamp != OMX_TRUE) &&
-            (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE)) {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[pH264Dec->hMFCH264Handle.outputIndexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[pH264Dec->hMFCH264Handle.outputIndexTimestamp];
+            (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE) &&
+            (Exynos_TimestampMap_GetNext(&pVideoDec->timestampMap,
+                                         &pDstOutputData->timeStamp, &pDstOutputData->nFlags) == OMX_TRUE)) {
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "missing out indexTimestamp: %d", indexTimestamp);
         } else {
             pDstOutputData->timeStamp = 0x00;
             pDstOutputData->nFlags = 0x00;
         }
-    } else {
-        /* For timestamp correction. if mfc support frametype detect */
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "disp_pic_frame_type: %d", pVideoBuffer->frameType);
-#ifdef NEED_TIMESTAMP_REORDER
-        if ((pVideoBuffer->frameType == VIDEO_FRAME_I)) {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-            pH264Dec->hMFCH264Handle.outputIndexTimestamp = indexTimestamp;
-        } else {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[pH264Dec->hMFCH264Handle.outputIndexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[pH264Dec->hMFCH264Handle.outputIndexTimestamp];
-        }
-#else
-        pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-        pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-#endif
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
     }
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
 
     if ((displayStatus == VIDEO_FRAME_STATUS_CHANGE_RESOL) ||
         ((pDstOutputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
@@ -2202,6 +2209,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent
     pVideoDec->exynos_codec_enqueueAllBuffer = &H264CodecEnQueueAllBuffer;
 
     pVideoDec->exynos_checkInputFrame                 = &Check_H264_Frame;
+    pVideoDec->exynos_checkNonReferenceFrame          = &Check_H264_NonReferenceFrame;
     pVideoDec->exynos_codec_getCodecInputPrivateData  = &GetCodecInputPrivateData;
     pVideoDec->exynos_codec_getCodecOutputPrivateData = &GetCodecOutputPrivateData;
 
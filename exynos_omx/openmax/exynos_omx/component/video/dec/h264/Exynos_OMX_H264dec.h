@@ -35,8 +35,6 @@
 typedef struct _EXYNOS_MFC_H264DEC_HANDLE
 {
     OMX_HANDLETYPE             hMFCHandle;
-    OMX_U32                    indexTimestamp;
-    OMX_U32                    outputIndexTimestamp;
     OMX_BOOL                   bConfiguredMFCSrc;
     OMX_BOOL                   bConfiguredMFCDst;
     OMX_U32                    maxDPBNum;
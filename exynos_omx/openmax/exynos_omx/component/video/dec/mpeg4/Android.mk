@@ -21,6 +21,10 @@ ifeq ($(BOARD_USE_ANB), true)
 LOCAL_CFLAGS += -DUSE_ANB
 endif
 
+ifeq ($(BOARD_USE_MPEG4_PACKED_PB_SPLIT), true)
+LOCAL_CFLAGS += -DUSE_MPEG4_PACKED_PB_SPLIT
+endif
+
 LOCAL_ARM_MODE := arm
 
 LOCAL_STATIC_LIBRARIES := libExynosOMX_Vdec libExynosOMX_OSAL libExynosOMX_Basecomponent \
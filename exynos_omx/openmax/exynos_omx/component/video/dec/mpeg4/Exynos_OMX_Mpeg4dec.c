@@ -33,6 +33,7 @@
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Vdec.h"
+#include "Exynos_OMX_Resourcemanager.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -230,6 +231,142 @@ EXIT :
     return --len;
 }
 
+/* vop_coding_type of the first VOP, a B-VOP is never referenced */
+static OMX_BOOL Check_Mpeg4_NonReferenceFrame(
+    OMX_U8 *pInputStream,
+    OMX_U32 buffSize)
+{
+    unsigned startCode = 0xFFFFFFFF;
+    OMX_U32  len;
+
+    for (len = 0; len < buffSize; len++) {
+        if (startCode == 0x1B6)
+            return (((pInputStream[len] >> 6) & 0x3) == 2) ? OMX_TRUE : OMX_FALSE;
+        startCode = (startCode << 8) | pInputStream[len];
+    }
+
+    return OMX_FALSE;
+}
+
+static OMX_U32 Mpeg4_ReadBits(
+    OMX_U8  *pStream,
+    OMX_U32  buffSize,
+    OMX_U32 *pBitPos,
+    OMX_U32  nBits)
+{
+    OMX_U32 value = 0;
+
+    while (nBits-- > 0) {
+        value <<= 1;
+        if ((*pBitPos >> 3) < buffSize)
+            value |= (pStream[*pBitPos >> 3] >> (7 - (*pBitPos & 7))) & 0x1;
+        (*pBitPos)++;
+    }
+
+    return value;
+}
+
+/* vop_time_increment width of a VOL, pInputStream follows its start code, 0 if cut short */
+static OMX_U32 Parse_Mpeg4_VOL_TimeIncBits(
+    OMX_U8 *pInputStream,
+    OMX_U32 buffSize)
+{
+    OMX_U32 bitPos = 0;
+    OMX_U32 verid = 1;
+    OMX_U32 shape;
+    OMX_U32 resolution;
+    OMX_U32 bits;
+
+    Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 9);         /* random_accessible_vol, video_object_type_indication */
+    if (Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 1)) {   /* is_object_layer_identifier */
+        verid = Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 4);
+        bitPos += 3;
+    }
+    if (Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 4) == 0xF) /* extended PAR */
+        bitPos += 16;
+    if (Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 1)) {   /* vol_control_parameters */
+        bitPos += 3;
+        if (Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 1)) /* vbv_parameters */
+            bitPos += 79;
+    }
+    shape = Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 2);
+    if ((shape == 3) && (verid != 1))
+        bitPos += 4;
+    bitPos += 1;
+    resolution = Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 16);
+
+    if ((bitPos > (buffSize << 3)) || (resolution == 0))
+        return 0;
+
+    for (bits = 1; (OMX_U32)(1 << bits) < resolution; bits++);
+
+    return bits;
+}
+
+/* vop_coded of a VOP, pInputStream follows its start code */
+static OMX_BOOL Check_Mpeg4_NotCodedVOP(
+    OMX_U8 *pInputStream,
+    OMX_U32 buffSize,
+    OMX_U32 timeIncBits)
+{
+    OMX_U32 bitPos = 2;  /* vop_coding_type */
+
+    while (Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 1)) { /* modulo_time_base */
+        if (bitPos > (buffSize << 3))
+            return OMX_FALSE;
+    }
+    bitPos += 1 + timeIncBits + 1;
+
+    if (Mpeg4_ReadBits(pInputStream, buffSize, &bitPos, 1) != 0)
+        return OMX_FALSE;
+
+    return (bitPos <= (buffSize << 3)) ? OMX_TRUE : OMX_FALSE;
+}
+
+/*
+ * Walks the start codes of one input buffer. Keeps the VOL time increment
+ * width, returns the offset of a second VOP when the buffer is packed and
+ * tells whether a single VOP is an N-VOP.
+ */
+static OMX_U32 Check_Mpeg4_PackedPB(
+    EXYNOS_MPEG4_PACKED_PB *pPackedPB,
+    OMX_U8                 *pInputStream,
+    OMX_U32                 buffSize,
+    OMX_BOOL               *pbNotCoded)
+{
+    unsigned startCode = 0xFFFFFFFF;
+    OMX_U32  firstVOP = 0;
+    OMX_U32  len;
+
+    *pbNotCoded = OMX_FALSE;
+
+    for (len = 0; len < buffSize; len++) {
+        startCode = (startCode << 8) | pInputStream[len];
+        if ((startCode >= 0x120) && (startCode <= 0x12F)) {
+            pPackedPB->nTimeIncBits = Parse_Mpeg4_VOL_TimeIncBits(pInputStream + len + 1, buffSize - len - 1);
+        } else if (startCode == 0x1B6) {
+            if (firstVOP != 0)
+                return len - 3;
+            firstVOP = len + 1;
+        }
+    }
+
+    if ((firstVOP != 0) && (pPackedPB->nTimeIncBits != 0))
+        *pbNotCoded = Check_Mpeg4_NotCodedVOP(pInputStream + firstVOP, buffSize - firstVOP, pPackedPB->nTimeIncBits);
+
+    return 0;
+}
+
+static void Mpeg4Dec_ResetPackedPB(EXYNOS_MPEG4_PACKED_PB *pPackedPB)
+{
+    pPackedPB->nPFrameTag = -1;
+    pPackedPB->bSecondPending = OMX_FALSE;
+    pPackedPB->bFirstReturned = OMX_FALSE;
+    pPackedPB->pBuffer = NULL;
+    pPackedPB->nSecondOffset = 0;
+    pPackedPB->nSecondSize = 0;
+}
+
 static int Check_H263_Frame(
     OMX_U8   *pInputStream,
     OMX_U32   buffSize,
@@ -565,9 +702,10 @@ OMX_ERRORTYPE Mpeg4CodecStop(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortInde
     pInbufOps  = pMpeg4Dec->hMFCMpeg4Handle.pInbufOps;
     pOutbufOps = pMpeg4Dec->hMFCMpeg4Handle.pOutbufOps;
 
-    if ((nPortIndex == INPUT_PORT_INDEX) && (pInbufOps != NULL))
+    if ((nPortIndex == INPUT_PORT_INDEX) && (pInbufOps != NULL)) {
         pInbufOps->Stop(hMFCHandle);
-    else if ((nPortIndex == OUTPUT_PORT_INDEX) && (pOutbufOps != NULL))
+        Mpeg4Dec_ResetPackedPB(&pMpeg4Dec->packedPB);
+    } else if ((nPortIndex == OUTPUT_PORT_INDEX) && (pOutbufOps != NULL))
         pOutbufOps->Stop(hMFCHandle);
 
     ret = OMX_ErrorNone;
@@ -719,7 +857,8 @@ OMX_ERRORTYPE Mpeg4CodecSrcSetup(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DA
         OMXBuffer->nFlags = pSrcInputData->nFlags;
         Exynos_OMX_OutputBufferReturn(pOMXComponent, OMXBuffer);
 
-        ret = OMX_ErrorNone;
+        /* the empty input is done with, it never goes to MFC */
+        ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
         goto EXIT;
     }
 
@@ -831,6 +970,10 @@ OMX_ERRORTYPE Mpeg4CodecSrcSetup(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DA
         pMpeg4Dec->hMFCMpeg4Handle.maxDPBNum += EXTRA_DPB_NUM;
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "Mpeg4CodecSetup nOutbufs: %d", pMpeg4Dec->hMFCMpeg4Handle.maxDPBNum);
 
+    /* every frame the MFC may still hold needs its own timestamp slot */
+    Exynos_TimestampMap_Resize(&pVideoDec->timestampMap,
+                               pMpeg4Dec->hMFCMpeg4Handle.maxDPBNum + pExynosInputPort->portDefinition.nBufferCountActual);
+
     pMpeg4Dec->hMFCMpeg4Handle.bConfiguredMFCSrc = OMX_TRUE;
 
     if ((pExynosOutputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
@@ -1647,10 +1790,16 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pMpeg4Dec->bDestinationStart = OMX_FALSE;
     Exynos_OSAL_SignalCreate(&pMpeg4Dec->hDestinationStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-    Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
-    pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp = 0;
-    pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp = 0;
+    Exynos_TimestampMap_Flush(&pVideoDec->timestampMap);
+
+    Exynos_OSAL_Memset(&pMpeg4Dec->packedPB, 0, sizeof(pMpeg4Dec->packedPB));
+    Mpeg4Dec_ResetPackedPB(&pMpeg4Dec->packedPB);
+#ifdef USE_MPEG4_PACKED_PB_SPLIT
+    /* DRM input can not be parsed, leave those streams to MFC */
+    if ((pMpeg4Dec->hMFCMpeg4Handle.codecType == CODEC_TYPE_MPEG4) &&
+        (pVideoDec->bDRMPlayerMode == OMX_FALSE))
+        pMpeg4Dec->packedPB.bEnable = OMX_TRUE;
+#endif
 
     pExynosComponent->getAllDelayBuffer = OMX_FALSE;
 
@@ -1766,6 +1915,12 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
     ExynosVideoDecBufferOps *pInbufOps  = pMpeg4Dec->hMFCMpeg4Handle.pInbufOps;
     ExynosVideoDecBufferOps *pOutbufOps = pMpeg4Dec->hMFCMpeg4Handle.pOutbufOps;
     ExynosVideoErrorType codecReturn = VIDEO_ERROR_NONE;
+    EXYNOS_MPEG4_PACKED_PB *pPackedPB = &pMpeg4Dec->packedPB;
+    OMX_U8  *pInputStream = pSrcInputData->buffer.singlePlaneBuffer.dataBuffer;
+    OMX_U32  nFlags = pSrcInputData->nFlags;
+    OMX_U32  nSplit = 0;
+    OMX_BOOL bNotCoded = OMX_FALSE;
+    OMX_S32 nTag = 0;
     int i;
 
     FunctionIn();
@@ -1778,20 +1933,54 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         ret = Mpeg4CodecDstSetup(pOMXComponent);
     }
 
-    if ((Check_Stream_StartCode(pSrcInputData->buffer.singlePlaneBuffer.dataBuffer, oneFrameSize, pMpeg4Dec->hMFCMpeg4Handle.codecType) == OMX_TRUE) ||
-        ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-        pExynosComponent->timeStamp[pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp] = pSrcInputData->timeStamp;
-        pExynosComponent->nFlags[pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp] = pSrcInputData->nFlags;
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp, pSrcInputData->nFlags);
-        pDecOps->Set_FrameTag(hMFCHandle, pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp);
-        pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp++;
-        pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp %= MAX_TIMESTAMP;
+    if (pPackedPB->bSecondPending == OMX_TRUE) {
+        /* the B-VOP reuses the buffer, so MFC has to be done with the P-VOP */
+        if (pPackedPB->bFirstReturned == OMX_FALSE) {
+            ret = OMX_ErrorInputDataDecodeYet;
+            goto EXIT;
+        }
+        Exynos_OSAL_Memmove(pInputStream, pInputStream + pPackedPB->nSecondOffset, pPackedPB->nSecondSize);
+        oneFrameSize = pPackedPB->nSecondSize;
+        pPackedPB->bSecondPending = OMX_FALSE;
+        pPackedPB->bFirstReturned = OMX_FALSE;
+        pPackedPB->pBuffer = NULL;
+    } else if ((pPackedPB->bEnable == OMX_TRUE) &&
+               (Check_Stream_StartCode(pInputStream, oneFrameSize, pMpeg4Dec->hMFCMpeg4Handle.codecType) == OMX_TRUE)) {
+        nSplit = Check_Mpeg4_PackedPB(pPackedPB, pInputStream, oneFrameSize, &bNotCoded);
+        if ((bNotCoded == OMX_TRUE) && (pPackedPB->nPFrameTag >= 0) &&
+            ((nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS)) {
+            /* N-VOP placeholder: its timestamp belongs to the P-VOP split out before */
+            Exynos_TimestampMap_Update(&pVideoDec->timestampMap, pPackedPB->nPFrameTag, pSrcInputData->timeStamp, nFlags);
+            pPackedPB->nPFrameTag = -1;
+            ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
+            goto EXIT;
+        }
+        pPackedPB->nPFrameTag = -1;
+        if (nSplit > 0) {
+            pPackedPB->pBuffer = pInputStream;
+            pPackedPB->nSecondOffset = nSplit;
+            pPackedPB->nSecondSize = oneFrameSize - nSplit;
+            pPackedPB->bFirstReturned = OMX_FALSE;
+            pPackedPB->bSecondPending = OMX_TRUE;
+            oneFrameSize = nSplit;
+            nFlags &= ~OMX_BUFFERFLAG_EOS;
+        }
+    }
+
+    if ((Check_Stream_StartCode(pInputStream, oneFrameSize, pMpeg4Dec->hMFCMpeg4Handle.codecType) == OMX_TRUE) ||
+        ((nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
+        nTag = Exynos_TimestampMap_Put(&pVideoDec->timestampMap, pSrcInputData->timeStamp, nFlags);
+        if (nSplit > 0)
+            pPackedPB->nPFrameTag = nTag;
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, nTag, nFlags);
+        pDecOps->Set_FrameTag(hMFCHandle, nTag);
 
         /* queue work for input buffer */
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "oneFrameSize: %d, bufferHeader: 0x%x, dataBuffer: 0x%x", oneFrameSize, pSrcInputData->bufferHeader, pSrcInputData->buffer.singlePlaneBuffer.dataBuffer);
         codecReturn = pInbufOps->Enqueue(hMFCHandle, (unsigned char **)&pSrcInputData->buffer.singlePlaneBuffer.dataBuffer,
                                     (unsigned int *)&oneFrameSize, MFC_INPUT_BUFFER_PLANE, pSrcInputData->bufferHeader);
         if (codecReturn != VIDEO_ERROR_NONE) {
+            Mpeg4Dec_ResetPackedPB(pPackedPB);
             ret = (OMX_ERRORTYPE)OMX_ErrorCodecDecode;
             Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "%s : %d", __FUNCTION__, __LINE__);
             goto EXIT;
@@ -1807,9 +1996,17 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
             Exynos_OSAL_SignalSet(pMpeg4Dec->hDestinationStartEvent);
             Exynos_OSAL_SleepMillisec(0);
         }
+    } else {
+        /* no start code, nothing for MFC to decode */
+        ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
+        goto EXIT;
     }
 
-    ret = OMX_ErrorNone;
+    /* keep the buffer until its B-VOP half is queued too */
+    if (pPackedPB->bSecondPending == OMX_TRUE)
+        ret = OMX_ErrorInputDataDecodeYet;
+    else
+        ret = OMX_ErrorNone;
 
 EXIT:
     FunctionOut();
@@ -1865,6 +2062,14 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_SrcOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
 
         /* For Share Buffer */
         pSrcOutputData->bufferHeader = (OMX_BUFFERHEADERTYPE*)pVideoBuffer->pPrivate;
+
+        if ((pMpeg4Dec->packedPB.bSecondPending == OMX_TRUE) &&
+            (pMpeg4Dec->packedPB.pBuffer == pSrcOutputData->buffer.singlePlaneBuffer.dataBuffer)) {
+            /* P-VOP of a packed buffer is done, the buffer goes back in with the B-VOP */
+            pMpeg4Dec->packedPB.bFirstReturned = OMX_TRUE;
+            ret = OMX_ErrorInputDataDecodeYet;
+            goto EXIT;
+        }
     }
 
     ret = OMX_ErrorNone;
@@ -1968,9 +2173,6 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
     if (ret != OMX_ErrorNone)
         goto EXIT;
 
-    pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp++;
-    pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp %= MAX_TIMESTAMP;
-
     pDstOutputData->allocSize = pDstOutputData->dataLen = 0;
     for (plane = 0; plane < MFC_OUTPUT_BUFFER_PLANE; plane++) {
         pDstOutputData->buffer.multiPlaneBuffer.dataBuffer[plane] = pVideoBuffer->planes[plane].addr;
@@ -1999,34 +2201,19 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
 
     indexTimestamp = pDecOps->Get_FrameTag(hMFCHandle);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "out indexTimestamp: %d", indexTimestamp);
-    if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
+    if (Exynos_TimestampMap_Get(&pVideoDec->timestampMap, indexTimestamp,
+                                &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
         if ((pExynosComponent->checkTimeStamp.needSetStartTimeStamp != OMX_TRUE) &&
-            (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE)) {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp];
+            (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE) &&
+            (Exynos_TimestampMap_GetNext(&pVideoDec->timestampMap,
+                                         &pDstOutputData->timeStamp, &pDstOutputData->nFlags) == OMX_TRUE)) {
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "missing out indexTimestamp: %d", indexTimestamp);
         } else {
             pDstOutputData->timeStamp = 0x00;
             pDstOutputData->nFlags = 0x00;
         }
-    } else {
-        /* For timestamp correction. if mfc support frametype detect */
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "disp_pic_frame_type: %d", pVideoBuffer->frameType);
-#ifdef NEED_TIMESTAMP_REORDER
-        if ((pVideoBuffer->frameType == VIDEO_FRAME_I)) {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-            pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp = indexTimestamp;
-        } else {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp];
-        }
-#else
-        pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-        pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-#endif
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
     }
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
 
     if ((displayStatus == VIDEO_FRAME_STATUS_CHANGE_RESOL) ||
         ((pDstOutputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
@@ -2102,7 +2289,7 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_srcOutputBufferProcess(OMX_COMPONENTTYPE *pOMXComp
     }
 
     ret = Exynos_Mpeg4Dec_SrcOut(pOMXComponent, pSrcOutputData);
-    if ((ret != OMX_ErrorNone) &&
+    if ((ret != OMX_ErrorNone) && (ret != OMX_ErrorInputDataDecodeYet) &&
         (pExynosComponent->currentState == OMX_StateExecuting)) {
         pExynosComponent->pCallbacks->EventHandler((OMX_HANDLETYPE)pOMXComponent,
                                                 pExynosComponent->callbackData,
@@ -2344,10 +2531,12 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent
     pVideoDec->exynos_codec_bufferProcessRun = &Mpeg4CodecOutputBufferProcessRun;
     pVideoDec->exynos_codec_enqueueAllBuffer = &Mpeg4CodecEnQueueAllBuffer;
 
-    if (codecType == CODEC_TYPE_MPEG4)
+    if (codecType == CODEC_TYPE_MPEG4) {
         pVideoDec->exynos_checkInputFrame = &Check_Mpeg4_Frame;
-    else
+        pVideoDec->exynos_checkNonReferenceFrame = &Check_Mpeg4_NonReferenceFrame;
+    } else {
         pVideoDec->exynos_checkInputFrame = &Check_H263_Frame;
+    }
 
     pVideoDec->exynos_codec_getCodecInputPrivateData  = &GetCodecInputPrivateData;
     pVideoDec->exynos_codec_getCodecOutputPrivateData = &GetCodecOutputPrivateData;
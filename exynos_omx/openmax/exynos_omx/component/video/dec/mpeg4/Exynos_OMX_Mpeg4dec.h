@@ -61,8 +61,6 @@ typedef struct _BitmapInfoHhr
 typedef struct _EXYNOS_MFC_MPEG4DEC_HANDLE
 {
     OMX_HANDLETYPE             hMFCHandle;
-    OMX_U32                    indexTimestamp;
-    OMX_U32                    outputIndexTimestamp;
     OMX_BOOL                   bConfiguredMFCSrc;
     OMX_BOOL                   bConfiguredMFCDst;
     OMX_U32                    maxDPBNum;
@@ -75,6 +73,22 @@ typedef struct _EXYNOS_MFC_MPEG4DEC_HANDLE
     ExynosVideoGeometry        codecOutbufConf;
 } EXYNOS_MFC_MPEG4DEC_HANDLE;
 
+/*
+ * Packed bitstream (DivX PB-frames): a P-VOP and the following B-VOP come
+ * in one buffer, then an N-VOP (vop_coded 0) holds the P-VOP's timestamp.
+ */
+typedef struct _EXYNOS_MPEG4_PACKED_PB
+{
+    OMX_BOOL          bEnable;
+    OMX_U32           nTimeIncBits;     /* vop_time_increment width from the VOL */
+    OMX_S32           nPFrameTag;       /* split P-VOP waiting for its N-VOP, -1 if none */
+    OMX_BOOL          bSecondPending;   /* B-VOP still to be queued from pBuffer */
+    volatile OMX_BOOL bFirstReturned;   /* MFC gave pBuffer back after the P-VOP */
+    OMX_U8           *pBuffer;
+    OMX_U32           nSecondOffset;
+    OMX_U32           nSecondSize;
+} EXYNOS_MPEG4_PACKED_PB;
+
 typedef struct _EXYNOS_MPEG4DEC_HANDLE
 {
     /* OMX Codec specific */
@@ -84,6 +98,7 @@ typedef struct _EXYNOS_MPEG4DEC_HANDLE
 
     /* EXYNOS MFC Codec specific */
     EXYNOS_MFC_MPEG4DEC_HANDLE          hMFCMpeg4Handle;
+    EXYNOS_MPEG4_PACKED_PB              packedPB;
 
     OMX_BOOL bSourceStart;
     OMX_BOOL bDestinationStart;
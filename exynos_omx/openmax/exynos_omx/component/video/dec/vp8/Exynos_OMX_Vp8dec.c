@@ -96,6 +96,63 @@ EXIT:
     return ret;
 }
 
+/*
+ * Uncompressed data chunk of a VP8 frame (RFC 6386, 9.1): a common 3-byte
+ * frame tag
+ * - 1-bit frame type (0 - key frame, 1 - inter frame)
+ * - 3-bit version number (0 - 3, profiles of different decoding complexity)
+ * - 1-bit show_frame flag (0 - not for display, e.g. an altref frame)
+ * - 19-bit size of the first data partition in bytes
+ * and on key frames 7 more bytes
+ * - 3-byte start code 0x9d 0x01 0x2a
+ * - 16 bits (2 bits horizontal scale << 14) | width (14 bits)
+ * - 16 bits (2 bits vertical scale << 14) | height (14 bits)
+ * The remaining partitions have no size field, the last one runs to the
+ * end of the frame, so the frame size itself comes from the container.
+ */
+static OMX_BOOL Parse_VP8_FrameHeader(
+    OMX_U8                  *pInputStream,
+    OMX_U32                  streamSize,
+    EXYNOS_VP8_FRAME_HEADER *pHeader)
+{
+    OMX_U32 frameTag;
+
+    Exynos_OSAL_Memset(pHeader, 0, sizeof(EXYNOS_VP8_FRAME_HEADER));
+
+    if ((pInputStream == NULL) || (streamSize < VP8_FRAME_TAG_SIZE))
+        return OMX_FALSE;
+
+    frameTag = pInputStream[0] | (pInputStream[1] << 8) | (pInputStream[2] << 16);
+    pHeader->bKeyFrame      = (frameTag & 0x1) ? OMX_FALSE : OMX_TRUE;
+    pHeader->nVersion       = (frameTag >> 1) & 0x7;
+    pHeader->bShowFrame     = ((frameTag >> 4) & 0x1) ? OMX_TRUE : OMX_FALSE;
+    pHeader->nFirstPartSize = (frameTag >> 5) & 0x7FFFF;
+    pHeader->nHeaderSize    = VP8_FRAME_TAG_SIZE;
+
+    if (pHeader->nVersion > 3) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "VP8 unknown version %d", pHeader->nVersion);
+        return OMX_FALSE;
+    }
+
+    if (pHeader->bKeyFrame == OMX_TRUE) {
+        if (streamSize < VP8_KEY_FRAME_HEADER_SIZE)
+            return OMX_FALSE;
+        if (pInputStream[3] != 0x9d || pInputStream[4] != 0x01 || pInputStream[5] != 0x2a) {
+            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "VP8 Key Frame Start Code not Found");
+            return OMX_FALSE;
+        }
+        pHeader->nWidth      = (pInputStream[6] | (pInputStream[7] << 8)) & 0x3fff;
+        pHeader->nHorizScale = pInputStream[7] >> 6;
+        pHeader->nHeight     = (pInputStream[8] | (pInputStream[9] << 8)) & 0x3fff;
+        pHeader->nVertScale  = pInputStream[9] >> 6;
+        pHeader->nHeaderSize = VP8_KEY_FRAME_HEADER_SIZE;
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "width = %d, height = %d, horizSscale = %d, vertScale = %d",
+                        pHeader->nWidth, pHeader->nHeight, pHeader->nHorizScale, pHeader->nVertScale);
+    }
+
+    return OMX_TRUE;
+}
+
 static int Check_VP8_Frame(
     OMX_U8   *pInputStream,
     int       buffSize,
@@ -103,65 +160,33 @@ static int Check_VP8_Frame(
     OMX_BOOL  bPreviousFrameEOF,
     OMX_BOOL *pbEndOfFrame)
 {
-    /* Uncompressed data Chunk comprises a common
-    (for key frames and interframes) 3-byte frame tag that
-    contains four fields
-    - 1-bit frame type (0 - key frame, 1 - inter frame)
-    - 3-bit version number (0 - 3 are defined as four different
-                                      profiles with different decoding complexity)
-    - 1-bit show_frame flag ( 0 - current frame not for display,
-                                          1 - current frame is for dispaly)
-    - 19-bit field - size of the first data partition in bytes
-
-    Key Frames : frame tag followed by 7 bytes of uncompressed
-    data
-    3-bytes : Start code (byte 0: 0x9d,byte 1: 0x01,byte 2: 0x2a)
-    Next 4-bytes: Width & height, Horizontal and vertical scale information
-    16 bits      :     (2 bits Horizontal Scale << 14) | Width (14 bits)
-    16 bits      :     (2 bits Vertical Scale << 14) | Height (14 bits)
-    */
-    int width, height;
-    int horizSscale, vertScale;
+    EXYNOS_VP8_FRAME_HEADER header;
 
     FunctionIn();
 
-    *pbEndOfFrame = OMX_TRUE;
-
-    /*Check for Key frame*/
-    if (!(pInputStream[0] & 0x01)){
-        /* Key Frame  Start code*/
-        if (pInputStream[3] != 0x9d || pInputStream[4] != 0x01 || pInputStream[5]!=0x2a) {
-            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, " VP8 Key Frame Start Code not Found");
-            *pbEndOfFrame = OMX_FALSE;
-        }
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, " VP8 Found Key Frame Start Code");
-        width = (pInputStream[6] | (pInputStream[7] << 8)) & 0x3fff;
-        horizSscale = pInputStream[7] >> 6;
-        height = (pInputStream[8] | (pInputStream[9] << 8)) & 0x3fff;
-        vertScale = pInputStream[9] >> 6;
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "width = %d, height = %d, horizSscale = %d, vertScale = %d", width, height, horizSscale, vertScale);
-    }
+    /* one frame per buffer, complete once the first partition is all there */
+    *pbEndOfFrame = OMX_FALSE;
+    if ((Parse_VP8_FrameHeader(pInputStream, buffSize, &header) == OMX_TRUE) &&
+        ((header.nHeaderSize + header.nFirstPartSize) <= (OMX_U32)buffSize))
+        *pbEndOfFrame = OMX_TRUE;
 
     FunctionOut();
     return buffSize;
 }
 
 OMX_BOOL Check_VP8_StartCode(
-    OMX_U8     *pInputStream,
-    OMX_U32     streamSize)
+    OMX_U8                  *pInputStream,
+    OMX_U32                  streamSize,
+    EXYNOS_VP8_FRAME_HEADER *pHeader)
 {
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "streamSize: %d",streamSize);
-    if (streamSize < 3) {
+    if (Parse_VP8_FrameHeader(pInputStream, streamSize, pHeader) != OMX_TRUE)
         return OMX_FALSE;
-    }
 
-    if (!(pInputStream[0] & 0x01)){
-        /* Key Frame  Start code*/
-        if (pInputStream[3] != 0x9d || pInputStream[4] != 0x01 || pInputStream[5]!=0x2a) {
-            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, " VP8 Key Frame Start Code not Found");
-            return OMX_FALSE;
-        }
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, " VP8 Found Key Frame Start Code");
+    if ((pHeader->nHeaderSize + pHeader->nFirstPartSize) > streamSize) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "VP8 first partition %d bytes, only %d in buffer",
+                        pHeader->nFirstPartSize, streamSize - pHeader->nHeaderSize);
+        return OMX_FALSE;
     }
 
     return OMX_TRUE;
@@ -534,7 +559,8 @@ OMX_ERRORTYPE VP8CodecSrcSetup(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA
         OMXBuffer->nFlags = pSrcInputData->nFlags;
         Exynos_OMX_OutputBufferReturn(pOMXComponent, OMXBuffer);
 
-        ret = OMX_ErrorNone;
+        /* the empty input is done with, it never goes to MFC */
+        ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
         goto EXIT;
     }
 
@@ -642,6 +668,10 @@ OMX_ERRORTYPE VP8CodecSrcSetup(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA
         pVp8Dec->hMFCVp8Handle.maxDPBNum += EXTRA_DPB_NUM;
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "Vp8CodecSetup nOutbufs: %d", pVp8Dec->hMFCVp8Handle.maxDPBNum);
 
+    /* every frame the MFC may still hold needs its own timestamp slot */
+    Exynos_TimestampMap_Resize(&pVideoDec->timestampMap,
+                               pVp8Dec->hMFCVp8Handle.maxDPBNum + pExynosInputPort->portDefinition.nBufferCountActual);
+
     pVp8Dec->hMFCVp8Handle.bConfiguredMFCSrc = OMX_TRUE;
 
     if ((pExynosOutputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
@@ -1239,10 +1269,7 @@ OMX_ERRORTYPE Exynos_VP8Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pVp8Dec->bDestinationStart = OMX_FALSE;
     Exynos_OSAL_SignalCreate(&pVp8Dec->hDestinationStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-    Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
-    pVp8Dec->hMFCVp8Handle.indexTimestamp = 0;
-    pVp8Dec->hMFCVp8Handle.outputIndexTimestamp = 0;
+    Exynos_TimestampMap_Flush(&pVideoDec->timestampMap);
 
     pExynosComponent->getAllDelayBuffer = OMX_FALSE;
 
@@ -1358,6 +1385,8 @@ OMX_ERRORTYPE Exynos_VP8Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_D
     ExynosVideoDecBufferOps *pInbufOps  = pVp8Dec->hMFCVp8Handle.pInbufOps;
     ExynosVideoDecBufferOps *pOutbufOps = pVp8Dec->hMFCVp8Handle.pOutbufOps;
     ExynosVideoErrorType codecReturn = VIDEO_ERROR_NONE;
+    EXYNOS_VP8_FRAME_HEADER frameHeader;
+    OMX_S32 nTag = 0;
     int i;
 
     FunctionIn();
@@ -1370,14 +1399,16 @@ OMX_ERRORTYPE Exynos_VP8Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_D
         ret = VP8CodecDstSetup(pOMXComponent);
     }
 
-    if ((Check_VP8_StartCode(pSrcInputData->buffer.singlePlaneBuffer.dataBuffer, oneFrameSize) == OMX_TRUE) ||
+    if ((Check_VP8_StartCode(pSrcInputData->buffer.singlePlaneBuffer.dataBuffer, oneFrameSize, &frameHeader) == OMX_TRUE) ||
         ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-        pExynosComponent->timeStamp[pVp8Dec->hMFCVp8Handle.indexTimestamp] = pSrcInputData->timeStamp;
-        pExynosComponent->nFlags[pVp8Dec->hMFCVp8Handle.indexTimestamp] = pSrcInputData->nFlags;
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pVp8Dec->hMFCVp8Handle.indexTimestamp, pSrcInputData->nFlags);
-        pDecOps->Set_FrameTag(hMFCHandle, pVp8Dec->hMFCVp8Handle.indexTimestamp);
-        pVp8Dec->hMFCVp8Handle.indexTimestamp++;
-        pVp8Dec->hMFCVp8Handle.indexTimestamp %= MAX_TIMESTAMP;
+        /* an invisible frame never comes out for display, keep it out of the map */
+        if ((frameHeader.bShowFrame == OMX_FALSE) && (oneFrameSize > 0) &&
+            ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS))
+            nTag = TIMESTAMP_TAG_UNTRACKED;
+        else
+            nTag = Exynos_TimestampMap_Put(&pVideoDec->timestampMap, pSrcInputData->timeStamp, pSrcInputData->nFlags);
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, nTag, pSrcInputData->nFlags);
+        pDecOps->Set_FrameTag(hMFCHandle, nTag);
 
         /* queue work for input buffer */
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "oneFrameSize: %d, bufferHeader: 0x%x, dataBuffer: 0x%x", oneFrameSize, pSrcInputData->bufferHeader, pSrcInputData->buffer.singlePlaneBuffer.dataBuffer);
@@ -1399,6 +1430,10 @@ OMX_ERRORTYPE Exynos_VP8Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_D
             Exynos_OSAL_SignalSet(pVp8Dec->hDestinationStartEvent);
             Exynos_OSAL_SleepMillisec(0);
         }
+    } else {
+        /* a frame the header check rejected never reaches MFC */
+        ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
+        goto EXIT;
     }
 
     ret = OMX_ErrorNone;
@@ -1560,9 +1595,6 @@ OMX_ERRORTYPE Exynos_VP8Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
     if (ret != OMX_ErrorNone)
         goto EXIT;
 
-    pVp8Dec->hMFCVp8Handle.outputIndexTimestamp++;
-    pVp8Dec->hMFCVp8Handle.outputIndexTimestamp %= MAX_TIMESTAMP;
-
     pDstOutputData->allocSize = pDstOutputData->dataLen = 0;
     for (plane = 0; plane < MFC_OUTPUT_BUFFER_PLANE; plane++) {
         pDstOutputData->buffer.multiPlaneBuffer.dataBuffer[plane] = pVideoBuffer->planes[plane].addr;
@@ -1591,34 +1623,19 @@ OMX_ERRORTYPE Exynos_VP8Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
 
     indexTimestamp = pDecOps->Get_FrameTag(hMFCHandle);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "out indexTimestamp: %d", indexTimestamp);
-    if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
+    if (Exynos_TimestampMap_Get(&pVideoDec->timestampMap, indexTimestamp,
+                                &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
         if ((pExynosComponent->checkTimeStamp.needSetStartTimeStamp != OMX_TRUE) &&
-            (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE)) {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[pVp8Dec->hMFCVp8Handle.outputIndexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[pVp8Dec->hMFCVp8Handle.outputIndexTimestamp];
+            (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE) &&
+            (Exynos_TimestampMap_GetNext(&pVideoDec->timestampMap,
+                                         &pDstOutputData->timeStamp, &pDstOutputData->nFlags) == OMX_TRUE)) {
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "missing out indexTimestamp: %d", indexTimestamp);
         } else {
             pDstOutputData->timeStamp = 0x00;
             pDstOutputData->nFlags = 0x00;
         }
-    } else {
-        /* For timestamp correction. if mfc support frametype detect */
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "disp_pic_frame_type: %d", pVideoBuffer->frameType);
-#ifdef NEED_TIMESTAMP_REORDER
-        if ((pVideoBuffer->frameType == VIDEO_FRAME_I)) {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-            pVp8Dec->hMFCVp8Handle.outputIndexTimestamp = indexTimestamp;
-        } else {
-            pDstOutputData->timeStamp = pExynosComponent->timeStamp[pVp8Dec->hMFCVp8Handle.outputIndexTimestamp];
-            pDstOutputData->nFlags = pExynosComponent->nFlags[pVp8Dec->hMFCVp8Handle.outputIndexTimestamp];
-        }
-#else
-        pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-        pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-#endif
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
     }
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
 
     if ((displayStatus == VIDEO_FRAME_STATUS_CHANGE_RESOL) ||
         ((pDstOutputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
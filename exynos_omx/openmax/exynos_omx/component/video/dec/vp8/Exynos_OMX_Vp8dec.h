@@ -34,11 +34,25 @@
 #include "ExynosVideoApi.h"
 
 
+#define VP8_FRAME_TAG_SIZE          3
+#define VP8_KEY_FRAME_HEADER_SIZE   10  /* frame tag, start code, width, height */
+
+typedef struct _EXYNOS_VP8_FRAME_HEADER
+{
+    OMX_BOOL bKeyFrame;
+    OMX_U32  nVersion;
+    OMX_BOOL bShowFrame;        /* OMX_FALSE for an altref or golden only update */
+    OMX_U32  nFirstPartSize;
+    OMX_U32  nHeaderSize;       /* uncompressed bytes before the first partition */
+    OMX_U32  nWidth;
+    OMX_U32  nHeight;
+    OMX_U32  nHorizScale;
+    OMX_U32  nVertScale;
+} EXYNOS_VP8_FRAME_HEADER;
+
 typedef struct _EXYNOS_MFC_VP8DEC_HANDLE
 {
     OMX_HANDLETYPE             hMFCHandle;
-    OMX_U32                    indexTimestamp;
-    OMX_U32                    outputIndexTimestamp;
     OMX_BOOL                   bConfiguredMFCSrc;
     OMX_BOOL                   bConfiguredMFCDst;
     OMX_U32                    maxDPBNum;
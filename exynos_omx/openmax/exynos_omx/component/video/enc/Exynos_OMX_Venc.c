@@ -28,11 +28,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "Exynos_OMX_Macros.h"
 #include "Exynos_OSAL_Event.h"
 #include "Exynos_OMX_Venc.h"
 #include "Exynos_OMX_VencControl.h"
 #include "Exynos_OMX_Basecomponent.h"
+#include "Exynos_OMX_Resourcemanager.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_SharedMemory.h"
@@ -96,6 +98,129 @@ OMX_BOOL Exynos_Check_BufferProcess_State(EXYNOS_OMX_BASECOMPONENT *pExynosCompo
     return ret;
 }
 
+/* marks runtime encoder parameters changed by SetConfig/SetParameter */
+void Exynos_Set_DynamicParamMask(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nDirtyMask)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+
+    Exynos_OSAL_MutexLock(pExynosComponent->compMutex);
+    pVideoEnc->nDynamicParamMask |= nDirtyMask;
+    Exynos_OSAL_MutexUnlock(pExynosComponent->compMutex);
+}
+
+/* returns and clears the changed parameters, to apply them before the next frame */
+OMX_U32 Exynos_Fetch_DynamicParamMask(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    OMX_U32 nDirtyMask;
+
+    Exynos_OSAL_MutexLock(pExynosComponent->compMutex);
+    nDirtyMask = pVideoEnc->nDynamicParamMask;
+    pVideoEnc->nDynamicParamMask = 0;
+    Exynos_OSAL_MutexUnlock(pExynosComponent->compMutex);
+
+    return nDirtyMask;
+}
+
+/* number of codec input buffers circulated in copy mode, bounding the frames queued to MFC */
+OMX_U32 Exynos_Get_InputCodecBufferNum(EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc)
+{
+    if (pVideoEnc->bLowLatency == OMX_TRUE)
+        return MFC_INPUT_BUFFER_NUM_LOWLATENCY;
+
+    return MFC_INPUT_BUFFER_NUM_MAX;
+}
+
+/*
+ * Output buffers can be registered to MFC as destination buffers only when
+ * every one of them was allocated by the component (ION backed) and holds a
+ * worst case frame. Buffers given through UseBuffer go through the copy path.
+ */
+OMX_BOOL Exynos_Check_OutputBufferShareable(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_BASEPORT  *exynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+    OMX_BUFFERHEADERTYPE *bufferHeader = NULL;
+    OMX_U32               nMinSize = 0;
+    OMX_U32               i = 0;
+
+    nMinSize = (exynosOutputPort->portDefinition.format.video.nFrameWidth *
+                exynosOutputPort->portDefinition.format.video.nFrameHeight * 3) / 2;
+
+    for (i = 0; i < exynosOutputPort->portDefinition.nBufferCountActual; i++) {
+        bufferHeader = exynosOutputPort->extendBufferHeader[i].OMXBufferHeader;
+        if ((bufferHeader == NULL) ||
+            !(exynosOutputPort->bufferStateAllocate[i] & BUFFER_STATE_ALLOCATED) ||
+            (exynosOutputPort->extendBufferHeader[i].buf_fd[0] < 0) ||
+            (bufferHeader->nAllocLen < nMinSize))
+            return OMX_FALSE;
+    }
+
+    return OMX_TRUE;
+}
+
+static OMX_TICKS Exynos_Get_MonotonicTimeUs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((OMX_TICKS)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+void Exynos_Mark_InputTime(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_S32 nTag)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+
+    if ((nTag < 0) || (nTag >= MAX_TIMESTAMP))
+        return;
+
+    pVideoEnc->inputTime[nTag] = Exynos_Get_MonotonicTimeUs();
+}
+
+void Exynos_Update_OutputLatency(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_S32 nTag)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT        *pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_VIDEO_CONFIG_LATENCYSTATS *pStats = &pVideoEnc->latencyStats;
+    OMX_U32 nLatencyUs;
+
+    if ((nTag < 0) || (nTag >= MAX_TIMESTAMP) || (pVideoEnc->inputTime[nTag] == 0))
+        return;
+
+    nLatencyUs = (OMX_U32)(Exynos_Get_MonotonicTimeUs() - pVideoEnc->inputTime[nTag]);
+    pVideoEnc->inputTime[nTag] = 0;
+
+    Exynos_OSAL_MutexLock(pExynosComponent->compMutex);
+    pStats->nLastUs = nLatencyUs;
+    /* running average, exact over the first frames and then weighted 1/16 */
+    if (pStats->nFrames < 16)
+        pStats->nAverageUs = ((pStats->nAverageUs * pStats->nFrames) + nLatencyUs) / (pStats->nFrames + 1);
+    else
+        pStats->nAverageUs = pStats->nAverageUs - (pStats->nAverageUs >> 4) + (nLatencyUs >> 4);
+    if (nLatencyUs > pStats->nMaxUs)
+        pStats->nMaxUs = nLatencyUs;
+    pStats->nFrames++;
+    Exynos_OSAL_MutexUnlock(pExynosComponent->compMutex);
+
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "encode latency %u us (avg %u us, max %u us)",
+                    nLatencyUs, pStats->nAverageUs, pStats->nMaxUs);
+}
+
+/* size of the H.264 slice at the head of pBuffer, up to the next start code */
+static OMX_U32 Exynos_Get_SliceSize(OMX_U8 *pBuffer, OMX_U32 size)
+{
+    OMX_U32 i;
+
+    for (i = 4; i + 3 <= size; i++) {
+        if ((pBuffer[i] == 0x00) && (pBuffer[i + 1] == 0x00) && (pBuffer[i + 2] == 0x01)) {
+            /* four byte start code */
+            if (pBuffer[i - 1] == 0x00)
+                return i - 1;
+            return i;
+        }
+    }
+
+    return size;
+}
+
 OMX_ERRORTYPE Exynos_Input_CodecBufferToData(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_PTR codecBuffer, EXYNOS_OMX_DATA *pData)
 {
     OMX_ERRORTYPE                  ret = OMX_ErrorNone;
@@ -104,6 +229,8 @@ OMX_ERRORTYPE Exynos_Input_CodecBufferToData(EXYNOS_OMX_BASECOMPONENT *pExynosCo
 
     pData->buffer.multiPlaneBuffer.dataBuffer[0] = pInputCodecBuffer->pVirAddr[0];
     pData->buffer.multiPlaneBuffer.dataBuffer[1] = pInputCodecBuffer->pVirAddr[1];
+    pData->buffer.multiPlaneBuffer.fd[0] = pInputCodecBuffer->fd[0];
+    pData->buffer.multiPlaneBuffer.fd[1] = pInputCodecBuffer->fd[1];
     pData->allocSize     = pInputCodecBuffer->bufferSize[0] + pInputCodecBuffer->bufferSize[1];
     pData->dataLen       = pInputCodecBuffer->dataSize;
     pData->usedDataLen   = 0;
@@ -139,6 +266,20 @@ OMX_ERRORTYPE Exynos_Output_CodecBufferToData(EXYNOS_OMX_BASECOMPONENT *pExynosC
     return ret;
 }
 
+void Exynos_Input_ReturnData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData)
+{
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_BASEPORT      *exynosInputPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+
+    if ((exynosInputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
+        if (pSrcInputData->pPrivate != NULL)
+            Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, pSrcInputData->pPrivate);
+    } else if (pSrcInputData->bufferHeader != NULL) {
+        Exynos_OMX_InputBufferReturn(pOMXComponent, pSrcInputData->bufferHeader);
+    }
+    Exynos_ResetCodecData(pSrcInputData);
+}
+
 void Exynos_Wait_ProcessPause(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nPortIndex)
 {
     EXYNOS_OMX_BASEPORT *exynosOMXInputPort  = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
@@ -164,6 +305,84 @@ void Exynos_Wait_ProcessPause(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U3
     return;
 }
 
+#ifdef USE_METADATABUFFERTYPE
+/*
+ * Converts a gralloc RGB buffer into the MFC input planes on GScaler,
+ * by fd on both sides. Returns OMX_FALSE when the scaler is not available
+ * (held by another user) or the buffer is not something it can read, and
+ * the caller converts on the cpu instead.
+ */
+static OMX_BOOL Exynos_CSC_InputData_HW(
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc,
+    OMX_U32                        handle,
+    OMX_U32                        nFrameWidth,
+    OMX_U32                        nFrameHeight,
+    EXYNOS_OMX_DATA               *srcInputData)
+{
+    ExynosVideoPlane planes[MAX_BUFFER_PLANE];
+    OMX_U32          halFormat = 0;
+    OMX_U32          stride = 0;
+    unsigned char   *pSrcBuf[3] = {NULL, };
+    unsigned char   *pDstBuf[3] = {NULL, };
+
+    if (pVideoEnc->csc_hw_handle == NULL)
+        return OMX_FALSE;
+
+    if (Exynos_OSAL_GetANBHandlePlanes(handle, planes, &halFormat, &stride) != OMX_ErrorNone)
+        return OMX_FALSE;
+
+    switch (halFormat) {
+    case HAL_PIXEL_FORMAT_RGBA_8888:
+    case HAL_PIXEL_FORMAT_RGBX_8888:
+    case HAL_PIXEL_FORMAT_BGRA_8888:
+        break;
+    default:
+        return OMX_FALSE;
+    }
+
+    if (stride < nFrameWidth)
+        stride = nFrameWidth;
+
+    pSrcBuf[0] = (unsigned char *)planes[0].fd;
+    pDstBuf[0] = (unsigned char *)srcInputData->buffer.multiPlaneBuffer.fd[0];
+    pDstBuf[1] = (unsigned char *)srcInputData->buffer.multiPlaneBuffer.fd[1];
+
+    csc_set_src_format(
+        pVideoEnc->csc_hw_handle,   /* handle */
+        stride,                     /* width */
+        nFrameHeight,               /* height */
+        0,                          /* crop_left */
+        0,                          /* crop_right */
+        nFrameWidth,                /* crop_width */
+        nFrameHeight,               /* crop_height */
+        halFormat,                  /* color_format */
+        0);                         /* cacheable */
+    csc_set_dst_format(
+        pVideoEnc->csc_hw_handle,   /* handle */
+        nFrameWidth,                /* width */
+        nFrameHeight,               /* height */
+        0,                          /* crop_left */
+        0,                          /* crop_right */
+        nFrameWidth,                /* crop_width */
+        nFrameHeight,               /* crop_height */
+        omx_2_hal_pixel_format((unsigned int)OMX_COLOR_FormatYUV420SemiPlanar), /* color_format */
+        0);                         /* cacheable */
+    csc_set_src_buffer(
+        pVideoEnc->csc_hw_handle,   /* handle */
+        pSrcBuf);                   /* FD */
+    csc_set_dst_buffer(
+        pVideoEnc->csc_hw_handle,   /* handle */
+        pDstBuf);                   /* FD */
+
+    if (csc_convert(pVideoEnc->csc_hw_handle) != CSC_ErrorNone) {
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "%s: scaler not available, use sw csc", __FUNCTION__);
+        return OMX_FALSE;
+    }
+
+    return OMX_TRUE;
+}
+#endif
+
 OMX_BOOL Exynos_CSC_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *srcInputData)
 {
     OMX_BOOL                       ret = OMX_FALSE;
@@ -224,6 +443,11 @@ OMX_BOOL Exynos_CSC_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA
             OMX_U32 stride;
             int imageSize;
 
+            if (Exynos_CSC_InputData_HW(pVideoEnc, (OMX_U32)ppBuf[0], nFrameWidth, nFrameHeight, srcInputData) == OMX_TRUE) {
+                ret = OMX_TRUE;
+                goto EXIT;
+            }
+
             Exynos_OSAL_LockANBHandle((OMX_U32)ppBuf[0], nFrameWidth, nFrameHeight, OMX_COLOR_FormatAndroidOpaque, planes);
             imageSize = nFrameWidth * nFrameHeight * 3; /* RGB888 */
 
@@ -461,9 +685,11 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
 {
     OMX_BOOL                  ret = OMX_FALSE;
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
     EXYNOS_OMX_BASEPORT      *exynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
     EXYNOS_OMX_DATABUFFER    *outputUseBuffer = &exynosOutputPort->way.port2WayDataBuffer.outputDataBuffer;
     OMX_U32                   copySize = 0;
+    OMX_U32                   nFlags = 0;
 
     FunctionIn();
 
@@ -491,16 +717,31 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
         }
 
         if ((exynosOutputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
-            if (dstOutputData->remainDataLen <= (outputUseBuffer->allocSize - outputUseBuffer->dataLen)) {
-                copySize = dstOutputData->remainDataLen;
+            copySize = dstOutputData->remainDataLen;
+            nFlags = dstOutputData->nFlags;
+            if ((pVideoEnc->bSliceOutput == OMX_TRUE) && (copySize > 0) &&
+                !(dstOutputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+                /* one slice per output buffer, only the last one ends the frame */
+                copySize = Exynos_Get_SliceSize(dstOutputData->buffer.singlePlaneBuffer.dataBuffer + dstOutputData->usedDataLen,
+                                                dstOutputData->remainDataLen);
+                if (copySize < dstOutputData->remainDataLen)
+                    nFlags &= ~(OMX_BUFFERFLAG_ENDOFFRAME | OMX_BUFFERFLAG_EOS);
+            }
+
+            if (copySize <= (outputUseBuffer->allocSize - outputUseBuffer->dataLen)) {
                 if (copySize > 0)
                     Exynos_OSAL_Memcpy((outputUseBuffer->bufferHeader->pBuffer + outputUseBuffer->dataLen),
                                        (dstOutputData->buffer.singlePlaneBuffer.dataBuffer + dstOutputData->usedDataLen),
                                        copySize);
+                pVideoEnc->nOutputCopyBytes += copySize;
                 outputUseBuffer->dataLen += copySize;
                 outputUseBuffer->remainDataLen += copySize;
-                outputUseBuffer->nFlags = dstOutputData->nFlags;
+                outputUseBuffer->nFlags = nFlags;
                 outputUseBuffer->timeStamp = dstOutputData->timeStamp;
+                if (pVideoEnc->bSliceOutput == OMX_TRUE) {
+                    dstOutputData->usedDataLen += copySize;
+                    dstOutputData->remainDataLen -= copySize;
+                }
 
                 ret = OMX_TRUE;
 
@@ -516,6 +757,7 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                 ret = OMX_FALSE;
             }
         } else if (exynosOutputPort->bufferProcessType == BUFFER_SHARE) {
+            pVideoEnc->nOutputZeroCopyBytes += outputUseBuffer->remainDataLen;
             if ((outputUseBuffer->remainDataLen > 0) ||
                 ((outputUseBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) ||
                 (CHECK_PORT_BEING_FLUSHED(exynosOutputPort)))
@@ -593,7 +835,8 @@ OMX_ERRORTYPE Exynos_OMX_ExtensionSetup(OMX_HANDLETYPE hComponent)
                     Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[0]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[0]);
                     Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[1]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[1]);
 
-                    Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, pVideoEnc->pMFCEncInputBuffer[i]);
+                    if (i < Exynos_Get_InputCodecBufferNum(pVideoEnc))
+                        Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, pVideoEnc->pMFCEncInputBuffer[i]);
                 }
             } else if (exynosInputPort->bufferProcessType == BUFFER_SHARE) {
                 /*************/
@@ -677,7 +920,16 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
                 break;
             }
 
+            Exynos_OMX_Sched_Acquire(pOMXComponent, pSrcInputData->timeStamp);
             ret = pVideoEnc->exynos_codec_srcInputProcess(pOMXComponent, pSrcInputData);
+            if (ret == (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer) {
+                /* nothing went to MFC, so no source output will return the buffer or its credit */
+                Exynos_OMX_Sched_Release(pOMXComponent);
+                Exynos_Input_ReturnData(pOMXComponent, pSrcInputData);
+                ret = OMX_ErrorNone;
+            } else if (ret != OMX_ErrorNone) {
+                Exynos_OMX_Sched_Release(pOMXComponent);
+            }
             Exynos_ResetCodecData(pSrcInputData);
             Exynos_OSAL_MutexUnlock(srcInputUseBuffer->bufferMutex);
             if (ret == OMX_ErrorCodecInit)
@@ -721,6 +973,8 @@ OMX_ERRORTYPE Exynos_OMX_SrcOutputBufferProcess(OMX_HANDLETYPE hComponent)
             ret = pVideoEnc->exynos_codec_srcOutputProcess(pOMXComponent, &srcOutputData);
 
             if (ret == OMX_ErrorNone) {
+                if ((srcOutputData.bufferHeader != NULL) || (srcOutputData.pPrivate != NULL))
+                    Exynos_OMX_Sched_Release(pOMXComponent);
                 if ((exynosInputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
                     OMX_PTR codecBuffer;
                     codecBuffer = srcOutputData.pPrivate;
@@ -820,6 +1074,7 @@ OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent)
     EXYNOS_OMX_BASEPORT      *exynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
     EXYNOS_OMX_DATABUFFER    *dstOutputUseBuffer = &exynosOutputPort->way.port2WayDataBuffer.outputDataBuffer;
     EXYNOS_OMX_DATA          *pDstOutputData = &exynosOutputPort->processData;
+    OMX_BOOL                  bSlicePending = OMX_FALSE;
     
     FunctionIn();
 
@@ -831,8 +1086,14 @@ OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent)
                (!pVideoEnc->bExitBufferProcessThread)) {
             Exynos_OSAL_SleepMillisec(0);
 
-            if (CHECK_PORT_BEING_FLUSHED(exynosOutputPort))
+            if (CHECK_PORT_BEING_FLUSHED(exynosOutputPort)) {
+                /* the flush gives every codec buffer back, drop the rest of the frame */
+                if (bSlicePending == OMX_TRUE) {
+                    Exynos_ResetCodecData(pDstOutputData);
+                    bSlicePending = OMX_FALSE;
+                }
                 break;
+            }
 
             Exynos_OSAL_MutexLock(dstOutputUseBuffer->bufferMutex);
             if ((exynosOutputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
@@ -846,26 +1107,33 @@ OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent)
                 }
             }
 
-            if ((dstOutputUseBuffer->dataValid == OMX_TRUE) ||
-                (exynosOutputPort->bufferProcessType == BUFFER_SHARE))
+            if (((dstOutputUseBuffer->dataValid == OMX_TRUE) ||
+                 (exynosOutputPort->bufferProcessType == BUFFER_SHARE)) &&
+                (bSlicePending == OMX_FALSE))
                 ret = pVideoEnc->exynos_codec_dstOutputProcess(pOMXComponent, pDstOutputData);
 
             if (((ret == OMX_ErrorNone) && (dstOutputUseBuffer->dataValid == OMX_TRUE)) ||
                 (exynosOutputPort->bufferProcessType == BUFFER_SHARE)) {
-                Exynos_Postprocess_OutputData(pOMXComponent, pDstOutputData);
+                /* the remaining slices of the frame go out in the next output buffers */
+                bSlicePending = ((Exynos_Postprocess_OutputData(pOMXComponent, pDstOutputData) == OMX_TRUE) &&
+                                 (pVideoEnc->bSliceOutput == OMX_TRUE) &&
+                                 (pDstOutputData->usedDataLen > 0) &&
+                                 (pDstOutputData->remainDataLen > 0)) ? OMX_TRUE : OMX_FALSE;
             }
 
-            if ((exynosOutputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
-                OMX_PTR codecBuffer;
-                codecBuffer = pDstOutputData->pPrivate;
-                if (codecBuffer != NULL) {
-                    Exynos_CodecBufferEnQueue(pExynosComponent, OUTPUT_PORT_INDEX, codecBuffer);
-                    pDstOutputData->pPrivate = NULL;
+            if (bSlicePending == OMX_FALSE) {
+                if ((exynosOutputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY) {
+                    OMX_PTR codecBuffer;
+                    codecBuffer = pDstOutputData->pPrivate;
+                    if (codecBuffer != NULL) {
+                        Exynos_CodecBufferEnQueue(pExynosComponent, OUTPUT_PORT_INDEX, codecBuffer);
+                        pDstOutputData->pPrivate = NULL;
+                    }
                 }
-            }
 
-            /* reset outputData */
-            Exynos_ResetCodecData(pDstOutputData);
+                /* reset outputData */
+                Exynos_ResetCodecData(pDstOutputData);
+            }
             Exynos_OSAL_MutexUnlock(dstOutputUseBuffer->bufferMutex);
         }
     }
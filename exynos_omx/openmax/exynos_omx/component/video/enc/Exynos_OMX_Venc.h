@@ -46,6 +46,7 @@
 #define DEFAULT_VIDEO_OUTPUT_BUFFER_SIZE   (DEFAULT_FRAME_WIDTH * DEFAULT_FRAME_HEIGHT) * 2
 
 #define MFC_INPUT_BUFFER_NUM_MAX            3
+#define MFC_INPUT_BUFFER_NUM_LOWLATENCY     1 /* no frame waits behind the one being encoded */
 #define MFC_OUTPUT_BUFFER_NUM_MAX           4
 
 #define DEFAULT_MFC_INPUT_YBUFFER_SIZE      ALIGN_TO_16B(1920) * ALIGN_TO_16B(1080)
@@ -97,6 +98,7 @@ typedef struct _EXYNOS_OMX_VIDEOENC_COMPONENT
 
     OMX_BOOL configChange;
     OMX_BOOL IntraRefreshVOP;
+    OMX_U32  nDynamicParamMask; /* ExynosVideoEncDynamicParamMask bits changed since the last frame */
     OMX_VIDEO_CONTROLRATETYPE eControlRate[ALL_PORT_NUM];
     OMX_VIDEO_PARAM_QUANTIZATIONTYPE quantization;
 
@@ -105,8 +107,21 @@ typedef struct _EXYNOS_OMX_VIDEOENC_COMPONENT
 
     OMX_COLOR_FORMATTYPE ANBColorFormat;
 
+    /* Low latency mode */
+    OMX_BOOL bLowLatency;
+    OMX_U32  nSliceMode;
+    OMX_U32  nSliceArgument;
+    OMX_BOOL bSliceOutput;      /* return each slice of a frame in its own output buffer */
+    OMX_TICKS inputTime[MAX_TIMESTAMP];
+    EXYNOS_OMX_VIDEO_CONFIG_LATENCYSTATS latencyStats;
+
+    /* encoded bytes returned through a copy vs written by MFC in place */
+    OMX_U64 nOutputCopyBytes;
+    OMX_U64 nOutputZeroCopyBytes;
+
     /* CSC handle */
     OMX_PTR csc_handle;
+    OMX_PTR csc_hw_handle;      /* GScaler, for metadata RGB input */
     OMX_U32 csc_set_format;
 
     OMX_ERRORTYPE (*exynos_codec_srcInputProcess) (OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData);
@@ -133,6 +148,13 @@ inline void Exynos_UpdateFrameSize(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_BOOL Exynos_Check_BufferProcess_State(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nPortIndex);
 OMX_ERRORTYPE Exynos_Input_CodecBufferToData(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_PTR codecBuffer, EXYNOS_OMX_DATA *pData);
 OMX_ERRORTYPE Exynos_Output_CodecBufferToData(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_PTR codecBuffer, EXYNOS_OMX_DATA *pData);
+void Exynos_Set_DynamicParamMask(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nDirtyMask);
+OMX_U32 Exynos_Fetch_DynamicParamMask(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
+OMX_U32 Exynos_Get_InputCodecBufferNum(EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc);
+OMX_BOOL Exynos_Check_OutputBufferShareable(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
+void Exynos_Mark_InputTime(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_S32 nTag);
+void Exynos_Update_OutputLatency(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_S32 nTag);
+void Exynos_Input_ReturnData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData);
 
 
 OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent);
@@ -32,6 +32,7 @@
 #include "Exynos_OMX_Venc.h"
 #include "Exynos_OMX_VencControl.h"
 #include "Exynos_OMX_Basecomponent.h"
+#include "Exynos_OMX_Resourcemanager.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
@@ -192,7 +193,9 @@ OMX_ERRORTYPE Exynos_OMX_AllocateBuffer(
         goto EXIT;
     }
 
-    if (pExynosPort->bufferProcessType == BUFFER_SHARE) {
+    /* output buffers may be handed to MFC as they are, keep them uncached */
+    if ((pExynosPort->bufferProcessType == BUFFER_SHARE) ||
+        (nPortIndex == OUTPUT_PORT_INDEX)) {
         mem_type = NORMAL_MEMORY;
     } else {
         mem_type = SYSTEM_MEMORY;
@@ -546,6 +549,7 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 n
             pExynosComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_FALSE;
             Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
             Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
+            Exynos_OMX_Sched_Flush(pOMXComponent);
             pExynosComponent->getAllDelayBuffer = OMX_FALSE;
             pExynosComponent->bSaveFlagEOS = OMX_FALSE;
             pExynosComponent->reInputData = OMX_FALSE;
@@ -1194,6 +1198,26 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeGetParameter(
             portDefinition->nBufferSize = MAX_INPUT_METADATA_BUFFER_SIZE;
         }
 #endif
+    }
+        break;
+    case OMX_IndexParamVideoLowLatency:
+    {
+        EXYNOS_OMX_VIDEO_PARAM_LOWLATENCY *pLowLatency = (EXYNOS_OMX_VIDEO_PARAM_LOWLATENCY *)ComponentParameterStructure;
+        EXYNOS_OMX_VIDEOENC_COMPONENT     *pVideoEnc = NULL;
+
+        ret = Exynos_OMX_Check_SizeVersion(pLowLatency, sizeof(EXYNOS_OMX_VIDEO_PARAM_LOWLATENCY));
+        if (ret != OMX_ErrorNone) {
+            goto EXIT;
+        }
+        if (pLowLatency->nPortIndex != OUTPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+        pLowLatency->bEnable        = pVideoEnc->bLowLatency;
+        pLowLatency->nSliceMode     = pVideoEnc->nSliceMode;
+        pLowLatency->nSliceArgument = pVideoEnc->nSliceArgument;
     }
         break;
     default:
@@ -1292,6 +1316,7 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeSetParameter(
 
             pVideoEnc->eControlRate[portIndex] = videoRateControl->eControlRate;
             portDefinition->format.video.nBitrate = videoRateControl->nTargetBitrate;
+            Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_BIT_RATE);
         }
         ret = OMX_ErrorNone;
     }
@@ -1358,6 +1383,37 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeSetParameter(
         ret = OMX_ErrorNone;
     }
         break;
+    case OMX_IndexParamVideoLowLatency:
+    {
+        EXYNOS_OMX_VIDEO_PARAM_LOWLATENCY *pLowLatency = (EXYNOS_OMX_VIDEO_PARAM_LOWLATENCY *)ComponentParameterStructure;
+        EXYNOS_OMX_VIDEOENC_COMPONENT     *pVideoEnc = NULL;
+
+        ret = Exynos_OMX_Check_SizeVersion(pLowLatency, sizeof(EXYNOS_OMX_VIDEO_PARAM_LOWLATENCY));
+        if (ret != OMX_ErrorNone) {
+            goto EXIT;
+        }
+        if (pLowLatency->nPortIndex != OUTPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+        /* queue depth and slice layout are fixed once the codec buffers exist */
+        if ((pExynosComponent->currentState != OMX_StateLoaded) &&
+            (pExynosComponent->currentState != OMX_StateWaitForResources)) {
+            ret = OMX_ErrorIncorrectStateOperation;
+            goto EXIT;
+        }
+        if ((pLowLatency->nSliceMode != 0) && (pLowLatency->nSliceMode != 1) && (pLowLatency->nSliceMode != 3)) {
+            ret = OMX_ErrorBadParameter;
+            goto EXIT;
+        }
+
+        pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+        pVideoEnc->bLowLatency    = pLowLatency->bEnable;
+        pVideoEnc->nSliceMode     = pLowLatency->nSliceMode;
+        pVideoEnc->nSliceArgument = pLowLatency->nSliceArgument;
+        ret = OMX_ErrorNone;
+    }
+        break;
 #ifdef USE_STOREMETADATA
     case OMX_IndexParamStoreMetaDataBuffer:
     {
@@ -1439,6 +1495,29 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeGetConfig(
         }
     }
         break;
+    case OMX_IndexConfigVideoLatencyStats:
+    {
+        EXYNOS_OMX_VIDEO_CONFIG_LATENCYSTATS *pLatencyStats = (EXYNOS_OMX_VIDEO_CONFIG_LATENCYSTATS *)pComponentConfigStructure;
+        EXYNOS_OMX_VIDEOENC_COMPONENT        *pVideoEnc = NULL;
+
+        ret = Exynos_OMX_Check_SizeVersion(pLatencyStats, sizeof(EXYNOS_OMX_VIDEO_CONFIG_LATENCYSTATS));
+        if (ret != OMX_ErrorNone) {
+            goto EXIT;
+        }
+        if (pLatencyStats->nPortIndex != OUTPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+        Exynos_OSAL_MutexLock(pExynosComponent->compMutex);
+        pLatencyStats->nFrames    = pVideoEnc->latencyStats.nFrames;
+        pLatencyStats->nLastUs    = pVideoEnc->latencyStats.nLastUs;
+        pLatencyStats->nAverageUs = pVideoEnc->latencyStats.nAverageUs;
+        pLatencyStats->nMaxUs     = pVideoEnc->latencyStats.nMaxUs;
+        Exynos_OSAL_MutexUnlock(pExynosComponent->compMutex);
+    }
+        break;
     default:
         ret = Exynos_OMX_GetConfig(hComponent, nIndex, pComponentConfigStructure);
         break;
@@ -1493,6 +1572,7 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeSetConfig(
         } else {
             pExynosPort = &pExynosComponent->pExynosPort[portIndex];
             pExynosPort->portDefinition.format.video.nBitrate = pEncodeBitrate->nEncodeBitrate;
+            Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_BIT_RATE);
         }
     }
         break;
@@ -1508,6 +1588,7 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeSetConfig(
         } else {
             pExynosPort = &pExynosComponent->pExynosPort[portIndex];
             pExynosPort->portDefinition.format.video.xFramerate = pFramerate->xEncodeFramerate;
+            Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_FRAME_RATE);
         }
     }
         break;
@@ -1522,6 +1603,8 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeSetConfig(
             goto EXIT;
         } else {
             pVEncBase->IntraRefreshVOP = pIntraRefreshVOP->IntraRefreshVOP;
+            if (pVEncBase->IntraRefreshVOP == OMX_TRUE)
+                Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_FRAME_TYPE);
         }
     }
         break;
@@ -1572,6 +1655,15 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeGetExtensionIndex(
         goto EXIT;
     }
 
+    if (Exynos_OSAL_Strcmp(cParameterName, EXYNOS_INDEX_PARAM_VIDEO_LOWLATENCY) == 0) {
+        *pIndexType = (OMX_INDEXTYPE) OMX_IndexParamVideoLowLatency;
+        goto EXIT;
+    }
+    if (Exynos_OSAL_Strcmp(cParameterName, EXYNOS_INDEX_CONFIG_VIDEO_LATENCY_STATS) == 0) {
+        *pIndexType = (OMX_INDEXTYPE) OMX_IndexConfigVideoLatencyStats;
+        goto EXIT;
+    }
+
 #ifdef USE_STOREMETADATA
     if (Exynos_OSAL_Strcmp(cParameterName, EXYNOS_INDEX_PARAM_STORE_METADATA_BUFFER) == 0) {
         *pIndexType = (OMX_INDEXTYPE) OMX_IndexParamStoreMetaDataBuffer;
@@ -296,6 +296,16 @@ static void Set_H264Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
     pH264Param->StaticDisable   = 1;
     pH264Param->ActivityDisable = 1;
 
+    pVideoEnc->bSliceOutput = OMX_FALSE;
+    if (pVideoEnc->bLowLatency == OMX_TRUE) {
+        pCommonParam->SliceMode   = pVideoEnc->nSliceMode;
+        pH264Param->SliceArgument = pVideoEnc->nSliceArgument;
+        pH264Param->NumberBFrames = 0;
+        if ((pCommonParam->SliceMode != 0) &&
+            ((pExynosOutputPort->bufferProcessType & BUFFER_COPY) == BUFFER_COPY))
+            pVideoEnc->bSliceOutput = OMX_TRUE;
+    }
+
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "pVideoEnc->eControlRate[OUTPUT_PORT_INDEX]: 0x%x", pVideoEnc->eControlRate[OUTPUT_PORT_INDEX]);
     /* rate control related parameters */
     switch (pVideoEnc->eControlRate[OUTPUT_PORT_INDEX]) {
@@ -325,7 +335,6 @@ static void Set_H264Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
 
 static void Change_H264Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
 {
-    EXYNOS_OMX_BASEPORT           *pExynosInputPort  = NULL;
     EXYNOS_OMX_BASEPORT           *pExynosOutputPort = NULL;
     EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc         = NULL;
     EXYNOS_H264ENC_HANDLE         *pH264Enc          = NULL;
@@ -336,12 +345,11 @@ static void Change_H264Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
     ExynosVideoEncCommonParam *pCommonParam = NULL;
     ExynosVideoEncH264Param   *pH264Param   = NULL;
 
-    int setParam = 0;
+    ExynosVideoEncDynamicParam dynamicParam;
 
     pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
     pH264Enc = (EXYNOS_H264ENC_HANDLE *)((EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle)->hCodecHandle;
     pMFCH264Handle = &pH264Enc->hMFCH264Handle;
-    pExynosInputPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
     pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
     pEncOps = pMFCH264Handle->pEncOps;
 
@@ -349,25 +357,33 @@ static void Change_H264Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
     pCommonParam = &pEncParam->commonParam;
     pH264Param = &pEncParam->codecParam.h264;
 
-    if (pVideoEnc->IntraRefreshVOP == OMX_TRUE) {
-        setParam = VIDEO_FRAME_I;
-        pEncOps->Set_FrameType(pH264Enc->hMFCH264Handle.hMFCHandle, setParam);
+    Exynos_OSAL_Memset(&dynamicParam, 0, sizeof(dynamicParam));
+    dynamicParam.nDirtyMask = Exynos_Fetch_DynamicParamMask(pExynosComponent);
+    if (dynamicParam.nDirtyMask == 0)
+        return;
+
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_FRAME_TYPE) {
+        dynamicParam.FrameType = VIDEO_FRAME_I;
         pVideoEnc->IntraRefreshVOP = OMX_FALSE;
     }
-    if (pCommonParam->IDRPeriod != (int)pH264Enc->AVCComponent[OUTPUT_PORT_INDEX].nPFrames + 1) {
-        setParam = pH264Enc->AVCComponent[OUTPUT_PORT_INDEX].nPFrames + 1;
-        pEncOps->Set_IDRPeriod(pH264Enc->hMFCH264Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_IDR_PERIOD) {
+        pCommonParam->IDRPeriod = pH264Enc->AVCComponent[OUTPUT_PORT_INDEX].nPFrames + 1;
+        dynamicParam.IDRPeriod = pCommonParam->IDRPeriod;
     }
-    if (pCommonParam->Bitrate != (int)pExynosOutputPort->portDefinition.format.video.nBitrate) {
-        setParam = pExynosOutputPort->portDefinition.format.video.nBitrate;
-        pEncOps->Set_BitRate(pH264Enc->hMFCH264Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_BIT_RATE) {
+        pCommonParam->Bitrate = pExynosOutputPort->portDefinition.format.video.nBitrate;
+        dynamicParam.Bitrate = pCommonParam->Bitrate;
     }
-    if (pH264Param->FrameRate != (int)((pExynosOutputPort->portDefinition.format.video.xFramerate) >> 16)) {
-        setParam = (pExynosInputPort->portDefinition.format.video.xFramerate) >> 16;
-        pEncOps->Set_FrameRate(pH264Enc->hMFCH264Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_FRAME_RATE) {
+        pH264Param->FrameRate = (pExynosOutputPort->portDefinition.format.video.xFramerate) >> 16;
+        dynamicParam.FrameRate = pH264Param->FrameRate;
     }
 
-    Set_H264Enc_Param(pExynosComponent);
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "dynamic params 0x%x: IDRPeriod %d, Bitrate %d, FrameRate %d",
+                    dynamicParam.nDirtyMask, pCommonParam->IDRPeriod, pCommonParam->Bitrate, pH264Param->FrameRate);
+    if ((pEncOps->Set_DynamicParams == NULL) ||
+        (pEncOps->Set_DynamicParams(pMFCH264Handle->hMFCHandle, &dynamicParam) != VIDEO_ERROR_NONE))
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "%s: Failed - pEncOps->Set_DynamicParams", __FUNCTION__);
 }
 
 OMX_ERRORTYPE GetCodecInputPrivateData(OMX_PTR codecBuffer, OMX_PTR addr[], OMX_U32 size[])
@@ -704,7 +720,7 @@ OMX_ERRORTYPE H264CodecEnQueueAllBuffer(OMX_COMPONENTTYPE *pOMXComponent, OMX_U3
         (pH264Enc->bSourceStart == OMX_TRUE)) {
         Exynos_CodecBufferReset(pExynosComponent, INPUT_PORT_INDEX);
 
-        for (i = 0; i < MFC_INPUT_BUFFER_NUM_MAX; i++)  {
+        for (i = 0; i < Exynos_Get_InputCodecBufferNum(pVideoEnc); i++)  {
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "pVideoEnc->pMFCEncInputBuffer[%d]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]);
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[0]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[0]);
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[1]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[1]);
@@ -778,6 +794,8 @@ OMX_ERRORTYPE H264CodecSrcSetup(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DAT
         goto EXIT;
     }
 
+    /* the full parameter set covers whatever was changed before the first frame */
+    Exynos_Fetch_DynamicParamMask(pExynosComponent);
     Set_H264Enc_Param(pExynosComponent);
     pEncParam = &pMFCH264Handle->encParam;
     if (pEncOps->Set_EncParam) {
@@ -992,6 +1010,7 @@ OMX_ERRORTYPE H264CodecDstSetup(OMX_COMPONENTTYPE *pOMXComponent)
                             pVideoBuffer->planes[0].addr,
                             pVideoBuffer->planes[0].dataSize);
         Exynos_OSAL_Memcpy(OMXBuffer->pBuffer, pVideoBuffer->planes[0].addr, pVideoBuffer->planes[0].dataSize);
+        pVideoEnc->nOutputCopyBytes += pVideoBuffer->planes[0].dataSize;
         OMXBuffer->nFilledLen = pVideoBuffer->planes[0].dataSize;
         OMXBuffer->nOffset = 0;
         OMXBuffer->nTimeStamp = 0;
@@ -1219,6 +1238,8 @@ OMX_ERRORTYPE Exynos_H264Enc_SetParameter(
         pDstAVCComponent = &pH264Enc->AVCComponent[pSrcAVCComponent->nPortIndex];
 
         Exynos_OSAL_Memcpy(pDstAVCComponent, pSrcAVCComponent, sizeof(OMX_VIDEO_PARAM_AVCTYPE));
+        if (pSrcAVCComponent->nPortIndex == OUTPUT_PORT_INDEX)
+            Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_IDR_PERIOD);
     }
         break;
     case OMX_IndexParamStandardComponentRole:
@@ -1401,6 +1422,7 @@ OMX_ERRORTYPE Exynos_H264Enc_SetConfig(
         OMX_U32 nPFrames = (*((OMX_U32 *)pComponentConfigStructure)) - 1;
 
         pH264Enc->AVCComponent[OUTPUT_PORT_INDEX].nPFrames = nPFrames;
+        Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_IDR_PERIOD);
 
         ret = OMX_ErrorNone;
     }
@@ -1414,9 +1436,10 @@ OMX_ERRORTYPE Exynos_H264Enc_SetConfig(
             ret = OMX_ErrorBadPortIndex;
             goto EXIT;
         } else {
-            if (pAVCIntraPeriod->nIDRPeriod == (pAVCIntraPeriod->nPFrames + 1))
+            if (pAVCIntraPeriod->nIDRPeriod == (pAVCIntraPeriod->nPFrames + 1)) {
                 pH264Enc->AVCComponent[OUTPUT_PORT_INDEX].nPFrames = pAVCIntraPeriod->nPFrames;
-            else {
+                Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_IDR_PERIOD);
+            } else {
                 ret = OMX_ErrorBadParameter;
                 goto EXIT;
             }
@@ -1546,6 +1569,13 @@ OMX_ERRORTYPE Exynos_H264Enc_Init(OMX_COMPONENTTYPE *pOMXComponent)
         pExynosInputPort->bufferProcessType = BUFFER_COPY;
     }
 
+    if (Exynos_Check_OutputBufferShareable(pExynosComponent) == OMX_TRUE)
+        pExynosOutputPort->bufferProcessType = BUFFER_SHARE;
+    else
+        pExynosOutputPort->bufferProcessType = BUFFER_COPY;
+    pVideoEnc->nOutputCopyBytes = 0;
+    pVideoEnc->nOutputZeroCopyBytes = 0;
+
     /* H.264 Codec Open */
     ret = H264CodecOpen(pH264Enc);
     if (ret != OMX_ErrorNone) {
@@ -1592,7 +1622,8 @@ OMX_ERRORTYPE Exynos_H264Enc_Init(OMX_COMPONENTTYPE *pOMXComponent)
                 Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[0]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[0]);
                 Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[1]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[1]);
 
-                Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, pVideoEnc->pMFCEncInputBuffer[i]);
+                if (i < Exynos_Get_InputCodecBufferNum(pVideoEnc))
+                    Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, pVideoEnc->pMFCEncInputBuffer[i]);
             }
         } else if (pExynosInputPort->bufferProcessType == BUFFER_SHARE) {
             /*************/
@@ -1634,6 +1665,12 @@ OMX_ERRORTYPE Exynos_H264Enc_Init(OMX_COMPONENTTYPE *pOMXComponent)
     }
     pVideoEnc->csc_set_format = OMX_FALSE;
 
+    /* the scaler itself is only opened on the first conversion */
+    pVideoEnc->csc_hw_handle = NULL;
+    if ((pExynosInputPort->bStoreMetaData == OMX_TRUE) &&
+        (eColorFormat == OMX_COLOR_FormatAndroidOpaque))
+        pVideoEnc->csc_hw_handle = csc_init(CSC_METHOD_HW);
+
 EXIT:
     FunctionOut();
 
@@ -1663,6 +1700,13 @@ OMX_ERRORTYPE Exynos_H264Enc_Terminate(OMX_COMPONENTTYPE *pOMXComponent)
         csc_deinit(pVideoEnc->csc_handle);
         pVideoEnc->csc_handle = NULL;
     }
+    if (pVideoEnc->csc_hw_handle != NULL) {
+        csc_deinit(pVideoEnc->csc_hw_handle);
+        pVideoEnc->csc_hw_handle = NULL;
+    }
+
+    Exynos_OSAL_Log(EXYNOS_LOG_INFO, "output bytes copied: %llu, zero-copy: %llu",
+                    pVideoEnc->nOutputCopyBytes, pVideoEnc->nOutputZeroCopyBytes);
 
     Exynos_OSAL_SignalTerminate(pH264Enc->hDestinationStartEvent);
     pH264Enc->hDestinationStartEvent = NULL;
@@ -1738,8 +1782,12 @@ OMX_ERRORTYPE Exynos_H264Enc_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
 
     if (pH264Enc->hMFCH264Handle.bConfiguredMFCSrc == OMX_FALSE) {
         ret = H264CodecSrcSetup(pOMXComponent, pSrcInputData);
-        if ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)
+        if ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+            /* the EOS input is not queued to MFC */
+            if (ret == OMX_ErrorNone)
+                ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
             goto EXIT;
+        }
     }
     if (pH264Enc->hMFCH264Handle.bConfiguredMFCDst == OMX_FALSE) {
         ret = H264CodecDstSetup(pOMXComponent);
@@ -1755,6 +1803,8 @@ OMX_ERRORTYPE Exynos_H264Enc_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
         pExynosComponent->timeStamp[pH264Enc->hMFCH264Handle.indexTimestamp] = pSrcInputData->timeStamp;
         pExynosComponent->nFlags[pH264Enc->hMFCH264Handle.indexTimestamp] = pSrcInputData->nFlags;
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pH264Enc->hMFCH264Handle.indexTimestamp, pSrcInputData->nFlags);
+        Change_H264Enc_Param(pExynosComponent);
+        Exynos_Mark_InputTime(pExynosComponent, pH264Enc->hMFCH264Handle.indexTimestamp);
         pEncOps->Set_FrameTag(hMFCHandle, pH264Enc->hMFCH264Handle.indexTimestamp);
         pH264Enc->hMFCH264Handle.indexTimestamp++;
         pH264Enc->hMFCH264Handle.indexTimestamp %= MAX_TIMESTAMP;
@@ -1987,9 +2037,11 @@ OMX_ERRORTYPE Exynos_H264Enc_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
             pDstOutputData->timeStamp = pExynosComponent->timeStamp[pH264Enc->hMFCH264Handle.outputIndexTimestamp];
             pDstOutputData->nFlags = pExynosComponent->nFlags[pH264Enc->hMFCH264Handle.outputIndexTimestamp];
+            Exynos_Update_OutputLatency(pExynosComponent, pH264Enc->hMFCH264Handle.outputIndexTimestamp);
         } else {
             pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
             pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
+            Exynos_Update_OutputLatency(pExynosComponent, indexTimestamp);
         }
 
         pDstOutputData->nFlags |= OMX_BUFFERFLAG_ENDOFFRAME;
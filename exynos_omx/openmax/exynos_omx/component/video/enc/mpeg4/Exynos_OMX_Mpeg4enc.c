@@ -277,6 +277,13 @@ static void Set_Mpeg4Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
     pMpeg4Param->NumberBFrames = 0; /* 0(not used) ~ 2 */
     pMpeg4Param->DisableQpelME = 1;
 
+    /* video packets are not split into output buffers, resync markers are not start codes */
+    if (pVideoEnc->bLowLatency == OMX_TRUE) {
+        pCommonParam->SliceMode    = pVideoEnc->nSliceMode;
+        pMpeg4Param->SliceArgument = pVideoEnc->nSliceArgument;
+        pMpeg4Param->NumberBFrames = 0;
+    }
+
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "pVideoEnc->eControlRate[OUTPUT_PORT_INDEX]: 0x%x", pVideoEnc->eControlRate[OUTPUT_PORT_INDEX]);
     /* rate control related parameters */
     switch (pVideoEnc->eControlRate[OUTPUT_PORT_INDEX]) {
@@ -400,7 +407,6 @@ static void Set_H263Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
 
 static void Change_Mpeg4Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
 {
-    EXYNOS_OMX_BASEPORT           *pExynosInputPort  = NULL;
     EXYNOS_OMX_BASEPORT           *pExynosOutputPort = NULL;
     EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc         = NULL;
     EXYNOS_MPEG4ENC_HANDLE        *pMpeg4Enc         = NULL;
@@ -411,12 +417,11 @@ static void Change_Mpeg4Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
     ExynosVideoEncCommonParam *pCommonParam = NULL;
     ExynosVideoEncMpeg4Param  *pMpeg4Param  = NULL;
 
-    int setParam = 0;
+    ExynosVideoEncDynamicParam dynamicParam;
 
     pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
     pMpeg4Enc = pVideoEnc->hCodecHandle;
     pMFCMpeg4Handle    = &pMpeg4Enc->hMFCMpeg4Handle;
-    pExynosInputPort  = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
     pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
     pEncOps = pMFCMpeg4Handle->pEncOps;
 
@@ -424,30 +429,35 @@ static void Change_Mpeg4Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
     pCommonParam = &pEncParam->commonParam;
     pMpeg4Param  = &pEncParam->codecParam.mpeg4;
 
-    if (pVideoEnc->IntraRefreshVOP == OMX_TRUE) {
-        setParam = VIDEO_FRAME_I;
-        pEncOps->Set_FrameType(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle, setParam);
+    Exynos_OSAL_Memset(&dynamicParam, 0, sizeof(dynamicParam));
+    dynamicParam.nDirtyMask = Exynos_Fetch_DynamicParamMask(pExynosComponent);
+    if (dynamicParam.nDirtyMask == 0)
+        return;
+
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_FRAME_TYPE) {
+        dynamicParam.FrameType = VIDEO_FRAME_I;
         pVideoEnc->IntraRefreshVOP = OMX_FALSE;
     }
-    if (pCommonParam->IDRPeriod != (int)pMpeg4Enc->mpeg4Component[OUTPUT_PORT_INDEX].nPFrames + 1) {
-        setParam = pMpeg4Enc->mpeg4Component[OUTPUT_PORT_INDEX].nPFrames + 1;
-        pEncOps->Set_IDRPeriod(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_IDR_PERIOD) {
+        pCommonParam->IDRPeriod = pMpeg4Enc->mpeg4Component[OUTPUT_PORT_INDEX].nPFrames + 1;
+        dynamicParam.IDRPeriod = pCommonParam->IDRPeriod;
     }
-    if (pCommonParam->Bitrate != (int)pExynosOutputPort->portDefinition.format.video.nBitrate) {
-        setParam = pExynosOutputPort->portDefinition.format.video.nBitrate;
-        pEncOps->Set_BitRate(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_BIT_RATE) {
+        pCommonParam->Bitrate = pExynosOutputPort->portDefinition.format.video.nBitrate;
+        dynamicParam.Bitrate = pCommonParam->Bitrate;
     }
-    if (pMpeg4Param->TimeIncreamentRes != (int)((pExynosOutputPort->portDefinition.format.video.xFramerate) >> 16)) {
-        setParam = (pExynosInputPort->portDefinition.format.video.xFramerate) >> 16;
-        pEncOps->Set_FrameRate(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_FRAME_RATE) {
+        pMpeg4Param->TimeIncreamentRes = (pExynosOutputPort->portDefinition.format.video.xFramerate) >> 16;
+        dynamicParam.FrameRate = pMpeg4Param->TimeIncreamentRes;
     }
 
-    Set_Mpeg4Enc_Param(pExynosComponent);
+    if ((pEncOps->Set_DynamicParams == NULL) ||
+        (pEncOps->Set_DynamicParams(pMFCMpeg4Handle->hMFCHandle, &dynamicParam) != VIDEO_ERROR_NONE))
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "%s: Failed - pEncOps->Set_DynamicParams", __FUNCTION__);
 }
 
 static void Change_H263Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
 {
-    EXYNOS_OMX_BASEPORT           *pExynosInputPort  = NULL;
     EXYNOS_OMX_BASEPORT           *pExynosOutputPort = NULL;
     EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc         = NULL;
     EXYNOS_MPEG4ENC_HANDLE        *pMpeg4Enc         = NULL;
@@ -458,12 +468,11 @@ static void Change_H263Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
     ExynosVideoEncCommonParam *pCommonParam = NULL;
     ExynosVideoEncH263Param   *pH263Param   = NULL;
 
-    int setParam = 0;
+    ExynosVideoEncDynamicParam dynamicParam;
 
     pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
     pMpeg4Enc = pVideoEnc->hCodecHandle;
     pMFCMpeg4Handle    = &pMpeg4Enc->hMFCMpeg4Handle;
-    pExynosInputPort  = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
     pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
     pEncOps = pMFCMpeg4Handle->pEncOps;
 
@@ -471,25 +480,31 @@ static void Change_H263Enc_Param(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
     pCommonParam = &pEncParam->commonParam;
     pH263Param   = &pEncParam->codecParam.h263;
 
-    if (pVideoEnc->IntraRefreshVOP == OMX_TRUE) {
-        setParam = VIDEO_FRAME_I;
-        pEncOps->Set_FrameType(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle, setParam);
+    Exynos_OSAL_Memset(&dynamicParam, 0, sizeof(dynamicParam));
+    dynamicParam.nDirtyMask = Exynos_Fetch_DynamicParamMask(pExynosComponent);
+    if (dynamicParam.nDirtyMask == 0)
+        return;
+
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_FRAME_TYPE) {
+        dynamicParam.FrameType = VIDEO_FRAME_I;
         pVideoEnc->IntraRefreshVOP = OMX_FALSE;
     }
-    if (pCommonParam->IDRPeriod != (int)pMpeg4Enc->h263Component[OUTPUT_PORT_INDEX].nPFrames + 1) {
-        setParam = pMpeg4Enc->h263Component[OUTPUT_PORT_INDEX].nPFrames + 1;
-        pEncOps->Set_IDRPeriod(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_IDR_PERIOD) {
+        pCommonParam->IDRPeriod = pMpeg4Enc->h263Component[OUTPUT_PORT_INDEX].nPFrames + 1;
+        dynamicParam.IDRPeriod = pCommonParam->IDRPeriod;
     }
-    if (pCommonParam->Bitrate != (int)pExynosOutputPort->portDefinition.format.video.nBitrate) {
-        setParam = pExynosOutputPort->portDefinition.format.video.nBitrate;
-        pEncOps->Set_BitRate(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_BIT_RATE) {
+        pCommonParam->Bitrate = pExynosOutputPort->portDefinition.format.video.nBitrate;
+        dynamicParam.Bitrate = pCommonParam->Bitrate;
     }
-    if (pH263Param->FrameRate != (int)((pExynosOutputPort->portDefinition.format.video.xFramerate) >> 16)) {
-        setParam = (pExynosInputPort->portDefinition.format.video.xFramerate) >> 16;
-        pEncOps->Set_FrameRate(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle, setParam);
+    if (dynamicParam.nDirtyMask & VIDEO_ENC_DYNAMIC_FRAME_RATE) {
+        pH263Param->FrameRate = (pExynosOutputPort->portDefinition.format.video.xFramerate) >> 16;
+        dynamicParam.FrameRate = pH263Param->FrameRate;
     }
 
-    Set_H263Enc_Param(pExynosComponent);
+    if ((pEncOps->Set_DynamicParams == NULL) ||
+        (pEncOps->Set_DynamicParams(pMFCMpeg4Handle->hMFCHandle, &dynamicParam) != VIDEO_ERROR_NONE))
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "%s: Failed - pEncOps->Set_DynamicParams", __FUNCTION__);
 }
 
 OMX_ERRORTYPE GetCodecInputPrivateData(OMX_PTR codecBuffer, OMX_PTR addr[], OMX_U32 size[])
@@ -826,7 +841,7 @@ OMX_ERRORTYPE Mpeg4CodecEnQueueAllBuffer(OMX_COMPONENTTYPE *pOMXComponent, OMX_U
         (pMpeg4Enc->bSourceStart == OMX_TRUE)) {
         Exynos_CodecBufferReset(pExynosComponent, INPUT_PORT_INDEX);
 
-        for (i = 0; i < MFC_INPUT_BUFFER_NUM_MAX; i++)  {
+        for (i = 0; i < Exynos_Get_InputCodecBufferNum(pVideoEnc); i++)  {
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "pVideoEnc->pMFCEncInputBuffer[%d]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]);
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[0]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[0]);
             Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[1]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[1]);
@@ -900,6 +915,8 @@ OMX_ERRORTYPE Mpeg4CodecSrcSetup(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DA
         goto EXIT;
     }
 
+    /* the full parameter set covers whatever was changed before the first frame */
+    Exynos_Fetch_DynamicParamMask(pExynosComponent);
     if (pMpeg4Enc->hMFCMpeg4Handle.codecType == CODEC_TYPE_MPEG4)
         Set_Mpeg4Enc_Param(pExynosComponent);
     else
@@ -1127,6 +1144,7 @@ OMX_ERRORTYPE Mpeg4CodecDstSetup(OMX_COMPONENTTYPE *pOMXComponent)
                             pVideoBuffer->planes[0].addr,
                             pVideoBuffer->planes[0].dataSize);
         Exynos_OSAL_Memcpy(OMXBuffer->pBuffer, pVideoBuffer->planes[0].addr, pVideoBuffer->planes[0].dataSize);
+        pVideoEnc->nOutputCopyBytes += pVideoBuffer->planes[0].dataSize;
         OMXBuffer->nFilledLen = pVideoBuffer->planes[0].dataSize;
         OMXBuffer->nOffset = 0;
         OMXBuffer->nTimeStamp = 0;
@@ -1396,6 +1414,8 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_SetParameter(
         pDstMpeg4Component = &pMpeg4Enc->mpeg4Component[pSrcMpeg4Component->nPortIndex];
 
         Exynos_OSAL_Memcpy(pDstMpeg4Component, pSrcMpeg4Component, sizeof(OMX_VIDEO_PARAM_MPEG4TYPE));
+        if (pSrcMpeg4Component->nPortIndex == OUTPUT_PORT_INDEX)
+            Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_IDR_PERIOD);
     }
         break;
     case OMX_IndexParamVideoH263:
@@ -1418,6 +1438,8 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_SetParameter(
         pDstH263Component = &pMpeg4Enc->h263Component[pSrcH263Component->nPortIndex];
 
         Exynos_OSAL_Memcpy(pDstH263Component, pSrcH263Component, sizeof(OMX_VIDEO_PARAM_H263TYPE));
+        if (pSrcH263Component->nPortIndex == OUTPUT_PORT_INDEX)
+            Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_IDR_PERIOD);
     }
         break;
     case OMX_IndexParamStandardComponentRole:
@@ -1606,6 +1628,7 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_SetConfig(
             pMpeg4Enc->mpeg4Component[OUTPUT_PORT_INDEX].nPFrames = nPFrames;
         else
             pMpeg4Enc->h263Component[OUTPUT_PORT_INDEX].nPFrames = nPFrames;
+        Exynos_Set_DynamicParamMask(pExynosComponent, VIDEO_ENC_DYNAMIC_IDR_PERIOD);
 
         ret = OMX_ErrorNone;
     }
@@ -1756,6 +1779,13 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_Init(OMX_COMPONENTTYPE *pOMXComponent)
         pExynosInputPort->bufferProcessType = BUFFER_COPY;
     }
 
+    if (Exynos_Check_OutputBufferShareable(pExynosComponent) == OMX_TRUE)
+        pExynosOutputPort->bufferProcessType = BUFFER_SHARE;
+    else
+        pExynosOutputPort->bufferProcessType = BUFFER_COPY;
+    pVideoEnc->nOutputCopyBytes = 0;
+    pVideoEnc->nOutputZeroCopyBytes = 0;
+
     /* Mpeg4/H.263 Codec Open */
     ret = Mpeg4CodecOpen(pMpeg4Enc);
     if (ret != OMX_ErrorNone) {
@@ -1802,7 +1832,8 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_Init(OMX_COMPONENTTYPE *pOMXComponent)
                 Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[0]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[0]);
                 Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "pVideoEnc->pMFCEncInputBuffer[%d]->pVirAddr[1]: 0x%x", i, pVideoEnc->pMFCEncInputBuffer[i]->pVirAddr[1]);
 
-                Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, pVideoEnc->pMFCEncInputBuffer[i]);
+                if (i < Exynos_Get_InputCodecBufferNum(pVideoEnc))
+                    Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, pVideoEnc->pMFCEncInputBuffer[i]);
             }
         } else if (pExynosInputPort->bufferProcessType == BUFFER_SHARE) {
             /*************/
@@ -1844,6 +1875,12 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_Init(OMX_COMPONENTTYPE *pOMXComponent)
     }
     pVideoEnc->csc_set_format = OMX_FALSE;
 
+    /* the scaler itself is only opened on the first conversion */
+    pVideoEnc->csc_hw_handle = NULL;
+    if ((pExynosInputPort->bStoreMetaData == OMX_TRUE) &&
+        (eColorFormat == OMX_COLOR_FormatAndroidOpaque))
+        pVideoEnc->csc_hw_handle = csc_init(CSC_METHOD_HW);
+
 EXIT:
     FunctionOut();
 
@@ -1873,6 +1910,13 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_Terminate(OMX_COMPONENTTYPE *pOMXComponent)
         csc_deinit(pVideoEnc->csc_handle);
         pVideoEnc->csc_handle = NULL;
     }
+    if (pVideoEnc->csc_hw_handle != NULL) {
+        csc_deinit(pVideoEnc->csc_hw_handle);
+        pVideoEnc->csc_hw_handle = NULL;
+    }
+
+    Exynos_OSAL_Log(EXYNOS_LOG_INFO, "output bytes copied: %llu, zero-copy: %llu",
+                    pVideoEnc->nOutputCopyBytes, pVideoEnc->nOutputZeroCopyBytes);
 
     Exynos_OSAL_SignalTerminate(pMpeg4Enc->hDestinationStartEvent);
     pMpeg4Enc->hDestinationStartEvent = NULL;
@@ -1948,8 +1992,12 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
 
     if (pMpeg4Enc->hMFCMpeg4Handle.bConfiguredMFCSrc == OMX_FALSE) {
         ret = Mpeg4CodecSrcSetup(pOMXComponent, pSrcInputData);
-        if ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)
+        if ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+            /* the EOS input is not queued to MFC */
+            if (ret == OMX_ErrorNone)
+                ret = (OMX_ERRORTYPE)OMX_ErrorNoneReuseBuffer;
             goto EXIT;
+        }
     }
     if (pMpeg4Enc->hMFCMpeg4Handle.bConfiguredMFCDst == OMX_FALSE) {
         ret = Mpeg4CodecDstSetup(pOMXComponent);
@@ -1965,6 +2013,11 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         pExynosComponent->timeStamp[pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp] = pSrcInputData->timeStamp;
         pExynosComponent->nFlags[pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp] = pSrcInputData->nFlags;
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp, pSrcInputData->nFlags);
+        if (pMpeg4Enc->hMFCMpeg4Handle.codecType == CODEC_TYPE_MPEG4)
+            Change_Mpeg4Enc_Param(pExynosComponent);
+        else
+            Change_H263Enc_Param(pExynosComponent);
+        Exynos_Mark_InputTime(pExynosComponent, pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp);
         pEncOps->Set_FrameTag(hMFCHandle, pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp);
         pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp++;
         pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp %= MAX_TIMESTAMP;
@@ -2181,9 +2234,11 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
         if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
             pDstOutputData->timeStamp = pExynosComponent->timeStamp[pMpeg4Enc->hMFCMpeg4Handle.outputIndexTimestamp];
             pDstOutputData->nFlags = pExynosComponent->nFlags[pMpeg4Enc->hMFCMpeg4Handle.outputIndexTimestamp];
+            Exynos_Update_OutputLatency(pExynosComponent, pMpeg4Enc->hMFCMpeg4Handle.outputIndexTimestamp);
         } else {
             pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
             pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
+            Exynos_Update_OutputLatency(pExynosComponent, indexTimestamp);
         }
 
         pDstOutputData->nFlags |= OMX_BUFFERFLAG_ENDOFFRAME;
@@ -72,6 +72,12 @@ typedef enum _EXYNOS_OMX_INDEXTYPE
     OMX_IndexVendorThumbnailMode            = 0x7F000001,
 #define EXYNOS_INDEX_CONFIG_VIDEO_INTRAPERIOD "OMX.SEC.index.VideoIntraPeriod"
     OMX_IndexConfigVideoIntraPeriod         = 0x7F000002,
+#define EXYNOS_INDEX_PARAM_VIDEO_LOWLATENCY "OMX.SEC.index.VideoLowLatency"
+    OMX_IndexParamVideoLowLatency           = 0x7F000003,
+#define EXYNOS_INDEX_CONFIG_VIDEO_LATENCY_STATS "OMX.SEC.index.VideoLatencyStats"
+    OMX_IndexConfigVideoLatencyStats        = 0x7F000004,
+#define EXYNOS_INDEX_CONFIG_VIDEO_SEEK_TARGET "OMX.SEC.index.VideoSeekTarget"
+    OMX_IndexConfigVideoSeekTarget          = 0x7F000005,
 
     /* for Android Native Window */
 #define EXYNOS_INDEX_PARAM_ENABLE_ANB "OMX.google.android.index.enableAndroidNativeBuffers"
@@ -97,7 +103,8 @@ typedef enum _EXYNOS_OMX_ERRORTYPE
     OMX_ErrorCodecDecode        = (OMX_S32) 0x90000005,
     OMX_ErrorCodecEncode        = (OMX_S32) 0x90000006,
     OMX_ErrorCodecFlush         = (OMX_S32) 0x90000007,
-    OMX_ErrorOutputBufferUseYet = (OMX_S32) 0x90000008
+    OMX_ErrorOutputBufferUseYet = (OMX_S32) 0x90000008,
+    OMX_ErrorNoneReuseBuffer    = (OMX_S32) 0x90000009   /* input consumed without queueing it to the codec */
 } EXYNOS_OMX_ERRORTYPE;
 
 typedef enum _EXYNOS_OMX_COMMANDTYPE
@@ -158,6 +165,39 @@ typedef struct _EXYNOS_OMX_VIDEO_PROFILELEVEL
     OMX_S32  level;
 } EXYNOS_OMX_VIDEO_PROFILELEVEL;
 
+/* OMX_IndexParamVideoLowLatency, set on the output port in the loaded state */
+typedef struct _EXYNOS_OMX_VIDEO_PARAM_LOWLATENCY
+{
+    OMX_U32         nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32         nPortIndex;
+    OMX_BOOL        bEnable;
+    OMX_U32         nSliceMode;         /* 0: one slice, 1: fixed #mb, 3: fixed #bytes */
+    OMX_U32         nSliceArgument;     /* #mb or #bytes per slice */
+} EXYNOS_OMX_VIDEO_PARAM_LOWLATENCY;
+
+/* OMX_IndexConfigVideoLatencyStats, time from queueing a frame to the codec until its bitstream is dequeued */
+typedef struct _EXYNOS_OMX_VIDEO_CONFIG_LATENCYSTATS
+{
+    OMX_U32         nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32         nPortIndex;
+    OMX_U32         nFrames;
+    OMX_U32         nLastUs;
+    OMX_U32         nAverageUs;
+    OMX_U32         nMaxUs;
+} EXYNOS_OMX_VIDEO_CONFIG_LATENCYSTATS;
+
+/* OMX_IndexConfigVideoSeekTarget, frames before nTargetTime are decoded only as far as needed and not output */
+typedef struct _EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET
+{
+    OMX_U32         nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32         nPortIndex;
+    OMX_BOOL        bEnable;
+    OMX_TICKS       nTargetTime;
+} EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET;
+
 #define OMX_VIDEO_CodingVPX     0x09    /**< Google VPX, formerly known as On2 VP8 */
 
 #ifndef __OMX_EXPORTS
@@ -140,6 +140,48 @@ EXIT:
     return ret;
 }
 
+/* fds, hal format and stride of a gralloc handle, without mapping it for the cpu */
+OMX_ERRORTYPE Exynos_OSAL_GetANBHandlePlanes(
+    OMX_IN OMX_U32 handle,
+    OMX_OUT OMX_PTR planes,
+    OMX_OUT OMX_U32 *pHalFormat,
+    OMX_OUT OMX_U32 *pStride)
+{
+    FunctionIn();
+
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+    private_handle_t *priv_hnd = (private_handle_t *) handle;
+    ExynosVideoPlane *vplanes = (ExynosVideoPlane *) planes;
+
+    if (priv_hnd == NULL) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+
+    vplanes[0].fd = priv_hnd->fd;
+    vplanes[0].offset = 0;
+    vplanes[0].addr = NULL;
+    vplanes[1].fd = priv_hnd->fd1;
+    vplanes[1].offset = 0;
+    vplanes[1].addr = NULL;
+    vplanes[2].fd = priv_hnd->fd2;
+    vplanes[2].offset = 0;
+    vplanes[2].addr = NULL;
+
+    if (pHalFormat != NULL)
+        *pHalFormat = priv_hnd->format;
+    if (pStride != NULL)
+        *pStride = priv_hnd->stride;
+
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "%s: handle: 0x%x, fd: %d, format: 0x%x",
+                    __func__, handle, priv_hnd->fd, priv_hnd->format);
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
+
 OMX_COLOR_FORMATTYPE Exynos_OSAL_GetANBColorFormat(OMX_IN OMX_U32 handle)
 {
     FunctionIn();
@@ -62,6 +62,11 @@ OMX_ERRORTYPE Exynos_OSAL_LockANBHandle(OMX_IN OMX_U32 pBuffer,
 
 OMX_ERRORTYPE Exynos_OSAL_UnlockANBHandle(OMX_IN OMX_U32 pBuffer);
 
+OMX_ERRORTYPE Exynos_OSAL_GetANBHandlePlanes(OMX_IN OMX_U32 handle,
+                                             OMX_OUT OMX_PTR planes,
+                                             OMX_OUT OMX_U32 *pHalFormat,
+                                             OMX_OUT OMX_U32 *pStride);
+
 OMX_ERRORTYPE Exynos_OSAL_GetInfoFromMetaData(OMX_IN OMX_BYTE pBuffer,
                                               OMX_OUT OMX_PTR *pOutBuffer);
 
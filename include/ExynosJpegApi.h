@@ -116,13 +116,21 @@ protected:
     bool t_bFlagCreateInBuf;
     bool t_bFlagCreateOutBuf;
     bool t_bFlagExcute;
+    bool t_bFlagStreamOn;
+    bool t_bFlagConfigApplied;
 
     int t_iPlaneNum;
 
+    int t_iInBufCnt;
+    int t_iOutBufCnt;
+    int t_iInBufIdx;
+    int t_iOutBufIdx;
+
     int t_iJpegFd;
     struct CONFIG t_stJpegConfig;
     struct BUFFER t_stJpegInbuf;
     struct BUFFER t_stJpegOutbuf;
+    struct CONFIG t_stJpegConfigApplied;
 
     //functions
     int t_v4l2Querycap(int iFd);
@@ -130,12 +138,14 @@ protected:
     int t_v4l2SetFmt(int iFd, enum v4l2_buf_type eType, struct CONFIG *pstConfig);
     int t_v4l2GetFmt(int iFd, enum v4l2_buf_type eType, struct CONFIG *pstConfig);
     int t_v4l2Reqbufs(int iFd, int iBufCount, struct BUF_INFO *pstBufInfo);
-    int t_v4l2Qbuf(int iFd, struct BUF_INFO *pstBufInfo, struct BUFFER *pstBuf);
+    int t_v4l2Qbuf(int iFd, struct BUF_INFO *pstBufInfo, struct BUFFER *pstBuf, int iIndex);
     int t_v4l2Dqbuf(int iFd, enum v4l2_buf_type eType, enum v4l2_memory eMemory, int iNumPlanes);
     int t_v4l2StreamOn(int iFd, enum v4l2_buf_type eType);
     int t_v4l2StreamOff(int iFd, enum v4l2_buf_type eType);
     int t_v4l2SetCtrl(int iFd, int iCid, int iValue);
     int t_v4l2GetCtrl(int iFd, int iCid);
+    bool t_isConfigChanged(int iInBufs, int iOutBufs, int iInBufPlanes, int iOutBufPlanes);
+    int t_releaseStream(void);
 
     int create(enum MODE eMode);
     int destroy(int iInBufs, int iOutBufs);
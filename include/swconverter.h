@@ -53,6 +53,10 @@
 #ifndef SW_CONVERTOR_H_
 #define SW_CONVERTOR_H_
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /*--------------------------------------------------------------------------------*/
 /* Format Conversion API                                                          */
 /*--------------------------------------------------------------------------------*/
@@ -511,4 +515,149 @@ void csc_ARGB8888_to_YUV420SP_NEON(
     unsigned int width,
     unsigned int height);
 
+/*
+ * Scales down YUYV by averaging the source area of every destination pixel.
+ *
+ * @param dst
+ *   Address of scaled YUYV[out]
+ *
+ * @param dst_width
+ *   Width of scaled YUYV, must be even[in]
+ *
+ * @param dst_height
+ *   Height of scaled YUYV[in]
+ *
+ * @param src
+ *   Address of YUYV[in]
+ *
+ * @param src_width
+ *   Width of YUYV[in]
+ *
+ * @param src_height
+ *   Height of YUYV[in]
+ *
+ * @return
+ *   0 on success, -1 if the sizes are not a supported down scale or
+ *   memory runs out
+ */
+int csc_scale_down_YUYV(
+    unsigned char *dst,
+    unsigned int dst_width,
+    unsigned int dst_height,
+    unsigned char *src,
+    unsigned int src_width,
+    unsigned int src_height);
+
+/*
+ * Scales down YUV422SP(NV16/NV61) by averaging the source area of every
+ * destination pixel.
+ *
+ * @param y_dst
+ *   Y plane address of scaled YUV422SP[out]
+ *
+ * @param uv_dst
+ *   UV plane address of scaled YUV422SP[out]
+ *
+ * @param dst_width
+ *   Width of scaled YUV422SP, must be even[in]
+ *
+ * @param dst_height
+ *   Height of scaled YUV422SP[in]
+ *
+ * @param y_src
+ *   Y plane address of YUV422SP[in]
+ *
+ * @param uv_src
+ *   UV plane address of YUV422SP[in]
+ *
+ * @param src_width
+ *   Width of YUV422SP[in]
+ *
+ * @param src_height
+ *   Height of YUV422SP[in]
+ *
+ * @return
+ *   0 on success, -1 if the sizes are not a supported down scale or
+ *   memory runs out
+ */
+int csc_scale_down_YUV422SP(
+    unsigned char *y_dst,
+    unsigned char *uv_dst,
+    unsigned int dst_width,
+    unsigned int dst_height,
+    unsigned char *y_src,
+    unsigned char *uv_src,
+    unsigned int src_width,
+    unsigned int src_height);
+
+/*
+ * Converts YUYV to YUV420SP(NV21). Chroma of every two rows is averaged
+ *
+ * @param y_dst
+ *   Y plane address of YUV420SP[out]
+ *
+ * @param vu_dst
+ *   VU plane address of YUV420SP[out]
+ *
+ * @param src
+ *   Address of YUYV[in]
+ *
+ * @param width
+ *   Width of YUYV, must be even[in]
+ *
+ * @param height
+ *   Height of YUYV[in]
+ *
+ * @return
+ *   0 on success, -1 on a bad size
+ */
+int csc_YUYV_to_YUV420SP_NV21(
+    unsigned char *y_dst,
+    unsigned char *vu_dst,
+    unsigned char *src,
+    unsigned int width,
+    unsigned int height);
+
+/*
+ * Scales down YUYV and converts it to YUV420SP(NV21) in one pass, without
+ * an intermediate YUYV image
+ *
+ * @param y_dst
+ *   Y plane address of scaled YUV420SP[out]
+ *
+ * @param vu_dst
+ *   VU plane address of scaled YUV420SP[out]
+ *
+ * @param dst_width
+ *   Width of scaled YUV420SP, must be even[in]
+ *
+ * @param dst_height
+ *   Height of scaled YUV420SP, must be even[in]
+ *
+ * @param src
+ *   Address of YUYV[in]
+ *
+ * @param src_width
+ *   Width of YUYV[in]
+ *
+ * @param src_height
+ *   Height of YUYV[in]
+ *
+ * @return
+ *   0 on success, -1 if the sizes are not a supported down scale or
+ *   memory runs out
+ */
+int csc_scale_down_YUYV_to_YUV420SP_NV21(
+    unsigned char *y_dst,
+    unsigned char *vu_dst,
+    unsigned int dst_width,
+    unsigned int dst_height,
+    unsigned char *src,
+    unsigned int src_width,
+    unsigned int src_height);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /*COLOR_SPACE_CONVERTOR_H_*/
@@ -43,6 +43,7 @@
 
 #include "ExynosCameraHWInterface.h"
 #include "exynos_format.h"
+#include "swconverter.h"
 
 #define VIDEO_COMMENT_MARKER_H          (0xFFBE)
 #define VIDEO_COMMENT_MARKER_L          (0xFFBF)
@@ -153,6 +154,11 @@ ExynosCameraHWInterface::ExynosCameraHWInterface(int cameraId, camera_device_t *
 
     m_recordingHint = false;
 
+    m_calPreviewW = 0;
+    m_calPreviewH = 0;
+    for (int i = 0; i < PARAM_MAX; i++)
+        m_invalidateParam(i);
+
     if (!m_grallocHal) {
         ret = hw_get_module(GRALLOC_HARDWARE_MODULE_ID, (const hw_module_t **)&m_grallocHal);
         if (ret)
@@ -589,6 +595,85 @@ status_t ExynosCameraHWInterface::cancelPicture()
     return NO_ERROR;
 }
 
+const ExynosCameraHWInterface::param_entry_t ExynosCameraHWInterface::m_paramTable[PARAM_MAX] = {
+    { { CameraParameters::KEY_PICTURE_SIZE, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamPictureSize },
+    { { CameraParameters::KEY_PICTURE_FORMAT, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamPictureFormat },
+    { { CameraParameters::KEY_JPEG_QUALITY, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamJpegQuality },
+    { { CameraParameters::KEY_JPEG_THUMBNAIL_WIDTH, CameraParameters::KEY_JPEG_THUMBNAIL_HEIGHT, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamJpegThumbnailSize },
+    { { CameraParameters::KEY_JPEG_THUMBNAIL_QUALITY, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamJpegThumbnailQuality },
+    { { CameraParameters::KEY_VIDEO_SIZE, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamVideoSize },
+    { { CameraParameters::KEY_VIDEO_STABILIZATION, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamVideoStabilization },
+    { { "3dnr", NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParam3dnr },
+    { { "odc", NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamOdc },
+    { { CameraParameters::KEY_PREVIEW_FRAME_RATE, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamFrameRate },
+    { { CameraParameters::KEY_ZOOM, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamZoom },
+    { { CameraParameters::KEY_ROTATION, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamRotation },
+    { { CameraParameters::KEY_AUTO_EXPOSURE_LOCK, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamAutoExposureLock },
+    { { CameraParameters::KEY_EXPOSURE_COMPENSATION, CameraParameters::KEY_MIN_EXPOSURE_COMPENSATION, CameraParameters::KEY_MAX_EXPOSURE_COMPENSATION }, false,
+      &ExynosCameraHWInterface::m_setParamExposureCompensation },
+    { { CameraParameters::KEY_AUTO_WHITEBALANCE_LOCK, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamAutoWhiteBalanceLock },
+    { { CameraParameters::KEY_WHITE_BALANCE, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamWhiteBalance },
+    { { "metering", NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamMetering },
+    { { CameraParameters::KEY_METERING_AREAS, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamMeteringAreas },
+    { { CameraParameters::KEY_ANTIBANDING, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamAntibanding },
+    { { CameraParameters::KEY_SCENE_MODE, CameraParameters::KEY_FLASH_MODE, CameraParameters::KEY_FOCUS_MODE }, false,
+      &ExynosCameraHWInterface::m_setParamSceneMode },
+    { { CameraParameters::KEY_FOCUS_AREAS, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamFocusAreas },
+    { { CameraParameters::KEY_EFFECT, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamEffect },
+    { { CameraParameters::KEY_GPS_ALTITUDE, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamGpsAltitude },
+    { { CameraParameters::KEY_GPS_LATITUDE, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamGpsLatitude },
+    { { CameraParameters::KEY_GPS_LONGITUDE, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamGpsLongitude },
+    { { CameraParameters::KEY_GPS_PROCESSING_METHOD, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamGpsProcessingMethod },
+    { { CameraParameters::KEY_GPS_TIMESTAMP, NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamGpsTimestamp },
+    { { "brightness", "brightness-max", "brightness-min" }, false,
+      &ExynosCameraHWInterface::m_setParamBrightness },
+    { { "saturation", "saturation-max", "saturation-min" }, false,
+      &ExynosCameraHWInterface::m_setParamSaturation },
+    { { "sharpness", "sharpness-max", "sharpness-min" }, false,
+      &ExynosCameraHWInterface::m_setParamSharpness },
+    { { "hue", "hue-max", "hue-min" }, false,
+      &ExynosCameraHWInterface::m_setParamHue },
+    { { "iso", NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamIso },
+    { { "contrast", NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamContrast },
+    { { "wdr", NULL, NULL }, false,
+      &ExynosCameraHWInterface::m_setParamWdr },
+    { { "anti-shake", NULL, NULL }, true,
+      &ExynosCameraHWInterface::m_setParamAntiShake },
+    { { "video_recording_gamma", NULL, NULL }, true,
+      &ExynosCameraHWInterface::m_setParamGamma },
+    { { "slow_ae", NULL, NULL }, true,
+      &ExynosCameraHWInterface::m_setParamSlowAe },
+    { { "shot_mode", NULL, NULL }, true,
+      &ExynosCameraHWInterface::m_setParamShotMode }
+};
+
 status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
 {
     ALOGV("DEBUG(%s):", __func__);
@@ -724,6 +809,106 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         ret = INVALID_OPERATION;
     }
 
+    // metering and focus areas are calibrated against this size
+    if (m_calPreviewW != newPreviewW || m_calPreviewH != newPreviewH) {
+        m_calPreviewW = newPreviewW;
+        m_calPreviewH = newPreviewH;
+        m_invalidateParam(PARAM_METERING_AREAS);
+        m_invalidateParam(PARAM_FOCUS_AREAS);
+    }
+
+    // scene mode, only to validate the fps range here
+    const char *strNewSceneMode = params.get(CameraParameters::KEY_SCENE_MODE);
+    const char *strCurSceneMode = m_params.get(CameraParameters::KEY_SCENE_MODE);
+
+    // fps range
+    int newMinFps = 0;
+    int newMaxFps = 0;
+    int curMinFps = 0;
+    int curMaxFps = 0;
+    params.getPreviewFpsRange(&newMinFps, &newMaxFps);
+    m_params.getPreviewFpsRange(&curMinFps, &curMaxFps);
+    /* our fps range is determined by the sensor, reject any request
+     * that isn't exactly what we're already at.
+     * but the check is performed when requesting only changing fps range
+     */
+    if (strNewSceneMode && strCurSceneMode) {
+        if (!strcmp(strNewSceneMode, strCurSceneMode)) {
+            if ((newMinFps != curMinFps) || (newMaxFps != curMaxFps)) {
+                ALOGW("%s : requested newMinFps = %d, newMaxFps = %d not allowed",
+                        __func__, newMinFps, newMaxFps);
+                ALOGE("%s : curMinFps = %d, curMaxFps = %d",
+                        __func__, curMinFps, curMaxFps);
+                ret = UNKNOWN_ERROR;
+            }
+        }
+    } else {
+        /* Check basic validation if scene mode is different */
+        if ((newMaxFps < newMinFps) ||
+            (newMinFps < 0) || (newMaxFps < 0))
+        ret = UNKNOWN_ERROR;
+    }
+
+    // only parse and apply the keys which differ from the last applied ones
+    for (int i = 0; i < PARAM_MAX; i++) {
+        if (m_paramChanged(params, i) == false)
+            continue;
+
+        status_t paramRet = (this->*m_paramTable[i].handler)(params);
+        if (paramRet == NO_ERROR)
+            m_paramApplied(params, i);
+        else if (paramRet != WOULD_BLOCK)
+            ret = paramRet;
+    }
+
+    ALOGV("DEBUG(%s):return ret = %d", __func__, ret);
+
+    return ret;
+}
+
+bool ExynosCameraHWInterface::m_paramChanged(const CameraParameters& params, int id)
+{
+    const CameraParameters *src = (m_paramTable[id].internal == true) ? &m_internalParams : &params;
+    param_cache_t *cache = &m_paramCache[id];
+
+    if (cache->valid == false)
+        return true;
+
+    for (int i = 0; i < NUM_OF_PARAM_KEYS && m_paramTable[id].keys[i] != NULL; i++) {
+        const char *value = src->get(m_paramTable[id].keys[i]);
+
+        if ((value != NULL) != cache->present[i])
+            return true;
+        if (value != NULL && strcmp(value, cache->value[i].string()))
+            return true;
+    }
+
+    return false;
+}
+
+void ExynosCameraHWInterface::m_paramApplied(const CameraParameters& params, int id)
+{
+    const CameraParameters *src = (m_paramTable[id].internal == true) ? &m_internalParams : &params;
+    param_cache_t *cache = &m_paramCache[id];
+
+    for (int i = 0; i < NUM_OF_PARAM_KEYS && m_paramTable[id].keys[i] != NULL; i++) {
+        const char *value = src->get(m_paramTable[id].keys[i]);
+
+        cache->present[i] = (value != NULL);
+        cache->value[i].setTo(value ? value : "");
+    }
+    cache->valid = true;
+}
+
+void ExynosCameraHWInterface::m_invalidateParam(int id)
+{
+    m_paramCache[id].valid = false;
+}
+
+status_t ExynosCameraHWInterface::m_setParamPictureSize(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     int newPictureW = 0;
     int newPictureH = 0;
     params.getPictureSize(&newPictureW, &newPictureH);
@@ -758,6 +943,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamPictureFormat(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // picture format
     const char *newPictureFormat = params.getPictureFormat();
     ALOGV("DEBUG(%s):newPictureFormat %s", __func__, newPictureFormat);
@@ -799,6 +991,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamJpegQuality(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // JPEG image quality
     int newJpegQuality = params.getInt(CameraParameters::KEY_JPEG_QUALITY);
     ALOGV("DEBUG(%s):newJpegQuality %d", __func__, newJpegQuality);
@@ -812,6 +1011,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamJpegThumbnailSize(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // JPEG thumbnail size
     int newJpegThumbnailW = params.getInt(CameraParameters::KEY_JPEG_THUMBNAIL_WIDTH);
     int newJpegThumbnailH = params.getInt(CameraParameters::KEY_JPEG_THUMBNAIL_HEIGHT);
@@ -825,6 +1031,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamJpegThumbnailQuality(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // JPEG thumbnail quality
     int newJpegThumbnailQuality = params.getInt(CameraParameters::KEY_JPEG_THUMBNAIL_QUALITY);
     ALOGV("DEBUG(%s):newJpegThumbnailQuality %d", __func__, newJpegThumbnailQuality);
@@ -839,12 +1052,23 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamVideoSize(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // Video size
+    // the size can not change while recording, keep it for the next call
+    if (m_videoStart == true)
+        return WOULD_BLOCK;
+
     int newVideoW = 0;
     int newVideoH = 0;
     params.getVideoSize(&newVideoW, &newVideoH);
     ALOGV("DEBUG(%s):newVideoW (%d) newVideoH (%d)", __func__, newVideoW, newVideoH);
-    if (0 < newVideoW && 0 < newVideoH && m_videoStart == false) {
+    if (0 < newVideoW && 0 < newVideoH) {
 
         m_orgVideoRect.w = newVideoW;
         m_orgVideoRect.h = newVideoH;
@@ -857,6 +1081,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         m_params.setVideoSize(newVideoW, newVideoH);
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamVideoStabilization(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // video stablization
     const char *newVideoStabilization = params.get(CameraParameters::KEY_VIDEO_STABILIZATION);
     bool currVideoStabilization = m_secCamera->getVideoStabilization();
@@ -877,6 +1108,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParam3dnr(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // 3dnr
     const char *new3dnr = params.get("3dnr");
     ALOGV("DEBUG(%s):new3drn %s", __func__, new3dnr);
@@ -894,9 +1132,16 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
             }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamOdc(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // odc
     const char *newOdc = params.get("odc");
-    ALOGV("DEBUG(%s):newOdc %s", __func__, new3dnr);
+    ALOGV("DEBUG(%s):newOdc %s", __func__, newOdc);
     if (newOdc != NULL) {
         bool toggle = false;
 
@@ -911,6 +1156,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
             }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamFrameRate(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // frame rate
     int newFrameRate = params.getPreviewFrameRate();
     ALOGV("DEBUG(%s):newFrameRate %d", __func__, newFrameRate);
@@ -925,6 +1177,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamZoom(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // zoom
     int newZoom = params.getInt(CameraParameters::KEY_ZOOM);
     ALOGV("DEBUG(%s):newZoom %d", __func__, newZoom);
@@ -938,6 +1197,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamRotation(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // rotation
     int newRotation = params.getInt(CameraParameters::KEY_ROTATION);
     ALOGV("DEBUG(%s):newRotation %d", __func__, newRotation);
@@ -951,6 +1217,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamAutoExposureLock(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // auto exposure lock
     const char *newAutoExposureLock = params.get(CameraParameters::KEY_AUTO_EXPOSURE_LOCK);
     if (newAutoExposureLock != NULL) {
@@ -967,6 +1240,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamExposureCompensation(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // exposure
     int minExposureCompensation = params.getInt(CameraParameters::KEY_MIN_EXPOSURE_COMPENSATION);
     int maxExposureCompensation = params.getInt(CameraParameters::KEY_MAX_EXPOSURE_COMPENSATION);
@@ -982,6 +1262,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamAutoWhiteBalanceLock(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // auto white balance lock
     const char *newAutoWhitebalanceLock = params.get(CameraParameters::KEY_AUTO_WHITEBALANCE_LOCK);
     if (newAutoWhitebalanceLock != NULL) {
@@ -998,6 +1285,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamWhiteBalance(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // white balance
     const char *newWhiteBalance = params.get(CameraParameters::KEY_WHITE_BALANCE);
     ALOGV("DEBUG(%s):newWhiteBalance %s", __func__, newWhiteBalance);
@@ -1035,6 +1329,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamMetering(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // Metering
     // This is the additional API(not Google API).
     // But, This is set berfore the below KEY_METERING_AREAS.
@@ -1066,6 +1367,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamMeteringAreas(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // metering areas
     const char *newMeteringAreas = params.get(CameraParameters::KEY_METERING_AREAS);
     int maxNumMeteringAreas = m_secCamera->getMaxNumMeteringAreas();
@@ -1078,10 +1386,10 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         int validMeteringAreas = m_bracketsStr2Ints((char *)newMeteringAreas, maxNumMeteringAreas, rect2s, weights);
         if (0 < validMeteringAreas) {
             for (int i = 0; i < validMeteringAreas; i++) {
-                rect2s[i].x1 = m_calibratePosition(2000, newPreviewW, rect2s[i].x1 + 1000);
-                rect2s[i].y1 = m_calibratePosition(2000, newPreviewH, rect2s[i].y1 + 1000);
-                rect2s[i].x2 = m_calibratePosition(2000, newPreviewW, rect2s[i].x2 + 1000);
-                rect2s[i].y2 = m_calibratePosition(2000, newPreviewH, rect2s[i].y2 + 1000);
+                rect2s[i].x1 = m_calibratePosition(2000, m_calPreviewW, rect2s[i].x1 + 1000);
+                rect2s[i].y1 = m_calibratePosition(2000, m_calPreviewH, rect2s[i].y1 + 1000);
+                rect2s[i].x2 = m_calibratePosition(2000, m_calPreviewW, rect2s[i].x2 + 1000);
+                rect2s[i].y2 = m_calibratePosition(2000, m_calPreviewH, rect2s[i].y2 + 1000);
             }
 
             if (m_secCamera->setMeteringAreas(validMeteringAreas, rect2s, weights) == false) {
@@ -1097,6 +1405,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         delete [] weights;
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamAntibanding(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // anti banding
     const char *newAntibanding = params.get(CameraParameters::KEY_ANTIBANDING);
     ALOGV("DEBUG(%s):newAntibanding %s", __func__, newAntibanding);
@@ -1126,37 +1441,15 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamSceneMode(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // scene mode
     const char *strNewSceneMode = params.get(CameraParameters::KEY_SCENE_MODE);
-    const char *strCurSceneMode = m_params.get(CameraParameters::KEY_SCENE_MODE);
-
-    // fps range
-    int newMinFps = 0;
-    int newMaxFps = 0;
-    int curMinFps = 0;
-    int curMaxFps = 0;
-    params.getPreviewFpsRange(&newMinFps, &newMaxFps);
-    m_params.getPreviewFpsRange(&curMinFps, &curMaxFps);
-    /* our fps range is determined by the sensor, reject any request
-     * that isn't exactly what we're already at.
-     * but the check is performed when requesting only changing fps range
-     */
-    if (strNewSceneMode && strCurSceneMode) {
-        if (!strcmp(strNewSceneMode, strCurSceneMode)) {
-            if ((newMinFps != curMinFps) || (newMaxFps != curMaxFps)) {
-                ALOGW("%s : requested newMinFps = %d, newMaxFps = %d not allowed",
-                        __func__, newMinFps, newMaxFps);
-                ALOGE("%s : curMinFps = %d, curMaxFps = %d",
-                        __func__, curMinFps, curMaxFps);
-                ret = UNKNOWN_ERROR;
-            }
-        }
-    } else {
-        /* Check basic validation if scene mode is different */
-        if ((newMaxFps < newMinFps) ||
-            (newMinFps < 0) || (newMaxFps < 0))
-        ret = UNKNOWN_ERROR;
-    }
 
     if (strNewSceneMode != NULL) {
         int  newSceneMode = -1;
@@ -1294,6 +1587,16 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    // the focus mode decides whether focus areas apply at all
+    m_invalidateParam(PARAM_FOCUS_AREAS);
+
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamFocusAreas(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // focus areas
     const char *newFocusAreas = params.get(CameraParameters::KEY_FOCUS_AREAS);
     int maxNumFocusAreas = m_secCamera->getMaxNumFocusAreas();
@@ -1325,8 +1628,8 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
                     && rect2s[0].x1 == 0 && rect2s[0].y1 == 0 && rect2s[0].x2 == 0 && rect2s[0].y2 == 0) {
                     rect2s[0].x1 = 0;
                     rect2s[0].y1 = 0;
-                    rect2s[0].x2 = newPreviewW;
-                    rect2s[0].y2 = newPreviewH;
+                    rect2s[0].x2 = m_calPreviewW;
+                    rect2s[0].y2 = m_calPreviewH;
                 } else {
                     for (int i = 0; i < validFocusedAreas; i++) {
                         rect2s[i].x1 = (rect2s[i].x1 + 1000) * 1023 / 2000;
@@ -1349,6 +1652,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamEffect(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // image effect
     const char *strNewEffect = params.get(CameraParameters::KEY_EFFECT);
     if (strNewEffect != NULL) {
@@ -1395,6 +1705,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamGpsAltitude(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // gps altitude
     const char *strNewGpsAltitude = params.get(CameraParameters::KEY_GPS_ALTITUDE);
 
@@ -1408,6 +1725,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
             m_params.remove(CameraParameters::KEY_GPS_ALTITUDE);
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamGpsLatitude(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // gps latitude
     const char *strNewGpsLatitude = params.get(CameraParameters::KEY_GPS_LATITUDE);
     if (m_secCamera->setGpsLatitude(strNewGpsLatitude) == false) {
@@ -1420,6 +1744,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
             m_params.remove(CameraParameters::KEY_GPS_LATITUDE);
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamGpsLongitude(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // gps longitude
     const char *strNewGpsLongtitude = params.get(CameraParameters::KEY_GPS_LONGITUDE);
     if (m_secCamera->setGpsLongitude(strNewGpsLongtitude) == false) {
@@ -1432,6 +1763,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
             m_params.remove(CameraParameters::KEY_GPS_LONGITUDE);
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamGpsProcessingMethod(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // gps processing method
     const char *strNewGpsProcessingMethod = params.get(CameraParameters::KEY_GPS_PROCESSING_METHOD);
 
@@ -1445,6 +1783,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
             m_params.remove(CameraParameters::KEY_GPS_PROCESSING_METHOD);
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamGpsTimestamp(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // gps timestamp
     const char *strNewGpsTimestamp = params.get(CameraParameters::KEY_GPS_TIMESTAMP);
     if (m_secCamera->setGpsTimeStamp(strNewGpsTimestamp) == false) {
@@ -1457,9 +1802,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
             m_params.remove(CameraParameters::KEY_GPS_TIMESTAMP);
     }
 
-    ///////////////////////////////////////////////////
-    // Additional API.
-    ///////////////////////////////////////////////////
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamBrightness(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // brightness
     int newBrightness = params.getInt("brightness");
     int maxBrightness = params.getInt("brightness-max");
@@ -1474,6 +1823,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamSaturation(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // saturation
     int newSaturation = params.getInt("saturation");
     int maxSaturation = params.getInt("saturation-max");
@@ -1488,6 +1844,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamSharpness(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // sharpness
     int newSharpness = params.getInt("sharpness");
     int maxSharpness = params.getInt("sharpness-max");
@@ -1502,6 +1865,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamHue(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // hue
     int newHue = params.getInt("hue");
     int maxHue = params.getInt("hue-max");
@@ -1516,6 +1886,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamIso(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // ISO
     const char *strNewISO = params.get("iso");
     ALOGV("DEBUG(%s):strNewISO %s", __func__, strNewISO);
@@ -1542,6 +1919,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamContrast(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     //contrast
     const char *strNewContrast = params.get("contrast");
     ALOGV("DEBUG(%s):strNewContrast %s", __func__, strNewContrast);
@@ -1575,6 +1959,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamWdr(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     //WDR
     int newWdr = params.getInt("wdr");
     ALOGV("DEBUG(%s):newWdr %d", __func__, newWdr);
@@ -1585,6 +1976,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamAntiShake(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     //anti shake
     int newAntiShake = m_internalParams.getInt("anti-shake");
     ALOGV("DEBUG(%s):newAntiShake %d", __func__, newAntiShake);
@@ -1599,6 +1997,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamGamma(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     //gamma
     const char *strNewGamma = m_internalParams.get("video_recording_gamma");
     ALOGV("DEBUG(%s):strNewGamma %s", __func__, strNewGamma);
@@ -1625,6 +2030,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamSlowAe(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     //slow ae
     const char *strNewSlowAe = m_internalParams.get("slow_ae");
     ALOGV("DEBUG(%s):strNewSlowAe %s", __func__, strNewSlowAe);
@@ -1651,6 +2063,13 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         }
     }
 
+    return ret;
+}
+
+status_t ExynosCameraHWInterface::m_setParamShotMode(const CameraParameters& params)
+{
+    status_t ret = NO_ERROR;
+
     // Shot mode
     int newShotMode = m_internalParams.getInt("shot_mode");
     ALOGV("DEBUG(%s):newShotMode %d", __func__, newShotMode);
@@ -1663,8 +2082,6 @@ status_t ExynosCameraHWInterface::setParameters(const CameraParameters& params)
         newShotMode=0;
     }
 
-    ALOGV("DEBUG(%s):return ret = %d", __func__, ret);
-
     return ret;
 }
 
@@ -3506,64 +3923,14 @@ void ExynosCameraHWInterface::m_savePostView(const char *fname, uint8_t *buf, ui
     ::close(fd);
 }
 
-bool ExynosCameraHWInterface::m_scaleDownYuv422(char *srcBuf, uint32_t srcWidth, uint32_t srcHeight,
-                                             char *dstBuf, uint32_t dstWidth, uint32_t dstHeight)
-{
-    int32_t step_x, step_y;
-    int32_t iXsrc, iXdst;
-    int32_t x, y, src_y_start_pos, dst_pos, src_pos;
-
-    if (dstWidth % 2 != 0 || dstHeight % 2 != 0) {
-        ALOGE("scale_down_yuv422: invalid width, height for scaling");
-        return false;
-    }
-
-    step_x = srcWidth / dstWidth;
-    step_y = srcHeight / dstHeight;
-
-    dst_pos = 0;
-    for (uint32_t y = 0; y < dstHeight; y++) {
-        src_y_start_pos = (y * step_y * (srcWidth * 2));
-
-        for (uint32_t x = 0; x < dstWidth; x += 2) {
-            src_pos = src_y_start_pos + (x * (step_x * 2));
-
-            dstBuf[dst_pos++] = srcBuf[src_pos    ];
-            dstBuf[dst_pos++] = srcBuf[src_pos + 1];
-            dstBuf[dst_pos++] = srcBuf[src_pos + 2];
-            dstBuf[dst_pos++] = srcBuf[src_pos + 3];
-        }
-    }
-
-    return true;
-}
-
 bool ExynosCameraHWInterface::m_YUY2toNV21(void *srcBuf, void *dstBuf, uint32_t srcWidth, uint32_t srcHeight)
 {
-    int32_t        x, y, src_y_start_pos, dst_cbcr_pos, dst_pos, src_pos;
-    unsigned char *srcBufPointer = (unsigned char *)srcBuf;
     unsigned char *dstBufPointer = (unsigned char *)dstBuf;
 
-    dst_pos = 0;
-    dst_cbcr_pos = srcWidth*srcHeight;
-    for (uint32_t y = 0; y < srcHeight; y++) {
-        src_y_start_pos = (y * (srcWidth * 2));
-
-        for (uint32_t x = 0; x < (srcWidth * 2); x += 2) {
-            src_pos = src_y_start_pos + x;
-
-            dstBufPointer[dst_pos++] = srcBufPointer[src_pos];
-        }
-    }
-    for (uint32_t y = 0; y < srcHeight; y += 2) {
-        src_y_start_pos = (y * (srcWidth * 2));
-
-        for (uint32_t x = 0; x < (srcWidth * 2); x += 4) {
-            src_pos = src_y_start_pos + x;
-
-            dstBufPointer[dst_cbcr_pos++] = srcBufPointer[src_pos + 3];
-            dstBufPointer[dst_cbcr_pos++] = srcBufPointer[src_pos + 1];
-        }
+    if (csc_YUYV_to_YUV420SP_NV21(dstBufPointer, dstBufPointer + (srcWidth * srcHeight),
+                                  (unsigned char *)srcBuf, srcWidth, srcHeight) != 0) {
+        ALOGE("YUY2toNV21: invalid size %dx%d", srcWidth, srcHeight);
+        return false;
     }
 
     return true;
@@ -3605,14 +3972,23 @@ bool ExynosCameraHWInterface::m_findEOIMarkerInJPEG(unsigned char *pBuf, int dwB
     }
 
     unsigned char *pBufEnd = pBuf + dwBufSize;
+    unsigned char *pCur = pBuf;
 
-    while (pBuf < pBufEnd) {
-        if (m_checkEOIMarker(pBuf++))
-            return true;
+    // only an 0xFF can start the marker, let memchr skip everything else
+    while (pCur < pBufEnd) {
+        pCur = (unsigned char *)memchr(pCur, HIBYTE(JPEG_EOI_MARKER), pBufEnd - pCur);
+        if (pCur == NULL)
+            break;
 
-        (*pnJPEGsize)++;
+        if (*(pCur + 1) == LOBYTE(JPEG_EOI_MARKER)) {
+            *pnJPEGsize += pCur - pBuf;
+            return true;
+        }
+        pCur++;
     }
 
+    *pnJPEGsize += dwBufSize;
+
     return false;
 }
 
@@ -3762,14 +4138,41 @@ int ExynosCameraHWInterface::m_decodeInterleaveData(unsigned char *pInterleaveDa
                 break;
             }
         } else {
-            // Extract JPEG Data
+            // Extract JPEG Data, up to the next padding or start-code word
+            unsigned char *run = (unsigned char *)interleave_ptr;
+            int remain = (interleaveDataSize - i + 3) & ~3;
+            int runLen = 4;
+
+            // every padding and start-code word begins with 0xFF
+            while (runLen < remain) {
+                unsigned char *ff = (unsigned char *)memchr(run + runLen, 0xFF, remain - runLen);
+                if (ff == NULL) {
+                    runLen = remain;
+                    break;
+                }
+
+                int offset = ff - run;
+                if ((offset & 3) != 0) {
+                    runLen = (offset & ~3) + 4;
+                    continue;
+                }
+
+                unsigned int word = *(unsigned int *)ff;
+                if ((word == 0xFFFFFFFF) || (word == 0x02FFFFFF) ||
+                    (word == 0xFF02FFFF) || ((word & 0xFFFF) == 0x05FF)) {
+                    runLen = offset;
+                    break;
+                }
+                runLen = offset + 4;
+            }
+
             if (pJpegData != NULL) {
-                memcpy(jpeg_ptr, interleave_ptr, 4);
-                jpeg_ptr += 4;
-                jpeg_size += 4;
+                memcpy(jpeg_ptr, run, runLen);
+                jpeg_ptr += runLen;
+                jpeg_size += runLen;
             }
-            interleave_ptr++;
-            i += 4;
+            interleave_ptr = (unsigned int *)(run + runLen);
+            i += runLen;
         }
     }
     if (ret) {
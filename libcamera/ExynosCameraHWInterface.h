@@ -60,6 +60,7 @@
 #define  NUM_OF_WAITING_PUT_PICTURE_BUF (1)
 
 #define  NUM_OF_DETECTED_FACES          (32)
+#define  NUM_OF_PARAM_KEYS              (3)
 
 namespace android {
 
@@ -164,6 +165,66 @@ private:
     };
 
 private:
+    /* setParameters() entries, each applying one group of related keys */
+    enum PARAM_ID {
+        PARAM_PICTURE_SIZE = 0,
+        PARAM_PICTURE_FORMAT,
+        PARAM_JPEG_QUALITY,
+        PARAM_JPEG_THUMBNAIL_SIZE,
+        PARAM_JPEG_THUMBNAIL_QUALITY,
+        PARAM_VIDEO_SIZE,
+        PARAM_VIDEO_STABILIZATION,
+        PARAM_3DNR,
+        PARAM_ODC,
+        PARAM_FRAME_RATE,
+        PARAM_ZOOM,
+        PARAM_ROTATION,
+        PARAM_AUTO_EXPOSURE_LOCK,
+        PARAM_EXPOSURE_COMPENSATION,
+        PARAM_AUTO_WHITEBALANCE_LOCK,
+        PARAM_WHITE_BALANCE,
+        PARAM_METERING,
+        PARAM_METERING_AREAS,
+        PARAM_ANTIBANDING,
+        PARAM_SCENE_MODE,
+        PARAM_FOCUS_AREAS,
+        PARAM_EFFECT,
+        PARAM_GPS_ALTITUDE,
+        PARAM_GPS_LATITUDE,
+        PARAM_GPS_LONGITUDE,
+        PARAM_GPS_PROCESSING_METHOD,
+        PARAM_GPS_TIMESTAMP,
+        PARAM_BRIGHTNESS,
+        PARAM_SATURATION,
+        PARAM_SHARPNESS,
+        PARAM_HUE,
+        PARAM_ISO,
+        PARAM_CONTRAST,
+        PARAM_WDR,
+        PARAM_ANTI_SHAKE,
+        PARAM_GAMMA,
+        PARAM_SLOW_AE,
+        PARAM_SHOT_MODE,
+        PARAM_MAX
+    };
+
+    typedef status_t (ExynosCameraHWInterface::*param_handler_t)(const CameraParameters& params);
+
+    struct param_entry_t {
+        const char         *keys[NUM_OF_PARAM_KEYS];
+        bool                internal;   /* keys are read from m_internalParams */
+        param_handler_t     handler;
+    };
+
+    /* key values of the last successful apply of one entry */
+    struct param_cache_t {
+        bool                valid;
+        bool                present[NUM_OF_PARAM_KEYS];
+        String8             value[NUM_OF_PARAM_KEYS];
+    };
+
+    static const param_entry_t m_paramTable[PARAM_MAX];
+
     void        m_initDefaultParameters(int cameraId);
 
     bool        m_startPreviewInternal(void);
@@ -190,9 +251,6 @@ private:
                                        void *pJpegData,
                                        void *pYuvData);
     bool        m_YUY2toNV21(void *srcBuf, void *dstBuf, uint32_t srcWidth, uint32_t srcHeight);
-    bool        m_scaleDownYuv422(char *srcBuf, uint32_t srcWidth,
-                                  uint32_t srcHight, char *dstBuf,
-                                  uint32_t dstWidth, uint32_t dstHight);
 
     bool        m_checkVideoStartMarker(unsigned char *pBuf);
     bool        m_checkEOIMarker(unsigned char *pBuf);
@@ -220,6 +278,49 @@ private:
                                int *crop_w, int *crop_h,
                                int zoom);
     int         m_calibratePosition(int w, int new_w, int x);
+
+    bool        m_paramChanged(const CameraParameters& params, int id);
+    void        m_paramApplied(const CameraParameters& params, int id);
+    void        m_invalidateParam(int id);
+
+    status_t    m_setParamPictureSize(const CameraParameters& params);
+    status_t    m_setParamPictureFormat(const CameraParameters& params);
+    status_t    m_setParamJpegQuality(const CameraParameters& params);
+    status_t    m_setParamJpegThumbnailSize(const CameraParameters& params);
+    status_t    m_setParamJpegThumbnailQuality(const CameraParameters& params);
+    status_t    m_setParamVideoSize(const CameraParameters& params);
+    status_t    m_setParamVideoStabilization(const CameraParameters& params);
+    status_t    m_setParam3dnr(const CameraParameters& params);
+    status_t    m_setParamOdc(const CameraParameters& params);
+    status_t    m_setParamFrameRate(const CameraParameters& params);
+    status_t    m_setParamZoom(const CameraParameters& params);
+    status_t    m_setParamRotation(const CameraParameters& params);
+    status_t    m_setParamAutoExposureLock(const CameraParameters& params);
+    status_t    m_setParamExposureCompensation(const CameraParameters& params);
+    status_t    m_setParamAutoWhiteBalanceLock(const CameraParameters& params);
+    status_t    m_setParamWhiteBalance(const CameraParameters& params);
+    status_t    m_setParamMetering(const CameraParameters& params);
+    status_t    m_setParamMeteringAreas(const CameraParameters& params);
+    status_t    m_setParamAntibanding(const CameraParameters& params);
+    status_t    m_setParamSceneMode(const CameraParameters& params);
+    status_t    m_setParamFocusAreas(const CameraParameters& params);
+    status_t    m_setParamEffect(const CameraParameters& params);
+    status_t    m_setParamGpsAltitude(const CameraParameters& params);
+    status_t    m_setParamGpsLatitude(const CameraParameters& params);
+    status_t    m_setParamGpsLongitude(const CameraParameters& params);
+    status_t    m_setParamGpsProcessingMethod(const CameraParameters& params);
+    status_t    m_setParamGpsTimestamp(const CameraParameters& params);
+    status_t    m_setParamBrightness(const CameraParameters& params);
+    status_t    m_setParamSaturation(const CameraParameters& params);
+    status_t    m_setParamSharpness(const CameraParameters& params);
+    status_t    m_setParamHue(const CameraParameters& params);
+    status_t    m_setParamIso(const CameraParameters& params);
+    status_t    m_setParamContrast(const CameraParameters& params);
+    status_t    m_setParamWdr(const CameraParameters& params);
+    status_t    m_setParamAntiShake(const CameraParameters& params);
+    status_t    m_setParamGamma(const CameraParameters& params);
+    status_t    m_setParamSlowAe(const CameraParameters& params);
+    status_t    m_setParamShotMode(const CameraParameters& params);
 #ifdef LOG_NDEBUG
     bool        m_fileDump(char *filename, void *srcBuf, uint32_t size);
 #endif
@@ -284,6 +385,9 @@ private:
 
     CameraParameters    m_params;
     CameraParameters    m_internalParams;
+    param_cache_t       m_paramCache[PARAM_MAX];
+    int                 m_calPreviewW;
+    int                 m_calPreviewH;
 
     camera_memory_t    *m_previewHeap[NUM_OF_PREVIEW_BUF];
     buffer_handle_t    *m_previewBufHandle[NUM_OF_PREVIEW_BUF];
@@ -18,6 +18,7 @@
 #include <utils/Log.h>
 
 #include "ExynosJpegEncoderForCamera.h"
+#include "swconverter.h"
 
 static const char ExifAsciiPrefix[] = { 0x41, 0x53, 0x43, 0x49, 0x49, 0x0, 0x0, 0x0 };
 
@@ -690,33 +691,13 @@ inline void ExynosJpegEncoderForCamera::writeExifIfd(unsigned char **pCur,
 
 int ExynosJpegEncoderForCamera::scaleDownYuv422(char **srcBuf, unsigned int srcW, unsigned int srcH,  char **dstBuf, unsigned int dstW, unsigned int dstH)
 {
-    int step_x, step_y;
-    int src_y_start_pos, dst_pos, src_pos;
-    char *src_buf = srcBuf[0];
-    char *dst_buf = dstBuf[0];
-
     if (dstW & 0x01 || dstH & 0x01) {
         return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
     }
 
-    step_x = srcW / dstW;
-    step_y = srcH / dstH;
-
-    unsigned int srcWStride = srcW * 2;
-    unsigned int stepXStride = step_x * 2;
-
-    dst_pos = 0;
-    for (unsigned int y = 0; y < dstH; y++) {
-        src_y_start_pos = srcWStride * step_y * y;
-
-        for (unsigned int x = 0; x < dstW; x += 2) {
-            src_pos = src_y_start_pos + (stepXStride * x);
-
-            dst_buf[dst_pos++] = src_buf[src_pos    ];
-            dst_buf[dst_pos++] = src_buf[src_pos + 1];
-            dst_buf[dst_pos++] = src_buf[src_pos + 2];
-            dst_buf[dst_pos++] = src_buf[src_pos + 3];
-        }
+    if (csc_scale_down_YUYV((unsigned char *)dstBuf[0], dstW, dstH,
+                            (unsigned char *)srcBuf[0], srcW, srcH) != 0) {
+        return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
     }
 
     return ERROR_NONE;
@@ -724,46 +705,13 @@ int ExynosJpegEncoderForCamera::scaleDownYuv422(char **srcBuf, unsigned int srcW
 
 int ExynosJpegEncoderForCamera::scaleDownYuv422_2p(char **srcBuf, unsigned int srcW, unsigned int srcH, char **dstBuf, unsigned int dstW, unsigned int dstH)
 {
-    int32_t step_x, step_y;
-    int32_t src_y_start_pos, dst_pos, src_pos;
-    int32_t src_Y_offset;
-    char *src_buf;
-    char *dst_buf;
-
     if (dstW % 2 != 0 || dstH % 2 != 0) {
         return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
     }
 
-    step_x = srcW / dstW;
-    step_y = srcH / dstH;
-
-    // Y scale down
-    src_buf = srcBuf[0];
-    dst_buf = dstBuf[0];
-    dst_pos = 0;
-    for (uint32_t y = 0; y < dstH; y++) {
-        src_y_start_pos = y * step_y * srcW;
-
-        for (uint32_t x = 0; x < dstW; x++) {
-            src_pos = src_y_start_pos + (x * step_x);
-
-            dst_buf[dst_pos++] = src_buf[src_pos];
-        }
-    }
-
-    // UV scale down
-    src_buf = srcBuf[1];
-    dst_buf = dstBuf[1];
-    dst_pos = 0;
-    for (uint32_t i = 0; i < dstH; i++) {
-        src_y_start_pos = i * step_y * srcW;
-
-        for (uint32_t j = 0; j < dstW; j += 2) {
-            src_pos = src_y_start_pos + (j * step_x);
-
-            dst_buf[dst_pos++] = src_buf[src_pos    ];
-            dst_buf[dst_pos++] = src_buf[src_pos + 1];
-        }
+    if (csc_scale_down_YUV422SP((unsigned char *)dstBuf[0], (unsigned char *)dstBuf[1], dstW, dstH,
+                                (unsigned char *)srcBuf[0], (unsigned char *)srcBuf[1], srcW, srcH) != 0) {
+        return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
     }
 
     return ERROR_NONE;
@@ -16,7 +16,8 @@ LOCAL_SRC_FILES:= \
 	MetadataConverter.cpp \
 	ExynosCameraHWInterface2.cpp \
 	ExynosCamera2.cpp \
-	ExynosJpegEncoderForCamera.cpp
+	ExynosJpegEncoderForCamera.cpp \
+	ExynosCameraMemoryPool.cpp
 
 
 LOCAL_SHARED_LIBRARIES:= libutils libcutils libbinder liblog libcamera_client libhardware
@@ -25,6 +26,8 @@ LOCAL_CFLAGS += -DGAIA_FW_BETA
 
 LOCAL_SHARED_LIBRARIES += libexynosutils libhwjpeg libexynosv4l2 libcsc libion_exynos libcamera_metadata
 
+LOCAL_STATIC_LIBRARIES := libswconverter
+
 LOCAL_MODULE := camera.exynos5
 
 LOCAL_MODULE_TAGS := optional
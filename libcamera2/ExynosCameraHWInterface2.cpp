@@ -111,6 +111,19 @@ int get_pixel_depth(uint32_t fmt)
     return depth;
 }
 
+/*
+ * The scaler writes a YV12 frame with its chroma stride at half the luma
+ * stride. Gralloc rounds the chroma stride up to 16, so those layouts are
+ * scaled into m_previewCbBuf and copied row by row instead.
+ */
+static bool prvcb_needs_row_copy(const substream_parameters_t *subParms)
+{
+    if (subParms->format != HAL_PIXEL_FORMAT_YV12)
+        return false;
+
+    return (ALIGN(subParms->svcBufStride / 2, 16) != subParms->svcBufStride / 2);
+}
+
 int cam_int_s_fmt(node_info_t *node)
 {
     struct v4l2_format v4l2_fmt;
@@ -279,7 +292,30 @@ int cam_int_s_input(node_info_t *node, int index)
 
 gralloc_module_t const* ExynosCameraHWInterface2::m_grallocHal;
 
-RequestManager::RequestManager(SignalDrivenThread* main_thread):
+// release always goes first and ends the wakeup, like the early return it replaces
+const signal_dispatch_entry_t ExynosCameraHWInterface2::m_mainSignalTable[NUM_MAIN_SIGNAL_ENTRIES] = {
+    { SIGNAL_THREAD_RELEASE,                true  },
+    { SIGNAL_MAIN_STREAM_OUTPUT_DONE,       false },    // frees a request slot for the dequeue below
+    { SIGNAL_MAIN_REQ_Q_NOT_EMPTY,          false },
+};
+
+const signal_dispatch_entry_t ExynosCameraHWInterface2::m_sensorSignalTable[NUM_SENSOR_SIGNAL_ENTRIES] = {
+    { SIGNAL_THREAD_RELEASE,                true  },
+    { SIGNAL_SENSOR_START_REQ_PROCESSING,   false },
+};
+
+const signal_dispatch_entry_t ExynosCameraHWInterface2::m_streamSignalTable[NUM_STREAM_SIGNAL_ENTRIES] = {
+    { SIGNAL_THREAD_RELEASE,                true  },
+    { SIGNAL_STREAM_REPROCESSING_START,     false },
+    { SIGNAL_STREAM_DATA_COMING,            false },
+};
+
+const signal_dispatch_entry_t ExynosCameraHWInterface2::m_jpegSignalTable[NUM_JPEG_SIGNAL_ENTRIES] = {
+    { SIGNAL_THREAD_RELEASE,                true  },
+    { SIGNAL_JPEG_ENCODE_START,             false },
+};
+
+RequestManager::RequestManager(SignalDrivenThread* main_thread, int depth):
     m_lastAeMode(0),
     m_lastAaMode(0),
     m_lastAwbMode(0),
@@ -289,6 +325,24 @@ RequestManager::RequestManager(SignalDrivenThread* main_thread):
 {
     m_metadataConverter = new MetadataConverter;
     m_mainThread = main_thread;
+
+    if (depth < 2)
+        depth = 2;
+    if (depth > MAX_REQUEST_MGR_DEPTH)
+        depth = MAX_REQUEST_MGR_DEPTH;
+    m_depth = depth;
+    entries = new request_manager_entry_t[m_depth];
+
+    m_tempFrameMetadataBuf = NULL;
+    m_tempFrameMetadataBufSize = 0;
+    m_frameMetadataEntryCap = 35; //estimated
+    m_frameMetadataDataCap = 500;
+    m_tempFrameMetadata = NULL;
+    GrowFrameMetadataBuf();
+
+    m_sensorQHead = 0;
+    m_sensorQCount = 0;
+
     ResetEntry();
     m_sensorPipelineSkipCnt = 0;
     return;
@@ -303,17 +357,22 @@ RequestManager::~RequestManager()
     }
 
     releaseSensorQ();
+
+    delete[] entries;
+    entries = NULL;
+    free(m_tempFrameMetadataBuf);
+    m_tempFrameMetadataBuf = NULL;
     return;
 }
 
 void RequestManager::ResetEntry()
 {
     Mutex::Autolock lock(m_requestMutex);
-    for (int i=0 ; i<NUM_MAX_REQUEST_MGR_ENTRY; i++) {
+    for (int i=0 ; i<m_depth; i++) {
         memset(&(entries[i]), 0x00, sizeof(request_manager_entry_t));
         entries[i].internal_shot.shot.ctl.request.frameCount = -1;
     }
-    m_numOfEntries = 0;
+    android_atomic_release_store(0, &m_numOfEntries);
     m_entryInsertionIndex = -1;
     m_entryProcessingIndex = -1;
     m_entryFrameOutputIndex = -1;
@@ -321,7 +380,7 @@ void RequestManager::ResetEntry()
 
 int RequestManager::GetNumEntries()
 {
-    return m_numOfEntries;
+    return android_atomic_acquire_load(&m_numOfEntries);
 }
 
 void RequestManager::SetDefaultParameters(int cropX)
@@ -331,31 +390,47 @@ void RequestManager::SetDefaultParameters(int cropX)
 
 bool RequestManager::IsRequestQueueFull()
 {
-    Mutex::Autolock lock(m_requestMutex);
-    if (m_numOfEntries>=NUM_MAX_REQUEST_MGR_ENTRY)
+    if (GetNumEntries() >= m_depth)
         return true;
     else
         return false;
 }
 
-void RequestManager::RegisterRequest(camera_metadata_t * new_request, int * afMode, uint32_t * afRegion)
+int RequestManager::RegisterRequest(camera_metadata_t * new_request, int * afMode, uint32_t * afRegion)
 {
     ALOGV("DEBUG(%s):", __FUNCTION__);
 
     Mutex::Autolock lock(m_requestMutex);
 
     request_manager_entry * newEntry = NULL;
-    int newInsertionIndex = GetNextIndex(m_entryInsertionIndex);
-    ALOGV("DEBUG(%s): got lock, new insertIndex(%d), cnt before reg(%d)", __FUNCTION__,newInsertionIndex, m_numOfEntries );
+    camera_metadata_entry_t frameCntEntry;
+    int newInsertionIndex;
 
+    if (find_camera_metadata_entry(new_request, ANDROID_REQUEST_FRAME_COUNT, &frameCntEntry) == 0
+        && frameCntEntry.count == 1 && frameCntEntry.data.i32[0] >= 0)
+        newInsertionIndex = frameCntEntry.data.i32[0] % m_depth;
+    else
+        newInsertionIndex = GetNextIndex(m_entryInsertionIndex);
+    ALOGV("DEBUG(%s): got lock, new insertIndex(%d), cnt before reg(%d)", __FUNCTION__,newInsertionIndex, m_numOfEntries );
 
-    newEntry = &(entries[newInsertionIndex]);
 
-    if (newEntry->status!=EMPTY) {
-        ALOGV("DEBUG(%s): Circular buffer abnormal ", __FUNCTION__);
-        return;
+    // a frameCnt slot still held by an older request falls back to any free one,
+    // FindEntryIndexByFrameCnt scans the ring for entries off their slot
+    if (android_atomic_acquire_load(&entries[newInsertionIndex].status) != EMPTY) {
+        int i;
+        for (i = 1 ; i < m_depth ; i++) {
+            int index = (newInsertionIndex + i) % m_depth;
+            if (android_atomic_acquire_load(&entries[index].status) == EMPTY)
+                break;
+        }
+        if (i == m_depth) {
+            ALOGE("ERR(%s): Circular buffer abnormal, no empty slot, numOfEntries(%d)",
+                __FUNCTION__, m_numOfEntries);
+            return -1;
+        }
+        newInsertionIndex = (newInsertionIndex + i) % m_depth;
     }
-    newEntry->status = REGISTERED;
+    newEntry = &(entries[newInsertionIndex]);
     newEntry->original_request = new_request;
     memset(&(newEntry->internal_shot), 0, sizeof(struct camera2_shot_ext));
     m_metadataConverter->ToInternalShot(new_request, &(newEntry->internal_shot));
@@ -366,7 +441,9 @@ void RequestManager::RegisterRequest(camera_metadata_t * new_request, int * afMo
     if (newEntry->internal_shot.shot.ctl.request.outputStreams[0] & MASK_OUTPUT_SCC)
         newEntry->output_stream_count++;
 
-    m_numOfEntries++;
+    // publish the entry only once it is fully built
+    android_atomic_release_store(REGISTERED, &newEntry->status);
+    android_atomic_inc(&m_numOfEntries);
     m_entryInsertionIndex = newInsertionIndex;
 
 
@@ -377,6 +454,7 @@ void RequestManager::RegisterRequest(camera_metadata_t * new_request, int * afMo
     afRegion[3] = newEntry->internal_shot.shot.ctl.aa.afRegions[3];
     ALOGV("## RegisterReq DONE num(%d), insert(%d), processing(%d), frame(%d), (frameCnt(%d))",
     m_numOfEntries,m_entryInsertionIndex,m_entryProcessingIndex, m_entryFrameOutputIndex, newEntry->internal_shot.shot.ctl.request.frameCount);
+    return 0;
 }
 
 void RequestManager::DeregisterRequest(camera_metadata_t ** deregistered_request)
@@ -388,29 +466,60 @@ void RequestManager::DeregisterRequest(camera_metadata_t ** deregistered_request
     Mutex::Autolock lock(m_requestMutex);
 
     frame_index = GetCompletedIndex();
+    if (frame_index == -1) {
+        CAM_LOGD("DBG(%s): Circular buffer abnormal. no entry for frameCnt(%d)", __FUNCTION__,
+                       m_lastCompletedFrameCnt + 1);
+        return;
+    }
     currentEntry =  &(entries[frame_index]);
-    if (currentEntry->status != COMPLETED) {
+    if (android_atomic_acquire_load(&currentEntry->status) != COMPLETED) {
         CAM_LOGD("DBG(%s): Circular buffer abnormal. processing(%d), frame(%d), status(%d) ", __FUNCTION__,
                        m_entryProcessingIndex, frame_index,(int)(currentEntry->status));
         return;
     }
     if (deregistered_request)  *deregistered_request = currentEntry->original_request;
 
-    m_lastCompletedFrameCnt = currentEntry->internal_shot.shot.ctl.request.frameCount;
+    android_atomic_release_store(currentEntry->internal_shot.shot.ctl.request.frameCount, &m_lastCompletedFrameCnt);
 
-    currentEntry->status = EMPTY;
     currentEntry->original_request = NULL;
     memset(&(currentEntry->internal_shot), 0, sizeof(struct camera2_shot_ext));
     currentEntry->internal_shot.shot.ctl.request.frameCount = -1;
     currentEntry->output_stream_count = 0;
-    m_numOfEntries--;
+    android_atomic_release_store(EMPTY, &currentEntry->status);
+    android_atomic_dec(&m_numOfEntries);
     ALOGV("## DeRegistReq DONE num(%d), insert(%d), processing(%d), frame(%d)",
      m_numOfEntries,m_entryInsertionIndex,m_entryProcessingIndex, m_entryFrameOutputIndex);
 
-    CheckCompleted(GetNextIndex(frame_index));
+    int next_index = GetCompletedIndex();
+    if (next_index != -1)
+        CheckCompleted(next_index);
     return;
 }
 
+bool RequestManager::GrowFrameMetadataBuf()
+{
+    size_t newSize;
+    char *newBuf;
+
+    if (m_tempFrameMetadataBuf != NULL) {
+        if (m_frameMetadataEntryCap >= MAX_FRAME_METADATA_ENTRIES)
+            return false;
+        m_frameMetadataEntryCap *= 2;
+        m_frameMetadataDataCap *= 2;
+    }
+    newSize = calculate_camera_metadata_size(m_frameMetadataEntryCap, m_frameMetadataDataCap);
+    newBuf = (char *)realloc(m_tempFrameMetadataBuf, newSize);
+    if (newBuf == NULL) {
+        ALOGE("ERR(%s): cannot grow frame metadata buffer to %d bytes", __FUNCTION__, newSize);
+        return false;
+    }
+    m_tempFrameMetadataBuf = newBuf;
+    m_tempFrameMetadataBufSize = newSize;
+    ALOGV("DEBUG(%s): frame metadata buffer %d bytes (%d entries, %d data)", __FUNCTION__,
+        newSize, m_frameMetadataEntryCap, m_frameMetadataDataCap);
+    return true;
+}
+
 bool RequestManager::PrepareFrame(size_t* num_entries, size_t* frame_size,
                 camera_metadata_t ** prepared_frame, int afState)
 {
@@ -418,20 +527,30 @@ bool RequestManager::PrepareFrame(size_t* num_entries, size_t* frame_size,
     Mutex::Autolock lock(m_requestMutex);
     status_t res = NO_ERROR;
     int tempFrameOutputIndex = GetCompletedIndex();
+    if (tempFrameOutputIndex == -1) {
+        ALOGV("DBG(%s): no entry for frameCnt(%d)", __FUNCTION__, m_lastCompletedFrameCnt + 1);
+        return false;
+    }
     request_manager_entry * currentEntry =  &(entries[tempFrameOutputIndex]);
     ALOGV("DEBUG(%s): processing(%d), frameOut(%d), insert(%d) recentlycompleted(%d)", __FUNCTION__,
         m_entryProcessingIndex, m_entryFrameOutputIndex, m_entryInsertionIndex, m_completedIndex);
 
-    if (currentEntry->status != COMPLETED) {
+    if (android_atomic_acquire_load(&currentEntry->status) != COMPLETED) {
         ALOGV("DBG(%s): Circular buffer abnormal status(%d)", __FUNCTION__, (int)(currentEntry->status));
 
         return false;
     }
     m_entryFrameOutputIndex = tempFrameOutputIndex;
-    m_tempFrameMetadata = place_camera_metadata(m_tempFrameMetadataBuf, 2000, 35, 500); //estimated
-    add_camera_metadata_entry(m_tempFrameMetadata, ANDROID_CONTROL_AF_STATE, &afState, 1);
-    res = m_metadataConverter->ToDynamicMetadata(&(currentEntry->internal_shot),
-                m_tempFrameMetadata);
+    do {
+        m_tempFrameMetadata = place_camera_metadata(m_tempFrameMetadataBuf, m_tempFrameMetadataBufSize,
+                                  m_frameMetadataEntryCap, m_frameMetadataDataCap);
+        if (add_camera_metadata_entry(m_tempFrameMetadata, ANDROID_CONTROL_AF_STATE, &afState, 1) != 0)
+            res = NO_MEMORY;
+        else
+            res = m_metadataConverter->ToDynamicMetadata(&(currentEntry->internal_shot),
+                    m_tempFrameMetadata);
+        // the frame did not fit, retry once the scratch buffer has doubled
+    } while (res == NO_MEMORY && GrowFrameMetadataBuf());
     if (res!=NO_ERROR) {
         ALOGE("ERROR(%s): ToDynamicMetadata (%d) ", __FUNCTION__, res);
         return false;
@@ -445,6 +564,20 @@ bool RequestManager::PrepareFrame(size_t* num_entries, size_t* frame_size,
     return true;
 }
 
+int RequestManager::FindOldestRegisteredIndex()
+{
+    int index = -1;
+
+    for (int i = 0 ; i < m_depth ; i++) {
+        if (android_atomic_acquire_load(&entries[i].status) != REGISTERED)
+            continue;
+        if (index == -1 || entries[i].internal_shot.shot.ctl.request.frameCount
+                            < entries[index].internal_shot.shot.ctl.request.frameCount)
+            index = i;
+    }
+    return index;
+}
+
 int RequestManager::MarkProcessingRequest(ExynosBuffer* buf)
 {
     struct camera2_shot_ext * shot_ext;
@@ -454,33 +587,33 @@ int RequestManager::MarkProcessingRequest(ExynosBuffer* buf)
     static int count = 0;
 
     Mutex::Autolock lock(m_requestMutex);
-    if (m_numOfEntries == 0)  {
+    if (GetNumEntries() == 0)  {
         CAM_LOGD("DEBUG(%s): Request Manager Empty ", __FUNCTION__);
         return -1;
     }
 
-    if ((m_entryProcessingIndex == m_entryInsertionIndex)
-        && (entries[m_entryProcessingIndex].status == REQUESTED || entries[m_entryProcessingIndex].status == CAPTURED)) {
+    int newProcessingIndex = GetNextIndex(m_entryProcessingIndex);
+    // frame counts with gaps do not land in the next slot
+    if (android_atomic_acquire_load(&entries[newProcessingIndex].status) != REGISTERED)
+        newProcessingIndex = FindOldestRegisteredIndex();
+
+    if (newProcessingIndex == -1) {
         ALOGV("## MarkProcReq skipping(request underrun) -  num(%d), insert(%d), processing(%d), frame(%d)",
          m_numOfEntries,m_entryInsertionIndex,m_entryProcessingIndex, m_entryFrameOutputIndex);
         return -1;
     }
-
-    int newProcessingIndex = GetNextIndex(m_entryProcessingIndex);
     ALOGV("DEBUG(%s): index(%d)", __FUNCTION__, newProcessingIndex);
 
     newEntry = &(entries[newProcessingIndex]);
     request_shot = &(newEntry->internal_shot);
-    if (newEntry->status != REGISTERED) {
+    if (android_atomic_cmpxchg(REGISTERED, REQUESTED, &newEntry->status) != 0) {
         CAM_LOGD("DEBUG(%s)(%d): Circular buffer abnormal, numOfEntries(%d), status(%d)", __FUNCTION__, newProcessingIndex, m_numOfEntries, newEntry->status);
-        for (int i = 0; i < NUM_MAX_REQUEST_MGR_ENTRY; i++) {
+        for (int i = 0; i < m_depth; i++) {
                 CAM_LOGD("DBG: entrie[%d].stream output cnt = %d, framecnt(%d)", i, entries[i].output_stream_count, entries[i].internal_shot.shot.ctl.request.frameCount);
         }
         return -1;
     }
 
-    newEntry->status = REQUESTED;
-
     shot_ext = (struct camera2_shot_ext *)buf->virt.extP[1];
 
     memset(shot_ext, 0x00, sizeof(struct camera2_shot_ext));
@@ -528,7 +661,6 @@ void RequestManager::NotifyStreamOutput(int frameCnt)
 {
     int index;
 
-    Mutex::Autolock lock(m_requestMutex);
     ALOGV("DEBUG(%s): frameCnt(%d)", __FUNCTION__, frameCnt);
 
     index = FindEntryIndexByFrameCnt(frameCnt);
@@ -538,61 +670,69 @@ void RequestManager::NotifyStreamOutput(int frameCnt)
     }
     ALOGV("DEBUG(%s): frameCnt(%d), last cnt (%d)", __FUNCTION__, frameCnt,   entries[index].output_stream_count);
 
-    entries[index].output_stream_count--;  //TODO : match stream id also
+    android_atomic_dec(&entries[index].output_stream_count);  //TODO : match stream id also
     CheckCompleted(index);
 }
 
 void RequestManager::CheckCompleted(int index)
 {
-    if ((entries[index].status == METADONE || entries[index].status == COMPLETED)
-        && (entries[index].output_stream_count <= 0)){
-        ALOGV("(%s): Completed(index:%d)(frameCnt:%d)", __FUNCTION__,
-                index, entries[index].internal_shot.shot.ctl.request.frameCount );
-        entries[index].status = COMPLETED;
-        if (m_lastCompletedFrameCnt + 1 == entries[index].internal_shot.shot.ctl.request.frameCount)
-            m_mainThread->SetSignal(SIGNAL_MAIN_STREAM_OUTPUT_DONE);
-    }
+    int32_t status = android_atomic_acquire_load(&entries[index].status);
+
+    if ((status != METADONE && status != COMPLETED)
+        || (android_atomic_acquire_load(&entries[index].output_stream_count) > 0))
+        return;
+
+    // metadata and the last stream output may race here, only one completes
+    if (status == METADONE && android_atomic_cmpxchg(METADONE, COMPLETED, &entries[index].status) != 0)
+        return;
+
+    ALOGV("(%s): Completed(index:%d)(frameCnt:%d)", __FUNCTION__,
+            index, entries[index].internal_shot.shot.ctl.request.frameCount );
+    if (android_atomic_acquire_load(&m_lastCompletedFrameCnt) + 1 == entries[index].internal_shot.shot.ctl.request.frameCount)
+        m_mainThread->SetSignal(SIGNAL_MAIN_STREAM_OUTPUT_DONE);
 }
 
+// caller holds m_requestMutex
 int RequestManager::GetCompletedIndex()
 {
-    return FindEntryIndexByFrameCnt(m_lastCompletedFrameCnt + 1);
+    return FindEntryIndexByFrameCntLocked(android_atomic_acquire_load(&m_lastCompletedFrameCnt) + 1);
 }
 
 void  RequestManager::pushSensorQ(int index)
 {
-    Mutex::Autolock lock(m_requestMutex);
-    m_sensorQ.push_back(index);
+    Mutex::Autolock lock(m_sensorQMutex);
+
+    if (m_sensorQCount >= NUM_MAX_CAMERA_BUFFERS) {
+        ALOGE("ERR(%s): sensorQ full, dropping index(%d)", __FUNCTION__, index);
+        return;
+    }
+    m_sensorQ[(m_sensorQHead + m_sensorQCount) % NUM_MAX_CAMERA_BUFFERS] = index;
+    m_sensorQCount++;
 }
 
 int RequestManager::popSensorQ()
 {
-   List<int>::iterator sensor_token;
-   int index;
+    int index;
 
-    Mutex::Autolock lock(m_requestMutex);
+    Mutex::Autolock lock(m_sensorQMutex);
 
-    if(m_sensorQ.size() == 0)
+    if (m_sensorQCount == 0)
         return -1;
 
-    sensor_token = m_sensorQ.begin()++;
-    index = *sensor_token;
-    m_sensorQ.erase(sensor_token);
+    index = m_sensorQ[m_sensorQHead];
+    m_sensorQHead = (m_sensorQHead + 1) % NUM_MAX_CAMERA_BUFFERS;
+    m_sensorQCount--;
 
     return (index);
 }
 
 void RequestManager::releaseSensorQ()
 {
-    List<int>::iterator r;
+    Mutex::Autolock lock(m_sensorQMutex);
+    ALOGV("(%s)m_sensorQ.size : %d", __FUNCTION__, m_sensorQCount);
 
-    Mutex::Autolock lock(m_requestMutex);
-    ALOGV("(%s)m_sensorQ.size : %d", __FUNCTION__, m_sensorQ.size());
-
-    while(m_sensorQ.size() > 0){
-        r  = m_sensorQ.begin()++;
-        m_sensorQ.erase(r);
-    }
+    m_sensorQHead = 0;
+    m_sensorQCount = 0;
     return;
 }
 
@@ -601,32 +741,29 @@ void RequestManager::ApplyDynamicMetadata(struct camera2_shot_ext *shot_ext)
     int index;
     struct camera2_shot_ext * request_shot;
     nsecs_t timeStamp;
-    int i;
 
-    Mutex::Autolock lock(m_requestMutex);
     ALOGV("DEBUG(%s): frameCnt(%d)", __FUNCTION__, shot_ext->shot.ctl.request.frameCount);
 
-    for (i = 0 ; i < NUM_MAX_REQUEST_MGR_ENTRY ; i++) {
-        if((entries[i].internal_shot.shot.ctl.request.frameCount == shot_ext->shot.ctl.request.frameCount)
-            && (entries[i].status == CAPTURED)){
-            entries[i].status = METADONE;
-            break;
-        }
-    }
-
-    if (i == NUM_MAX_REQUEST_MGR_ENTRY){
+    index = FindEntryIndexByFrameCnt(shot_ext->shot.ctl.request.frameCount);
+    if (index == -1 || android_atomic_acquire_load(&entries[index].status) != CAPTURED) {
         ALOGE("[%s] no entry found(framecount:%d)", __FUNCTION__, shot_ext->shot.ctl.request.frameCount);
         return;
     }
 
-    request_manager_entry * newEntry = &(entries[i]);
+    request_manager_entry * newEntry = &(entries[index]);
     request_shot = &(newEntry->internal_shot);
 
     timeStamp = request_shot->shot.dm.sensor.timeStamp;
     memcpy(&(request_shot->shot.dm), &(shot_ext->shot.dm), sizeof(struct camera2_dm));
     request_shot->shot.dm.sensor.timeStamp = timeStamp;
     m_lastTimeStamp = timeStamp;
-    CheckCompleted(i);
+
+    // dm is in place before the entry can be seen as METADONE
+    if (android_atomic_cmpxchg(CAPTURED, METADONE, &newEntry->status) != 0) {
+        ALOGE("[%s] entry state changed under us(framecount:%d)", __FUNCTION__, shot_ext->shot.ctl.request.frameCount);
+        return;
+    }
+    CheckCompleted(index);
 }
 
 void    RequestManager::UpdateIspParameters(struct camera2_shot_ext *shot_ext, int frameCnt, ctl_request_info_t *ctl_info)
@@ -751,7 +888,21 @@ bool    RequestManager::IsVdisEnable(void)
 
 int     RequestManager::FindEntryIndexByFrameCnt(int frameCnt)
 {
-    for (int i = 0 ; i < NUM_MAX_REQUEST_MGR_ENTRY ; i++) {
+    Mutex::Autolock lock(m_requestMutex);
+
+    return FindEntryIndexByFrameCntLocked(frameCnt);
+}
+
+// frameCount is only rewritten by Register/DeregisterRequest under m_requestMutex
+int     RequestManager::FindEntryIndexByFrameCntLocked(int frameCnt)
+{
+    if (frameCnt >= 0) {
+        int index = frameCnt % m_depth;
+        if (entries[index].internal_shot.shot.ctl.request.frameCount == frameCnt)
+            return index;
+    }
+
+    for (int i = 0 ; i < m_depth ; i++) {
         if (entries[i].internal_shot.shot.ctl.request.frameCount == frameCnt)
             return i;
     }
@@ -791,8 +942,7 @@ nsecs_t  RequestManager::GetTimestampByFrameCnt(int frameCnt)
 
 nsecs_t  RequestManager::GetTimestamp(int index)
 {
-    Mutex::Autolock lock(m_requestMutex);
-    if (index < 0 || index >= NUM_MAX_REQUEST_MGR_ENTRY) {
+    if (index < 0 || index >= m_depth) {
         ALOGE("ERR(%s): Request entry outside of bounds (%d)", __FUNCTION__, index);
         return 0;
     }
@@ -820,8 +970,7 @@ uint8_t  RequestManager::GetOutputStreamByFrameCnt(int frameCnt)
 
 uint8_t  RequestManager::GetOutputStream(int index)
 {
-    Mutex::Autolock lock(m_requestMutex);
-    if (index < 0 || index >= NUM_MAX_REQUEST_MGR_ENTRY) {
+    if (index < 0 || index >= m_depth) {
         ALOGE("ERR(%s): Request entry outside of bounds (%d)", __FUNCTION__, index);
         return 0;
     }
@@ -843,8 +992,7 @@ camera2_shot_ext *  RequestManager::GetInternalShotExtByFrameCnt(int frameCnt)
 
 camera2_shot_ext *  RequestManager::GetInternalShotExt(int index)
 {
-    Mutex::Autolock lock(m_requestMutex);
-    if (index < 0 || index >= NUM_MAX_REQUEST_MGR_ENTRY) {
+    if (index < 0 || index >= m_depth) {
         ALOGE("ERR(%s): Request entry outside of bounds (%d)", __FUNCTION__, index);
         return 0;
     }
@@ -855,24 +1003,18 @@ camera2_shot_ext *  RequestManager::GetInternalShotExt(int index)
 
 int     RequestManager::FindFrameCnt(struct camera2_shot_ext * shot_ext)
 {
-    Mutex::Autolock lock(m_requestMutex);
     int i;
 
-    if (m_numOfEntries == 0) {
+    if (GetNumEntries() == 0) {
         CAM_LOGD("DBG(%s): No Entry found", __FUNCTION__);
         return -1;
     }
 
-    for (i = 0 ; i < NUM_MAX_REQUEST_MGR_ENTRY ; i++) {
-        if(entries[i].internal_shot.shot.ctl.request.frameCount != shot_ext->shot.ctl.request.frameCount)
-            continue;
-
-        if (entries[i].status == REQUESTED) {
-            entries[i].status = CAPTURED;
+    i = FindEntryIndexByFrameCnt(shot_ext->shot.ctl.request.frameCount);
+    if (i != -1) {
+        if (android_atomic_cmpxchg(REQUESTED, CAPTURED, &entries[i].status) == 0)
             return entries[i].internal_shot.shot.ctl.request.frameCount;
-        }
         CAM_LOGE("ERR(%s): frameCount(%d), index(%d), status(%d)", __FUNCTION__, shot_ext->shot.ctl.request.frameCount, i, entries[i].status);
-
     }
     CAM_LOGD("(%s): No Entry found frame count(%d)", __FUNCTION__, shot_ext->shot.ctl.request.frameCount);
 
@@ -902,7 +1044,7 @@ void RequestManager::Dump(void)
     ALOGD("## Dump  totalentry(%d), insert(%d), processing(%d), frame(%d)",
     m_numOfEntries,m_entryInsertionIndex,m_entryProcessingIndex, m_entryFrameOutputIndex);
 
-    for (i = 0 ; i < NUM_MAX_REQUEST_MGR_ENTRY ; i++) {
+    for (i = 0 ; i < m_depth ; i++) {
         currentEntry =  &(entries[i]);
         ALOGD("[%2d] status[%d] frameCnt[%3d] numOutput[%d] outstream[0]-%x ", i,
         currentEntry->status, currentEntry->internal_shot.shot.ctl.request.frameCount,
@@ -914,7 +1056,7 @@ void RequestManager::Dump(void)
 int     RequestManager::GetNextIndex(int index)
 {
     index++;
-    if (index >= NUM_MAX_REQUEST_MGR_ENTRY)
+    if (index >= m_depth)
         index = 0;
 
     return index;
@@ -924,7 +1066,7 @@ int     RequestManager::GetPrevIndex(int index)
 {
     index--;
     if (index < 0)
-        index = NUM_MAX_REQUEST_MGR_ENTRY-1;
+        index = m_depth-1;
 
     return index;
 }
@@ -938,6 +1080,7 @@ ExynosCameraHWInterface2::ExynosCameraHWInterface2(int cameraId, camera2_device_
             m_isRequestQueueNull(true),
             m_isIspStarted(false),
             m_ionCameraClient(0),
+            m_memoryPool(NULL),
             m_zoomRatio(1),
             m_scp_closing(false),
             m_scp_closed(false),
@@ -983,9 +1126,12 @@ ExynosCameraHWInterface2::ExynosCameraHWInterface2(int cameraId, camera2_device_
     m_ionCameraClient = createIonClient(m_ionCameraClient);
     if(m_ionCameraClient == 0)
         ALOGE("ERR(%s):Fail on ion_client_create", __FUNCTION__);
+    else
+        m_memoryPool = new ExynosCameraMemoryPool(m_ionCameraClient);
 
 
     m_BayerManager = new BayerBufManager();
+    m_zslManager = new ZslBufManager();
     m_mainThread    = new MainThread(this);
     m_requestManager = new RequestManager((SignalDrivenThread*)(m_mainThread.get()));
     *openInvalid = InitializeISPChain();
@@ -1019,6 +1165,18 @@ ExynosCameraHWInterface2::ExynosCameraHWInterface2(int cameraId, camera2_device_
         m_sensorThread->Start("SensorThread", PRIORITY_DEFAULT, 0);
         ALOGV("DEBUG(%s): created sensorthread ", __FUNCTION__);
 
+        for (int i = 0 ; i < NUM_JPEG_JOBS ; i++) {
+            m_jpegJobs[i].status = JPEG_JOB_FREE;
+            initCameraMemory(&m_jpegJobs[i].resizeBuf, 1);
+        }
+        m_jpegSubmitSeq = 0;
+        m_jpegOutputSeq = 0;
+        for (int i = 0 ; i < NUM_JPEG_WORKERS ; i++) {
+            m_jpegWorkers[i] = new JpegWorkerThread(this, i);
+            m_jpegWorkers[i]->m_jpegEnc.setMemoryPool(m_memoryPool);
+            m_jpegWorkers[i]->Start("JpegWorkerThread", PRIORITY_DEFAULT, 0);
+        }
+
         for (int i = 0 ; i < STREAM_ID_LAST+1 ; i++)
             m_subStreams[i].type =  SUBSTREAM_TYPE_NONE;
         CSC_METHOD cscMethod = CSC_METHOD_HW;
@@ -1086,6 +1244,11 @@ void ExynosCameraHWInterface2::release()
         m_mainThread->release();
     }
 
+    for (i = 0 ; i < NUM_JPEG_WORKERS ; i++) {
+        if (m_jpegWorkers[i] != NULL)
+            m_jpegWorkers[i]->release();
+    }
+
     if (m_exynosPictureCSC)
         csc_deinit(m_exynosPictureCSC);
     m_exynosPictureCSC = NULL;
@@ -1126,6 +1289,18 @@ void ExynosCameraHWInterface2::release()
         m_mainThread = NULL;
     }
 
+    for (i = 0 ; i < NUM_JPEG_WORKERS ; i++) {
+        if (m_jpegWorkers[i] != NULL) {
+            while (!m_jpegWorkers[i]->IsTerminated())
+                usleep(SIG_WAITING_TICK);
+            // thumbnail buffers go back to the pool while it still exists
+            m_jpegWorkers[i]->m_jpegEnc.destroy();
+            m_jpegWorkers[i]->m_jpegEnc.setMemoryPool(NULL);
+            m_jpegWorkers[i] = NULL;
+        }
+    }
+    m_jpegFreeJobBuffers();
+
     if (m_requestManager != NULL) {
         delete m_requestManager;
         m_requestManager = NULL;
@@ -1135,6 +1310,11 @@ void ExynosCameraHWInterface2::release()
         delete m_BayerManager;
         m_BayerManager = NULL;
     }
+
+    if (m_zslManager != NULL) {
+        delete m_zslManager;
+        m_zslManager = NULL;
+    }
     for (i = 0; i < NUM_BAYER_BUFFERS; i++)
         freeCameraMemory(&m_camera_info.sensor.buffer[i], m_camera_info.sensor.planes);
 
@@ -1174,6 +1354,11 @@ void ExynosCameraHWInterface2::release()
     if (res != NO_ERROR ) {
         ALOGE("ERR(%s): exynos_v4l2_close failed(%d)",__FUNCTION__ , res);
     }
+    if (m_memoryPool != NULL) {
+        delete m_memoryPool;
+        m_memoryPool = NULL;
+    }
+
     ALOGV("DEBUG(%s): calling deleteIonClient", __FUNCTION__);
     deleteIonClient(m_ionCameraClient);
 
@@ -1278,7 +1463,8 @@ int ExynosCameraHWInterface2::InitializeISPChain()
         initCameraMemory(&m_camera_info.sensor.buffer[i], m_camera_info.sensor.planes);
         m_camera_info.sensor.buffer[i].size.extS[0] = m_camera_info.sensor.width*m_camera_info.sensor.height*2;
         m_camera_info.sensor.buffer[i].size.extS[1] = 8*1024; // HACK, driver use 8*1024, should be use predefined value
-        allocCameraMemory(m_ionCameraClient, &m_camera_info.sensor.buffer[i], m_camera_info.sensor.planes, 1<<1);
+        // lives for the whole session, nothing to gain from the pool
+        allocCameraMemory(m_ionCameraClient, &m_camera_info.sensor.buffer[i], m_camera_info.sensor.planes, 1<<1, false);
     }
 
     m_camera_info.isp.width = m_camera_info.sensor.width;
@@ -1402,9 +1588,9 @@ void ExynosCameraHWInterface2::StartSCCThread(bool threadExists)
                 m_camera_info.capture.buffer[i].size.extS[0] = m_camera_info.capture.width*m_camera_info.capture.height*2;
 #ifdef ENABLE_FRAME_SYNC
                 m_camera_info.capture.buffer[i].size.extS[1] = 4*1024; // HACK, driver use 4*1024, should be use predefined value
-                allocCameraMemory(m_ionCameraClient, &m_camera_info.capture.buffer[i], m_camera_info.capture.planes, 1<<1);
+                allocCameraMemory(m_ionCameraClient, &m_camera_info.capture.buffer[i], m_camera_info.capture.planes, 1<<1, false);
 #else
-                allocCameraMemory(m_ionCameraClient, &m_camera_info.capture.buffer[i], m_camera_info.capture.planes);
+                allocCameraMemory(m_ionCameraClient, &m_camera_info.capture.buffer[i], m_camera_info.capture.planes, 0, false);
 #endif
                 m_sccLocalBuffer[i] = m_camera_info.capture.buffer[i];
             }
@@ -2032,6 +2218,7 @@ int ExynosCameraHWInterface2::registerStreamBuffers(uint32_t stream_id,
                     targetParms->svcBufStatus[i]  = ON_SERVICE;
                     targetParms->svcBuffers[i]    = currentBuf;
                     targetParms->svcBufHandle[i]  = registeringBuffers[i];
+                    targetParms->svcBufStride     = priv_handle->stride;
                 }
             }
         }
@@ -2121,7 +2308,9 @@ int ExynosCameraHWInterface2::registerStreamBuffers(uint32_t stream_id,
 #ifdef ENABLE_FRAME_SYNC
                     /* add plane for metadata*/
                     metaBuf.size.extS[0] = 4*1024;
-                    allocCameraMemory(m_ionCameraClient , &metaBuf, 1, 1<<0);
+                    /* a pooled plane still holds the last stream's shot */
+                    if (allocCameraMemory(m_ionCameraClient , &metaBuf, 1, 1<<0) == 0)
+                        memset(metaBuf.virt.extP[0], 0, metaBuf.size.extS[0]);
 
                     v4l2_buf.length += targetStreamParms->metaPlanes;
                     v4l2_buf.m.planes[v4l2_buf.length-1].m.fd = metaBuf.fd.extFd[0];
@@ -2182,9 +2371,8 @@ int ExynosCameraHWInterface2::releaseStream(uint32_t stream_id)
             }
         }
     } else if (stream_id == STREAM_ID_JPEG) {
-        if (m_resizeBuf.size.s != 0) {
-            freeCameraMemory(&m_resizeBuf, 1);
-        }
+        m_jpegWaitIdle();
+        m_jpegFreeJobBuffers();
         memset(&m_subStreams[stream_id], 0, sizeof(substream_parameters_t));
 
         targetStream = (StreamThread*)(m_streamThreads[1].get());
@@ -2328,6 +2516,7 @@ int ExynosCameraHWInterface2::allocateReprocessStreamFromStream(
     m_reprocessStreamId = *stream_id;
     m_reprocessOps = reprocess_stream_ops;
     m_reprocessOutputStreamId = output_stream_id;
+    m_zslManager->Reset();
     return 0;
 }
 
@@ -2338,6 +2527,7 @@ int ExynosCameraHWInterface2::releaseReprocessStream(uint32_t stream_id)
         m_reprocessStreamId = 0;
         m_reprocessOps = NULL;
         m_reprocessOutputStreamId = 0;
+        m_zslManager->Reset();
         return 0;
     }
     return 1;
@@ -2385,6 +2575,14 @@ int ExynosCameraHWInterface2::getMetadataVendorTagOps(vendor_tag_query_ops_t **o
 int ExynosCameraHWInterface2::dump(int fd)
 {
     ALOGV("DEBUG(%s):", __FUNCTION__);
+    if (m_memoryPool != NULL) {
+        char buffer[128];
+
+        snprintf(buffer, sizeof(buffer), "ion pool: hit(%d) miss(%d) resident(%d) idle(%d)\n",
+            m_memoryPool->GetHitCount(), m_memoryPool->GetMissCount(),
+            m_memoryPool->GetResidentSize(), m_memoryPool->GetIdleSize());
+        write(fd, buffer, strlen(buffer));
+    }
     return 0;
 }
 
@@ -2704,6 +2902,104 @@ int     BayerBufManager::GetNextIndex(int index)
     return index;
 }
 
+ZslBufManager::ZslBufManager()
+{
+    Reset();
+}
+
+ZslBufManager::~ZslBufManager()
+{
+    ALOGV("%s", __FUNCTION__);
+}
+
+void    ZslBufManager::Reset()
+{
+    Mutex::Autolock lock(m_lock);
+    m_head = 0;
+    m_count = 0;
+    for (int i = 0 ; i < NUM_ZSL_ENTRIES ; i++) {
+        m_entries[i].frameCnt = -1;
+        m_entries[i].svcBufIndex = -1;
+        m_entries[i].timeStamp = 0;
+    }
+}
+
+void    ZslBufManager::RegisterShot(struct camera2_shot_ext *shot_ext, nsecs_t timeStamp)
+{
+    Mutex::Autolock lock(m_lock);
+    zsl_buf_entry_t *entry = &(m_entries[m_head]);
+
+    entry->frameCnt = shot_ext->shot.ctl.request.frameCount;
+    entry->svcBufIndex = -1;
+    entry->timeStamp = timeStamp;
+    memcpy(&(entry->shot), shot_ext, sizeof(struct camera2_shot_ext));
+    m_head = (m_head + 1) % NUM_ZSL_ENTRIES;
+    if (m_count < NUM_ZSL_ENTRIES)
+        m_count++;
+    ALOGV("DEBUG(%s): frameCnt(%d) timestamp(%lld) count(%d)", __FUNCTION__,
+        entry->frameCnt, timeStamp, m_count);
+}
+
+void    ZslBufManager::MarkSvcBuffer(int frameCnt, int svcBufIndex)
+{
+    Mutex::Autolock lock(m_lock);
+
+    for (int i = 0 ; i < NUM_ZSL_ENTRIES ; i++) {
+        // the buffer no longer holds what it was tagged with before
+        if (m_entries[i].svcBufIndex == svcBufIndex)
+            m_entries[i].svcBufIndex = -1;
+    }
+    for (int i = 0 ; i < NUM_ZSL_ENTRIES ; i++) {
+        if (m_entries[i].frameCnt == frameCnt) {
+            m_entries[i].svcBufIndex = svcBufIndex;
+            return;
+        }
+    }
+    ALOGV("DEBUG(%s): no ISP result for frameCnt(%d)", __FUNCTION__, frameCnt);
+}
+
+int     ZslBufManager::FindNearest(nsecs_t timeStamp)
+{
+    int index = -1;
+    nsecs_t diff, bestDiff = 0;
+
+    for (int i = 0 ; i < NUM_ZSL_ENTRIES ; i++) {
+        if (m_entries[i].frameCnt == -1)
+            continue;
+        diff = m_entries[i].timeStamp - timeStamp;
+        if (diff < 0)
+            diff = -diff;
+        if (index == -1 || diff < bestDiff) {
+            index = i;
+            bestDiff = diff;
+        }
+    }
+    return index;
+}
+
+bool    ZslBufManager::SelectFrame(int svcBufIndex, nsecs_t timeStamp, zsl_buf_entry_t *selected)
+{
+    Mutex::Autolock lock(m_lock);
+    int index = -1;
+
+    if (m_count == 0)
+        return false;
+
+    for (int i = 0 ; i < NUM_ZSL_ENTRIES ; i++) {
+        if (m_entries[i].svcBufIndex == svcBufIndex && m_entries[i].frameCnt != -1) {
+            index = i;
+            break;
+        }
+    }
+    if (index == -1)
+        index = FindNearest(timeStamp);
+    if (index == -1)
+        return false;
+
+    memcpy(selected, &(m_entries[index]), sizeof(zsl_buf_entry_t));
+    return true;
+}
+
 void ExynosCameraHWInterface2::m_mainThreadFunc(SignalDrivenThread * self)
 {
     camera_metadata_t *currentRequest = NULL;
@@ -2741,9 +3037,11 @@ void ExynosCameraHWInterface2::m_mainThreadFunc(SignalDrivenThread * self)
                 if (m_requestManager->IsVdisEnable())
                     m_vdisBubbleCnt = 1;
             }
+            else if (m_requestManager->RegisterRequest(currentRequest, &afMode, afRegion) != 0) {
+                ALOGE("ERR(%s): RegisterRequest failed, returning request to service", __FUNCTION__);
+                m_requestQueueOps->free_request(m_requestQueueOps, currentRequest);
+            }
             else {
-                m_requestManager->RegisterRequest(currentRequest, &afMode, afRegion);
-
                 SetAfMode((enum aa_afmode)afMode);
                 SetAfRegion(afRegion);
 
@@ -3454,6 +3752,10 @@ void ExynosCameraHWInterface2::m_sensorThreadFunc(SignalDrivenThread * self)
                 shot_ext->shot.dm.aa.afMode = AA_AFMODE_CONTINUOUS_PICTURE;
 
             if (matchedFrameCnt != -1 && m_nightCaptureCnt == 0 && (m_ctlInfo.flash.m_flashCnt < IS_FLASH_STATE_CAPTURE)) {
+                // keep the result of full-size frames handed out for ZSL
+                if (shot_ext->request_scc && (shot_ext->shot.ctl.request.outputStreams[0] & STREAM_MASK_ZSL))
+                    m_zslManager->RegisterShot(shot_ext,
+                        m_requestManager->GetTimestampByFrameCnt(shot_ext->shot.ctl.request.frameCount));
                 m_requestManager->ApplyDynamicMetadata(shot_ext);
             }
 
@@ -3668,15 +3970,9 @@ void ExynosCameraHWInterface2::m_streamBufferInit(SignalDrivenThread *self)
                 subParms->svcBufIndex = 0;
             }
             if (subParms->type == SUBSTREAM_TYPE_JPEG) {
-                m_resizeBuf.size.extS[0] = ALIGN(subParms->width, 16) * ALIGN(subParms->height, 16) * 2;
-                m_resizeBuf.size.extS[1] = 0;
-                m_resizeBuf.size.extS[2] = 0;
-
-                if (allocCameraMemory(m_ionCameraClient, &m_resizeBuf, 1) == -1) {
-                    ALOGE("ERR(%s): Failed to allocate resize buf", __FUNCTION__);
-                }
+                m_jpegAllocJobBuffers(ALIGN(subParms->width, 16) * ALIGN(subParms->height, 16) * 2);
             }
-            if (subParms->type == SUBSTREAM_TYPE_PRVCB) {
+            if (subParms->type == SUBSTREAM_TYPE_PRVCB && prvcb_needs_row_copy(subParms)) {
                 m_getAlignedYUVSize(HAL_PIXEL_FORMAT_2_V4L2_PIX(subParms->internalFormat), subParms->width,
                 subParms->height, &m_previewCbBuf);
 
@@ -3788,6 +4084,14 @@ void ExynosCameraHWInterface2::m_streamFunc_direct(SignalDrivenThread *self)
 
         if (!found) return;
 
+        zsl_buf_entry_t zslFrame;
+        if (m_zslManager->SelectFrame(checkingIndex, m_jpegMetadata.shot.dm.sensor.timeStamp, &zslFrame)) {
+            ALOGV("DEBUG(%s): [reprocess] using ISP result of frameCnt(%d) timestamp(%lld)",
+                __FUNCTION__, zslFrame.frameCnt, zslFrame.timeStamp);
+            memcpy(&(m_jpegMetadata.shot.dm), &(zslFrame.shot.shot.dm), sizeof(struct camera2_dm));
+            m_jpegMetadata.shot.dm.sensor.timeStamp = zslFrame.timeStamp;
+        }
+
         for (int i = 0 ; i < NUM_MAX_SUBSTREAM ; i++) {
             if (selfThread->m_attachedSubStreams[i].streamId == -1)
                 continue;
@@ -3889,6 +4193,8 @@ void ExynosCameraHWInterface2::m_streamFunc_direct(SignalDrivenThread *self)
                     res = selfStreamParms->streamOps->enqueue_buffer(selfStreamParms->streamOps,
                                 frameTimeStamp,
                                 &(selfStreamParms->svcBufHandle[selfStreamParms->bufIndex]));
+                    if (res == 0)
+                        m_zslManager->MarkSvcBuffer(frame->rcount, selfStreamParms->bufIndex);
                 }
                 else {
                     res = selfStreamParms->streamOps->cancel_buffer(selfStreamParms->streamOps,
@@ -4117,39 +4423,60 @@ void ExynosCameraHWInterface2::m_streamThreadFunc(SignalDrivenThread * self)
 }
 int ExynosCameraHWInterface2::m_jpegCreator(StreamThread *selfThread, ExynosBuffer *srcImageBuf, nsecs_t frameTimeStamp)
 {
-    Mutex::Autolock lock(m_jpegEncoderLock);
     stream_parameters_t     *selfStreamParms = &(selfThread->m_parameters);
     substream_parameters_t  *subParms        = &m_subStreams[STREAM_ID_JPEG];
-    status_t    res;
-    ExynosRect jpegRect;
     bool found = false;
     int srcW, srcH, srcCropX, srcCropY;
     int pictureW, pictureH, pictureFramesize = 0;
     int pictureFormat;
     int cropX, cropY, cropW, cropH = 0;
-    ExynosBuffer resizeBufInfo;
     ExynosRect   m_jpegPictureRect;
-    buffer_handle_t * buf = NULL;
-    camera2_jpeg_blob * jpegBlob = NULL;
-    int jpegBufSize = 0;
+    jpeg_job_t * job = NULL;
 
-    ALOGV("DEBUG(%s): index(%d)",__FUNCTION__, subParms->svcBufIndex);
-    for (int i = 0 ; subParms->numSvcBuffers ; i++) {
-        if (subParms->svcBufStatus[subParms->svcBufIndex] == ON_HAL) {
-            found = true;
-            break;
+    {
+        Mutex::Autolock lock(m_jpegEncoderLock);
+
+        // the SCC stream only stalls here while the workers hold every job slot or svc buffer
+        for (;;) {
+            job = NULL;
+            for (int i = 0 ; i < NUM_JPEG_JOBS ; i++) {
+                if (m_jpegJobs[i].status == JPEG_JOB_FREE) {
+                    job = &m_jpegJobs[i];
+                    break;
+                }
+            }
+            found = false;
+            for (int i = 0 ; i < subParms->numSvcBuffers ; i++) {
+                if (subParms->svcBufStatus[subParms->svcBufIndex] == ON_HAL) {
+                    found = true;
+                    break;
+                }
+                subParms->svcBufIndex++;
+                if (subParms->svcBufIndex >= subParms->numSvcBuffers)
+                    subParms->svcBufIndex = 0;
+            }
+            if (job != NULL && found)
+                break;
+            if (m_jpegEncodingCount == 0) {
+                ALOGE("(%s): cannot find free svc buffer", __FUNCTION__);
+                subParms->svcBufIndex++;
+                return 1;
+            }
+            if (m_jpegJobCondition.waitRelative(m_jpegEncoderLock, JPEG_JOB_WAIT_TIMEOUT) != NO_ERROR) {
+                ALOGE("ERR(%s): jpeg workers stalled, job(%p) svcbuf(%d)", __FUNCTION__, job, found);
+                return 1;
+            }
         }
-        subParms->svcBufIndex++;
-        if (subParms->svcBufIndex >= subParms->numSvcBuffers)
-            subParms->svcBufIndex = 0;
-    }
-    if (!found) {
-        ALOGE("(%s): cannot find free svc buffer", __FUNCTION__);
-        subParms->svcBufIndex++;
-        return 1;
-    }
+        ALOGV("DEBUG(%s): index(%d)",__FUNCTION__, subParms->svcBufIndex);
 
-    m_jpegEncodingCount++;
+        job->status = JPEG_JOB_PREPARING;
+        job->seq = m_jpegSubmitSeq++;
+        job->svcBufIndex = subParms->svcBufIndex;
+        job->timeStamp = frameTimeStamp;
+        memcpy(&job->shot, &m_jpegMetadata, sizeof(struct camera2_shot_ext));
+        subParms->svcBufStatus[job->svcBufIndex] = ON_JPEG_ENCODER;
+        m_jpegEncodingCount++;
+    }
 
     m_getRatioSize(selfStreamParms->width, selfStreamParms->height,
                     m_streamThreads[0]->m_parameters.width, m_streamThreads[0]->m_parameters.height,
@@ -4172,6 +4499,7 @@ int ExynosCameraHWInterface2::m_jpegCreator(StreamThread *selfThread, ExynosBuff
     pictureFormat = V4L2_PIX_FMT_YUYV;
     pictureFramesize = FRAME_SIZE(V4L2_PIX_2_HAL_PIXEL_FORMAT(pictureFormat), pictureW, pictureH);
 
+    // the scale has to finish before the SCC buffer goes back to the driver
     if (m_exynosPictureCSC) {
         float zoom_w = 0, zoom_h = 0;
         if (m_zoomRatio == 0)
@@ -4210,10 +4538,10 @@ int ExynosCameraHWInterface2::m_jpegCreator(StreamThread *selfThread, ExynosBuff
                            (void **)&srcImageBuf->fd.fd);
 
         csc_set_dst_buffer(m_exynosPictureCSC,
-                           (void **)&m_resizeBuf.fd.fd);
+                           (void **)&job->resizeBuf.fd.fd);
         for (int i = 0 ; i < 3 ; i++)
-            ALOGV("DEBUG(%s): m_resizeBuf.virt.extP[%d]=%d m_resizeBuf.size.extS[%d]=%d",
-                __FUNCTION__, i, m_resizeBuf.fd.extFd[i], i, m_resizeBuf.size.extS[i]);
+            ALOGV("DEBUG(%s): resizeBuf.virt.extP[%d]=%d resizeBuf.size.extS[%d]=%d",
+                __FUNCTION__, i, job->resizeBuf.fd.extFd[i], i, job->resizeBuf.size.extS[i]);
 
         if (csc_convert(m_exynosPictureCSC) != 0)
             ALOGE("ERR(%s): csc_convert() fail", __FUNCTION__);
@@ -4223,55 +4551,99 @@ int ExynosCameraHWInterface2::m_jpegCreator(StreamThread *selfThread, ExynosBuff
         ALOGE("ERR(%s): m_exynosPictureCSC == NULL", __FUNCTION__);
     }
 
-    resizeBufInfo = m_resizeBuf;
+    job->yuvBuf = job->resizeBuf;
 
-    m_getAlignedYUVSize(V4L2_PIX_FMT_NV16, m_jpegPictureRect.w, m_jpegPictureRect.h, &m_resizeBuf);
+    m_getAlignedYUVSize(V4L2_PIX_FMT_NV16, m_jpegPictureRect.w, m_jpegPictureRect.h, &job->yuvBuf);
 
     for (int i = 1; i < 3; i++) {
-        if (m_resizeBuf.size.extS[i] != 0)
-            m_resizeBuf.fd.extFd[i] = m_resizeBuf.fd.extFd[i-1] + m_resizeBuf.size.extS[i-1];
+        if (job->yuvBuf.size.extS[i] != 0)
+            job->yuvBuf.fd.extFd[i] = job->yuvBuf.fd.extFd[i-1] + job->yuvBuf.size.extS[i-1];
 
-        ALOGV("(%s): m_resizeBuf.size.extS[%d] = %d", __FUNCTION__, i, m_resizeBuf.size.extS[i]);
+        ALOGV("(%s): yuvBuf.size.extS[%d] = %d", __FUNCTION__, i, job->yuvBuf.size.extS[i]);
     }
 
-    jpegRect.w = m_jpegPictureRect.w;
-    jpegRect.h = m_jpegPictureRect.h;
-    jpegRect.colorFormat = V4L2_PIX_FMT_NV16;
-
-    for (int j = 0 ; j < 3 ; j++)
-        ALOGV("DEBUG(%s): dest buf node  fd.extFd[%d]=%d size=%d virt=%x ",
-            __FUNCTION__, j, subParms->svcBuffers[subParms->svcBufIndex].fd.extFd[j],
-            (unsigned int)subParms->svcBuffers[subParms->svcBufIndex].size.extS[j],
-            (unsigned int)subParms->svcBuffers[subParms->svcBufIndex].virt.extP[j]);
+    job->rect.w = m_jpegPictureRect.w;
+    job->rect.h = m_jpegPictureRect.h;
+    job->rect.colorFormat = V4L2_PIX_FMT_NV16;
 
-    jpegBufSize = subParms->svcBuffers[subParms->svcBufIndex].size.extS[0];
-    if (yuv2Jpeg(&m_resizeBuf, &subParms->svcBuffers[subParms->svcBufIndex], &jpegRect) == false) {
-        ALOGE("ERR(%s):yuv2Jpeg() fail", __FUNCTION__);
-    } else {
-        m_resizeBuf = resizeBufInfo;
+    {
+        Mutex::Autolock lock(m_jpegEncoderLock);
+        job->status = JPEG_JOB_QUEUED;
+    }
+    m_jpegWorkers[job->seq % NUM_JPEG_WORKERS]->SetSignal(SIGNAL_JPEG_ENCODE_START);
+    ALOGV("DEBUG(%s): streamthread[%d] queued jpeg job seq(%d) frameCnt(%d)", __FUNCTION__,
+        selfThread->m_index, job->seq, job->shot.shot.ctl.request.frameCount);
+    return 0;
+}
 
-        int jpegSize = subParms->svcBuffers[subParms->svcBufIndex].size.s;
-        ALOGD("(%s): (%d x %d) jpegbuf size(%d) encoded size(%d)", __FUNCTION__,
-            m_jpegPictureRect.w, m_jpegPictureRect.h, jpegBufSize, jpegSize);
-        char * jpegBuffer = (char*)(subParms->svcBuffers[subParms->svcBufIndex].virt.extP[0]);
-        jpegBlob = (camera2_jpeg_blob*)(&jpegBuffer[jpegBufSize - sizeof(camera2_jpeg_blob)]);
+jpeg_job_t * ExynosCameraHWInterface2::m_jpegTakeJob(void)
+{
+    Mutex::Autolock lock(m_jpegEncoderLock);
+    jpeg_job_t * job = NULL;
 
-        if (jpegBuffer[jpegSize-1] == 0)
-            jpegSize--;
-        jpegBlob->jpeg_size = jpegSize;
-        jpegBlob->jpeg_blob_id = CAMERA2_JPEG_BLOB_ID;
+    for (int i = 0 ; i < NUM_JPEG_JOBS ; i++) {
+        if (m_jpegJobs[i].status != JPEG_JOB_QUEUED)
+            continue;
+        if (job == NULL || m_jpegJobs[i].seq < job->seq)
+            job = &m_jpegJobs[i];
     }
-    subParms->svcBuffers[subParms->svcBufIndex].size.extS[0] = jpegBufSize;
-    res = subParms->streamOps->enqueue_buffer(subParms->streamOps, frameTimeStamp, &(subParms->svcBufHandle[subParms->svcBufIndex]));
+    if (job != NULL)
+        job->status = JPEG_JOB_ENCODING;
+    return job;
+}
 
-    ALOGV("DEBUG(%s): streamthread[%d] enqueue_buffer index(%d) to svc done res(%d)",
-            __FUNCTION__, selfThread->m_index, subParms->svcBufIndex, res);
-    if (res == 0) {
-        subParms->svcBufStatus[subParms->svcBufIndex] = ON_SERVICE;
-        subParms->numSvcBufsInHal--;
-    }
-    else {
-        subParms->svcBufStatus[subParms->svcBufIndex] = ON_HAL;
+void ExynosCameraHWInterface2::m_jpegDeliverJobs(void)
+{
+    substream_parameters_t  *subParms        = &m_subStreams[STREAM_ID_JPEG];
+    status_t    res;
+    buffer_handle_t * buf = NULL;
+    camera2_jpeg_blob * jpegBlob = NULL;
+    int jpegBufSize = 0;
+    jpeg_job_t * job;
+
+    Mutex::Autolock lock(m_jpegEncoderLock);
+
+    // captures go out in the order the SCC stream handed them over
+    for (;;) {
+        job = NULL;
+        for (int i = 0 ; i < NUM_JPEG_JOBS ; i++) {
+            if (m_jpegJobs[i].status == JPEG_JOB_DONE && m_jpegJobs[i].seq == m_jpegOutputSeq) {
+                job = &m_jpegJobs[i];
+                break;
+            }
+        }
+        if (job == NULL)
+            break;
+
+        jpegBufSize = job->jpegBufSize;
+        if (job->encoded) {
+            int jpegSize = subParms->svcBuffers[job->svcBufIndex].size.s;
+            ALOGD("(%s): (%d x %d) jpegbuf size(%d) encoded size(%d) frameCnt(%d)", __FUNCTION__,
+                job->rect.w, job->rect.h, jpegBufSize, jpegSize, job->shot.shot.ctl.request.frameCount);
+            char * jpegBuffer = (char*)(subParms->svcBuffers[job->svcBufIndex].virt.extP[0]);
+            jpegBlob = (camera2_jpeg_blob*)(&jpegBuffer[jpegBufSize - sizeof(camera2_jpeg_blob)]);
+
+            if (jpegBuffer[jpegSize-1] == 0)
+                jpegSize--;
+            jpegBlob->jpeg_size = jpegSize;
+            jpegBlob->jpeg_blob_id = CAMERA2_JPEG_BLOB_ID;
+        }
+        subParms->svcBuffers[job->svcBufIndex].size.extS[0] = jpegBufSize;
+        res = subParms->streamOps->enqueue_buffer(subParms->streamOps, job->timeStamp,
+                &(subParms->svcBufHandle[job->svcBufIndex]));
+
+        ALOGV("DEBUG(%s): enqueue_buffer index(%d) seq(%d) to svc done res(%d)",
+                __FUNCTION__, job->svcBufIndex, job->seq, res);
+        if (res == 0) {
+            subParms->svcBufStatus[job->svcBufIndex] = ON_SERVICE;
+            subParms->numSvcBufsInHal--;
+        }
+        else {
+            subParms->svcBufStatus[job->svcBufIndex] = ON_HAL;
+        }
+        job->status = JPEG_JOB_FREE;
+        m_jpegOutputSeq++;
+        m_jpegEncodingCount--;
     }
 
     while (subParms->numSvcBufsInHal <= subParms->minUndequedBuffer)
@@ -4283,7 +4655,7 @@ int ExynosCameraHWInterface2::m_jpegCreator(StreamThread *selfThread, ExynosBuff
 
         res = subParms->streamOps->dequeue_buffer(subParms->streamOps, &buf);
         if (res != NO_ERROR || buf == NULL) {
-            ALOGV("DEBUG(%s): jpeg stream(%d) dequeue_buffer fail res(%d)",__FUNCTION__ , selfThread->m_index,  res);
+            ALOGV("DEBUG(%s): jpeg stream dequeue_buffer fail res(%d)",__FUNCTION__ , res);
             break;
         }
         const private_handle_t *priv_handle = reinterpret_cast<const private_handle_t *>(*buf);
@@ -4313,8 +4685,76 @@ int ExynosCameraHWInterface2::m_jpegCreator(StreamThread *selfThread, ExynosBuff
                 subParms->svcBufIndex,  subParms->svcBufStatus[subParms->svcBufIndex]);
         }
     }
-    m_jpegEncodingCount--;
-    return 0;
+    m_jpegJobCondition.broadcast();
+}
+
+void ExynosCameraHWInterface2::m_jpegWaitIdle(void)
+{
+    Mutex::Autolock lock(m_jpegEncoderLock);
+
+    // the job buffers are freed next, so every job has to be delivered first
+    while (m_jpegEncodingCount > 0) {
+        if (m_jpegJobCondition.waitRelative(m_jpegEncoderLock, JPEG_JOB_WAIT_TIMEOUT) != NO_ERROR)
+            ALOGW("(%s): still waiting for %d jpeg jobs", __FUNCTION__, m_jpegEncodingCount);
+    }
+}
+
+void ExynosCameraHWInterface2::m_jpegAllocJobBuffers(unsigned int size)
+{
+    for (int i = 0 ; i < NUM_JPEG_JOBS ; i++) {
+        if (m_jpegJobs[i].resizeBuf.size.s != 0)
+            freeCameraMemory(&m_jpegJobs[i].resizeBuf, 1);
+        initCameraMemory(&m_jpegJobs[i].resizeBuf, 1);
+        m_jpegJobs[i].resizeBuf.size.extS[0] = size;
+        m_jpegJobs[i].resizeBuf.size.extS[1] = 0;
+        m_jpegJobs[i].resizeBuf.size.extS[2] = 0;
+
+        if (allocCameraMemory(m_ionCameraClient, &m_jpegJobs[i].resizeBuf, 1) == -1) {
+            ALOGE("ERR(%s): Failed to allocate resize buf[%d]", __FUNCTION__, i);
+        }
+    }
+}
+
+void ExynosCameraHWInterface2::m_jpegFreeJobBuffers(void)
+{
+    for (int i = 0 ; i < NUM_JPEG_JOBS ; i++) {
+        if (m_jpegJobs[i].resizeBuf.size.s != 0)
+            freeCameraMemory(&m_jpegJobs[i].resizeBuf, 1);
+        initCameraMemory(&m_jpegJobs[i].resizeBuf, 1);
+    }
+}
+
+void ExynosCameraHWInterface2::m_jpegWorkerThreadFunc(SignalDrivenThread * self)
+{
+    uint32_t        currentSignal   = self->GetProcessingSignal();
+    JpegWorkerThread *  selfThread  = ((JpegWorkerThread*)self);
+    substream_parameters_t  *subParms = &m_subStreams[STREAM_ID_JPEG];
+    jpeg_job_t *    job;
+
+    if (currentSignal & SIGNAL_THREAD_RELEASE) {
+        ALOGV("(%s): jpegworker[%d] SIGNAL_THREAD_RELEASE", __FUNCTION__, selfThread->m_index);
+        if (selfThread->m_jpegEnc.flagCreate() == true)
+            selfThread->m_jpegEnc.destroy();
+        selfThread->SetSignal(SIGNAL_THREAD_TERMINATE);
+        return;
+    }
+
+    if (currentSignal & SIGNAL_JPEG_ENCODE_START) {
+        while ((job = m_jpegTakeJob()) != NULL) {
+            ALOGV("DEBUG(%s): jpegworker[%d] encoding seq(%d) frameCnt(%d)", __FUNCTION__,
+                selfThread->m_index, job->seq, job->shot.shot.ctl.request.frameCount);
+            job->jpegBufSize = subParms->svcBuffers[job->svcBufIndex].size.extS[0];
+            job->encoded = yuv2Jpeg(&selfThread->m_jpegEnc, &job->yuvBuf,
+                                &subParms->svcBuffers[job->svcBufIndex], &job->rect, &job->shot);
+            if (job->encoded == false)
+                ALOGE("ERR(%s):yuv2Jpeg() fail", __FUNCTION__);
+            {
+                Mutex::Autolock lock(m_jpegEncoderLock);
+                job->status = JPEG_JOB_DONE;
+            }
+            m_jpegDeliverJobs();
+        }
+    }
 }
 
 int ExynosCameraHWInterface2::m_recordCreator(StreamThread *selfThread, ExynosBuffer *srcImageBuf, nsecs_t frameTimeStamp)
@@ -4463,93 +4903,87 @@ int ExynosCameraHWInterface2::m_prvcbCreator(StreamThread *selfThread, ExynosBuf
         return 1;
     }
 
-    if (subParms->format == HAL_PIXEL_FORMAT_YCrCb_420_SP) {
-        if (m_exynosVideoCSC) {
-            int previewCbW = subParms->width, previewCbH = subParms->height;
-            int cropX, cropY, cropW, cropH = 0;
-            int previewW = selfStreamParms->width, previewH = selfStreamParms->height;
-            m_getRatioSize(previewW, previewH,
-                           previewCbW, previewCbH,
-                           &cropX, &cropY,
-                           &cropW, &cropH,
+    if (m_exynosVideoCSC) {
+        int previewCbW = subParms->width, previewCbH = subParms->height;
+        int previewW = selfStreamParms->width, previewH = selfStreamParms->height;
+        int stride = subParms->svcBufStride;
+        bool rowCopy = prvcb_needs_row_copy(subParms);
+
+        m_getRatioSize(previewW, previewH,
+                       previewCbW, previewCbH,
+                       &cropX, &cropY,
+                       &cropW, &cropH,
+                       0);
+
+        ALOGV("DEBUG(%s):cropX = %d, cropY = %d, cropW = %d, cropH = %d",
+                 __FUNCTION__, cropX, cropY, cropW, cropH);
+        csc_set_src_format(m_exynosVideoCSC,
+                           ALIGN(previewW, 32), previewH,
+                           cropX, cropY, cropW, cropH,
+                           selfStreamParms->format,
                            0);
 
-            ALOGV("DEBUG(%s):cropX = %d, cropY = %d, cropW = %d, cropH = %d",
-                     __FUNCTION__, cropX, cropY, cropW, cropH);
-            csc_set_src_format(m_exynosVideoCSC,
-                               ALIGN(previewW, 32), previewH,
-                               cropX, cropY, cropW, cropH,
-                               selfStreamParms->format,
-                               0);
+        csc_set_src_buffer(m_exynosVideoCSC,
+                    (void **)&srcImageBuf->fd.fd);
+
+        if (!rowCopy) {
+            // every plane lands in the service buffer at the gralloc stride
+            csc_set_dst_format(m_exynosVideoCSC,
+                               stride, previewCbH,
+                               0, 0, previewCbW, previewCbH,
+                               subParms->format,
+                               1);
 
+            csc_set_dst_buffer(m_exynosVideoCSC,
+                (void **)(&(subParms->svcBuffers[subParms->svcBufIndex].fd.fd)));
+        }
+        else {
             csc_set_dst_format(m_exynosVideoCSC,
                                previewCbW, previewCbH,
                                0, 0, previewCbW, previewCbH,
                                subParms->internalFormat,
                                1);
 
-            csc_set_src_buffer(m_exynosVideoCSC,
-                        (void **)&srcImageBuf->fd.fd);
-
             csc_set_dst_buffer(m_exynosVideoCSC,
                 (void **)(&(m_previewCbBuf.fd.fd)));
+        }
 
-            if (csc_convert(m_exynosVideoCSC) != 0) {
-                ALOGE("ERR(%s):previewcb csc_convert() fail", __FUNCTION__);
-            }
-            else {
-                ALOGV("(%s):previewcb csc_convert() SUCCESS", __FUNCTION__);
-            }
-            if (previewCbW == ALIGN(previewCbW, 16)) {
-                memcpy(subParms->svcBuffers[subParms->svcBufIndex].virt.extP[0],
-                    m_previewCbBuf.virt.extP[0], previewCbW * previewCbH);
-                memcpy(subParms->svcBuffers[subParms->svcBufIndex].virt.extP[0] + previewCbW * previewCbH,
-                    m_previewCbBuf.virt.extP[1], previewCbW * previewCbH / 2 );
-            }
-            else {
-                // TODO : copy line by line ?
-            }
+        if (csc_convert(m_exynosVideoCSC) != 0) {
+            ALOGE("ERR(%s):previewcb csc_convert() fail", __FUNCTION__);
         }
         else {
-            ALOGE("ERR(%s):m_exynosVideoCSC == NULL", __FUNCTION__);
+            ALOGV("(%s):previewcb csc_convert() SUCCESS", __FUNCTION__);
         }
-    }
-    else if (subParms->format == HAL_PIXEL_FORMAT_YV12) {
-        int previewCbW = subParms->width, previewCbH = subParms->height;
-        int stride = ALIGN(previewCbW, 16);
-        int uv_stride = ALIGN(previewCbW/2, 16);
-        int c_stride = ALIGN(stride / 2, 16);
-
-        if (previewCbW == ALIGN(previewCbW, 32)) {
-            memcpy(subParms->svcBuffers[subParms->svcBufIndex].virt.extP[0],
-                srcImageBuf->virt.extP[0], stride * previewCbH);
-            memcpy(subParms->svcBuffers[subParms->svcBufIndex].virt.extP[0] + stride * previewCbH,
-                srcImageBuf->virt.extP[1], c_stride * previewCbH / 2 );
-            memcpy(subParms->svcBuffers[subParms->svcBufIndex].virt.extP[0] + (stride * previewCbH) + (c_stride * previewCbH / 2),
-                srcImageBuf->virt.extP[2], c_stride * previewCbH / 2 );
-        } else {
+
+        if (rowCopy) {
+            // the scaler wrote rows at a 16 pixel aligned stride
+            int srcStride = ALIGN(previewCbW, 16);
+            int c_stride = ALIGN(stride / 2, 16);
             char * dstAddr = (char *)(subParms->svcBuffers[subParms->svcBufIndex].virt.extP[0]);
-            char * srcAddr = (char *)(srcImageBuf->virt.extP[0]);
+            char * srcAddr = (char *)(m_previewCbBuf.virt.extP[0]);
             for (int i = 0 ; i < previewCbH ; i++) {
                 memcpy(dstAddr, srcAddr, previewCbW);
                 dstAddr += stride;
-                srcAddr += ALIGN(stride, 32);
+                srcAddr += srcStride;
             }
             dstAddr = (char *)(subParms->svcBuffers[subParms->svcBufIndex].virt.extP[0] + stride * previewCbH);
-            srcAddr = (char *)(srcImageBuf->virt.extP[1]);
+            srcAddr = (char *)(m_previewCbBuf.virt.extP[1]);
             for (int i = 0 ; i < previewCbH/2 ; i++) {
                 memcpy(dstAddr, srcAddr, previewCbW/2);
                 dstAddr += c_stride;
-                srcAddr += uv_stride;
+                srcAddr += srcStride / 2;
             }
-            srcAddr = (char *)(srcImageBuf->virt.extP[2]);
+            srcAddr = (char *)(m_previewCbBuf.virt.extP[2]);
             for (int i = 0 ; i < previewCbH/2 ; i++) {
                 memcpy(dstAddr, srcAddr, previewCbW/2);
                 dstAddr += c_stride;
-                srcAddr += uv_stride;
+                srcAddr += srcStride / 2;
             }
         }
     }
+    else {
+        ALOGE("ERR(%s):m_exynosVideoCSC == NULL", __FUNCTION__);
+    }
     res = subParms->streamOps->enqueue_buffer(subParms->streamOps, frameTimeStamp, &(subParms->svcBufHandle[subParms->svcBufIndex]));
 
     ALOGV("DEBUG(%s): streamthread[%d] enqueue_buffer index(%d) to svc done res(%d)",
@@ -4629,88 +5063,93 @@ bool ExynosCameraHWInterface2::m_checkThumbnailSize(int w, int h)
 
     return false;
 }
-bool ExynosCameraHWInterface2::yuv2Jpeg(ExynosBuffer *yuvBuf,
+bool ExynosCameraHWInterface2::yuv2Jpeg(ExynosJpegEncoderForCamera *jpegEnc,
+                            ExynosBuffer *yuvBuf,
                             ExynosBuffer *jpegBuf,
-                            ExynosRect *rect)
+                            ExynosRect *rect,
+                            struct camera2_shot_ext *shot)
 {
     unsigned char *addr;
 
-    ExynosJpegEncoderForCamera jpegEnc;
+    // workers encode concurrently, so each one fills its own copy of the EXIF
+    exif_attribute_t exifInfo = mExifInfo;
+    int thumbNailW = m_thumbNailW;
+    int thumbNailH = m_thumbNailH;
     bool ret = false;
     int res = 0;
 
     unsigned int *yuvSize = yuvBuf->size.extS;
 
-    if (jpegEnc.create()) {
+    if (jpegEnc->flagCreate() == false && jpegEnc->create()) {
         ALOGE("ERR(%s):jpegEnc.create() fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
 
-    if (jpegEnc.setQuality(m_jpegMetadata.shot.ctl.jpeg.quality)) {
+    if (jpegEnc->setQuality(shot->shot.ctl.jpeg.quality)) {
         ALOGE("ERR(%s):jpegEnc.setQuality() fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
 
-    if (jpegEnc.setSize(rect->w, rect->h)) {
+    if (jpegEnc->setSize(rect->w, rect->h)) {
         ALOGE("ERR(%s):jpegEnc.setSize() fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
     ALOGV("%s : width = %d , height = %d\n", __FUNCTION__, rect->w, rect->h);
 
-    if (jpegEnc.setColorFormat(rect->colorFormat)) {
+    if (jpegEnc->setColorFormat(rect->colorFormat)) {
         ALOGE("ERR(%s):jpegEnc.setColorFormat() fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
 
-    if (jpegEnc.setJpegFormat(V4L2_PIX_FMT_JPEG_422)) {
+    if (jpegEnc->setJpegFormat(V4L2_PIX_FMT_JPEG_422)) {
         ALOGE("ERR(%s):jpegEnc.setJpegFormat() fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
 
-    if((m_jpegMetadata.shot.ctl.jpeg.thumbnailSize[0] != 0) && (m_jpegMetadata.shot.ctl.jpeg.thumbnailSize[1] != 0)) {
-        mExifInfo.enableThumb = true;
-        if(!m_checkThumbnailSize(m_jpegMetadata.shot.ctl.jpeg.thumbnailSize[0], m_jpegMetadata.shot.ctl.jpeg.thumbnailSize[1])) {
+    if((shot->shot.ctl.jpeg.thumbnailSize[0] != 0) && (shot->shot.ctl.jpeg.thumbnailSize[1] != 0)) {
+        exifInfo.enableThumb = true;
+        if(!m_checkThumbnailSize(shot->shot.ctl.jpeg.thumbnailSize[0], shot->shot.ctl.jpeg.thumbnailSize[1])) {
             // in the case of unsupported parameter, disable thumbnail
-            mExifInfo.enableThumb = false;
+            exifInfo.enableThumb = false;
         } else {
-            m_thumbNailW = m_jpegMetadata.shot.ctl.jpeg.thumbnailSize[0];
-            m_thumbNailH = m_jpegMetadata.shot.ctl.jpeg.thumbnailSize[1];
+            thumbNailW = shot->shot.ctl.jpeg.thumbnailSize[0];
+            thumbNailH = shot->shot.ctl.jpeg.thumbnailSize[1];
         }
 
-        ALOGV("(%s) m_thumbNailW = %d, m_thumbNailH = %d", __FUNCTION__, m_thumbNailW, m_thumbNailH);
+        ALOGV("(%s) thumbNailW = %d, thumbNailH = %d", __FUNCTION__, thumbNailW, thumbNailH);
 
     } else {
-        mExifInfo.enableThumb = false;
+        exifInfo.enableThumb = false;
     }
 
-    if (jpegEnc.setThumbnailSize(m_thumbNailW, m_thumbNailH)) {
-        ALOGE("ERR(%s):jpegEnc.setThumbnailSize(%d, %d) fail", __FUNCTION__, m_thumbNailH, m_thumbNailH);
+    if (jpegEnc->setThumbnailSize(thumbNailW, thumbNailH)) {
+        ALOGE("ERR(%s):jpegEnc.setThumbnailSize(%d, %d) fail", __FUNCTION__, thumbNailW, thumbNailH);
         goto jpeg_encode_done;
     }
 
-    ALOGV("(%s):jpegEnc.setThumbnailSize(%d, %d) ", __FUNCTION__, m_thumbNailW, m_thumbNailW);
-    if (jpegEnc.setThumbnailQuality(m_jpegMetadata.shot.ctl.jpeg.thumbnailQuality)) {
+    ALOGV("(%s):jpegEnc.setThumbnailSize(%d, %d) ", __FUNCTION__, thumbNailW, thumbNailH);
+    if (jpegEnc->setThumbnailQuality(shot->shot.ctl.jpeg.thumbnailQuality)) {
         ALOGE("ERR(%s):jpegEnc.setThumbnailQuality fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
 
-    m_setExifChangedAttribute(&mExifInfo, rect, &m_jpegMetadata);
+    m_setExifChangedAttribute(&exifInfo, rect, shot);
     ALOGV("DEBUG(%s):calling jpegEnc.setInBuf() yuvSize(%d)", __FUNCTION__, *yuvSize);
-    if (jpegEnc.setInBuf((int *)&(yuvBuf->fd.fd), &(yuvBuf->virt.p), (int *)yuvSize)) {
+    if (jpegEnc->setInBuf((int *)&(yuvBuf->fd.fd), &(yuvBuf->virt.p), (int *)yuvSize)) {
         ALOGE("ERR(%s):jpegEnc.setInBuf() fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
-    if (jpegEnc.setOutBuf(jpegBuf->fd.fd, jpegBuf->virt.p, jpegBuf->size.extS[0] + jpegBuf->size.extS[1] + jpegBuf->size.extS[2])) {
+    if (jpegEnc->setOutBuf(jpegBuf->fd.fd, jpegBuf->virt.p, jpegBuf->size.extS[0] + jpegBuf->size.extS[1] + jpegBuf->size.extS[2])) {
         ALOGE("ERR(%s):jpegEnc.setOutBuf() fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
 
-    if (jpegEnc.updateConfig()) {
+    if (jpegEnc->updateConfig()) {
         ALOGE("ERR(%s):jpegEnc.updateConfig() fail", __FUNCTION__);
         goto jpeg_encode_done;
     }
 
-    if (res = jpegEnc.encode((int *)&jpegBuf->size.s, &mExifInfo)) {
+    if (res = jpegEnc->encode((int *)&jpegBuf->size.s, &exifInfo)) {
         ALOGE("ERR(%s):jpegEnc.encode() fail ret(%d)", __FUNCTION__, res);
         goto jpeg_encode_done;
     }
@@ -4719,8 +5158,9 @@ bool ExynosCameraHWInterface2::yuv2Jpeg(ExynosBuffer *yuvBuf,
 
 jpeg_encode_done:
 
-    if (jpegEnc.flagCreate() == true)
-        jpegEnc.destroy();
+    // the encoder stays open across captures, start over from scratch after an error
+    if (ret == false && jpegEnc->flagCreate() == true)
+        jpegEnc->destroy();
 
     return ret;
 }
@@ -5740,10 +6180,10 @@ void ExynosCameraHWInterface2::m_setExifChangedAttribute(exif_attribute_t *exifI
 
     //3 Date time
     time_t rawtime;
-    struct tm *timeinfo;
+    struct tm timeinfo;
     time(&rawtime);
-    timeinfo = localtime(&rawtime);
-    strftime((char *)exifInfo->date_time, 20, "%Y:%m:%d %H:%M:%S", timeinfo);
+    localtime_r(&rawtime, &timeinfo);
+    strftime((char *)exifInfo->date_time, 20, "%Y:%m:%d %H:%M:%S", &timeinfo);
 
     //2 0th IFD Exif Private Tags
     //3 Exposure Time
@@ -5923,6 +6363,17 @@ void ExynosCameraHWInterface2::SensorThread::release()
     SetSignal(SIGNAL_THREAD_RELEASE);
 }
 
+ExynosCameraHWInterface2::JpegWorkerThread::~JpegWorkerThread()
+{
+    ALOGV("(%s):", __FUNCTION__);
+}
+
+void ExynosCameraHWInterface2::JpegWorkerThread::release()
+{
+    ALOGV("(%s):", __func__);
+    SetSignal(SIGNAL_THREAD_RELEASE);
+}
+
 ExynosCameraHWInterface2::StreamThread::~StreamThread()
 {
     ALOGV("(%s):", __FUNCTION__);
@@ -6030,7 +6481,7 @@ int ExynosCameraHWInterface2::allocCameraMemory(ion_client ionClient, ExynosBuff
     return allocCameraMemory(ionClient, buf, iMemoryNum, 0);
 }
 
-int ExynosCameraHWInterface2::allocCameraMemory(ion_client ionClient, ExynosBuffer *buf, int iMemoryNum, int cacheFlag)
+int ExynosCameraHWInterface2::allocCameraMemory(ion_client ionClient, ExynosBuffer *buf, int iMemoryNum, int cacheFlag, bool usePool)
 {
     int ret = 0;
     int i = 0;
@@ -6049,6 +6500,12 @@ int ExynosCameraHWInterface2::allocCameraMemory(ion_client ionClient, ExynosBuff
             flag = ION_FLAG_CACHED;
         else
             flag = 0;
+        if (usePool && m_memoryPool != NULL &&
+            m_memoryPool->Alloc(buf->size.extS[i], ION_HEAP_EXYNOS_MASK, flag,
+                                &buf->fd.extFd[i], &buf->virt.extP[i]) == 0) {
+            ALOGV("allocCameraMem : [%d][0x%08x] size(%d) flag(%d) pooled", i, (unsigned int)(buf->virt.extP[i]), buf->size.extS[i], flag);
+            continue;
+        }
         buf->fd.extFd[i] = ion_alloc(ionClient, \
                                       buf->size.extS[i], 0, ION_HEAP_EXYNOS_MASK, flag);
         if ((buf->fd.extFd[i] == -1) ||(buf->fd.extFd[i] == 0)) {
@@ -6080,12 +6537,16 @@ void ExynosCameraHWInterface2::freeCameraMemory(ExynosBuffer *buf, int iMemoryNu
 
     for (i=0;i<iMemoryNum;i++) {
         if (buf->fd.extFd[i] != -1) {
-            if (buf->virt.extP[i] != (char *)MAP_FAILED) {
-                ret = ion_unmap(buf->virt.extP[i], buf->size.extS[i]);
-                if (ret < 0)
-                    ALOGE("ERR(%s)", __FUNCTION__);
+            if (m_memoryPool != NULL && m_memoryPool->Free(buf->fd.extFd[i])) {
+                // kept mapped in the pool for the next stream setup
+            } else {
+                if (buf->virt.extP[i] != (char *)MAP_FAILED) {
+                    ret = ion_unmap(buf->virt.extP[i], buf->size.extS[i]);
+                    if (ret < 0)
+                        ALOGE("ERR(%s)", __FUNCTION__);
+                }
+                ion_free(buf->fd.extFd[i]);
             }
-            ion_free(buf->fd.extFd[i]);
         ALOGV("freeCameraMemory : [%d][0x%08x] size(%d)", i, (unsigned int)(buf->virt.extP[i]), buf->size.extS[i]);
         }
         buf->fd.extFd[i] = -1;
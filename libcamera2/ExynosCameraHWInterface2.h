@@ -46,6 +46,7 @@
 #include "videodev2_exynos_camera.h"
 #include "gralloc_priv.h"
 #include "ExynosJpegEncoderForCamera.h"
+#include "ExynosCameraMemoryPool.h"
 #include <fcntl.h>
 #include "fimc-is-metadata.h"
 #include "ion.h"
@@ -53,6 +54,7 @@
 #include "csc.h"
 #include "ExynosCamera2.h"
 #include "cutils/properties.h"
+#include <cutils/atomic.h>
 
 namespace android {
 
@@ -61,13 +63,18 @@ namespace android {
 #define NODE_PREFIX     "/dev/video"
 
 #define NUM_MAX_STREAM_THREAD       (5)
-#define NUM_MAX_REQUEST_MGR_ENTRY   (5)
+#define NUM_MAX_REQUEST_MGR_ENTRY   (8)
+#define MAX_REQUEST_MGR_DEPTH       (16)
+#define MAX_FRAME_METADATA_ENTRIES  (280)
 #define NUM_MAX_CAMERA_BUFFERS      (16)
 #define NUM_BAYER_BUFFERS           (8)
 #define NUM_SCC_BUFFERS             (8)
 #define NUM_SCP_BUFFERS             (8)
 #define NUM_MIN_SENSOR_QBUF         (3)
 #define NUM_MAX_SUBSTREAM           (4)
+#define NUM_JPEG_WORKERS            (2)
+#define NUM_JPEG_JOBS               (4)
+#define JPEG_JOB_WAIT_TIMEOUT       (1000000000)
 
 #define PICTURE_GSC_NODE_NUM (2)
 #define VIDEO_GSC_NODE_NUM (1)
@@ -85,6 +92,13 @@ namespace android {
 #define SIGNAL_STREAM_REPROCESSING_START        (SIGNAL_THREAD_COMMON_LAST<<14)
 #define SIGNAL_STREAM_DATA_COMING               (SIGNAL_THREAD_COMMON_LAST<<15)
 
+#define SIGNAL_JPEG_ENCODE_START                (SIGNAL_THREAD_COMMON_LAST<<16)
+
+#define NUM_MAIN_SIGNAL_ENTRIES                 (3)
+#define NUM_SENSOR_SIGNAL_ENTRIES               (2)
+#define NUM_STREAM_SIGNAL_ENTRIES               (3)
+#define NUM_JPEG_SIGNAL_ENTRIES                 (2)
+
 #define NO_TRANSITION                   (0)
 #define HAL_AFSTATE_INACTIVE            (1)
 #define HAL_AFSTATE_NEEDS_COMMAND       (2)
@@ -225,11 +239,12 @@ typedef enum request_entry_status {
     COMPLETED
 } request_entry_status_t;
 
+// status and output_stream_count change through android_atomic_* only
 typedef struct request_manager_entry {
-    request_entry_status_t      status;
+    volatile int32_t            status;
     camera_metadata_t           *original_request;
     struct camera2_shot_ext     internal_shot;
-    int                         output_stream_count;
+    volatile int32_t            output_stream_count;
 } request_manager_entry_t;
 
 // structure related to a specific function of camera
@@ -276,13 +291,13 @@ typedef struct request_control_info {
 
 class RequestManager {
 public:
-    RequestManager(SignalDrivenThread* main_thread);
+    RequestManager(SignalDrivenThread* main_thread, int depth = NUM_MAX_REQUEST_MGR_ENTRY);
     ~RequestManager();
     void    ResetEntry();
     int     GetNumEntries();
     bool    IsRequestQueueFull();
 
-    void    RegisterRequest(camera_metadata_t *new_request, int * afMode, uint32_t * afRegion);
+    int     RegisterRequest(camera_metadata_t *new_request, int * afMode, uint32_t * afRegion);
     void    DeregisterRequest(camera_metadata_t **deregistered_request);
     bool    PrepareFrame(size_t *num_entries, size_t *frame_size,
                 camera_metadata_t **prepared_frame, int afState);
@@ -312,32 +327,44 @@ public:
     int     popSensorQ();
     void    releaseSensorQ();
 private:
+    int     FindOldestRegisteredIndex();
+    int     FindEntryIndexByFrameCntLocked(int frameCnt);
+    bool    GrowFrameMetadataBuf();
 
     MetadataConverter               *m_metadataConverter;
     SignalDrivenThread              *m_mainThread;
-    int                             m_numOfEntries;
+    volatile int32_t                m_numOfEntries;
     int                             m_entryInsertionIndex;
     int                             m_entryProcessingIndex;
     int                             m_entryFrameOutputIndex;
-    request_manager_entry_t         entries[NUM_MAX_REQUEST_MGR_ENTRY];
+    // ring of m_depth entries, a request lives at frameCnt % m_depth
+    int                             m_depth;
+    request_manager_entry_t         *entries;
     int                             m_completedIndex;
 
+    // guards the ring indices; per-entry state moves through atomics
     Mutex                           m_requestMutex;
 
-    //TODO : alloc dynamically
-    char                            m_tempFrameMetadataBuf[2000];
+    char                            *m_tempFrameMetadataBuf;
+    size_t                          m_tempFrameMetadataBufSize;
+    size_t                          m_frameMetadataEntryCap;
+    size_t                          m_frameMetadataDataCap;
     camera_metadata_t               *m_tempFrameMetadata;
 
     int                             m_sensorPipelineSkipCnt;
     int                             m_cropX;
-    int                             m_lastCompletedFrameCnt;
+    volatile int32_t                m_lastCompletedFrameCnt;
     int                             m_lastAeMode;
     int                             m_lastAaMode;
     int                             m_lastAwbMode;
     int                             m_lastAeComp;
     bool                            m_vdisBubbleEn;
     nsecs_t                         m_lastTimeStamp;
-    List<int>                   m_sensorQ;
+
+    Mutex                           m_sensorQMutex;
+    int                             m_sensorQ[NUM_MAX_CAMERA_BUFFERS];
+    int                             m_sensorQHead;
+    int                             m_sensorQCount;
 };
 
 
@@ -379,11 +406,66 @@ private:
 };
 
 
+#define NUM_ZSL_ENTRIES         (NUM_MAX_CAMERA_BUFFERS)
+
+typedef struct zsl_buf_entry {
+    int                     frameCnt;
+    int                     svcBufIndex;
+    nsecs_t                 timeStamp;
+    struct camera2_shot_ext shot;
+} zsl_buf_entry_t;
+
+/*
+ * Remembers the ISP result of the last full-resolution frames sent out on the
+ * ZSL stream, so that a reprocess request can be encoded with the metadata
+ * of the frame it actually reprocesses.
+ */
+class ZslBufManager {
+public:
+    ZslBufManager();
+    ~ZslBufManager();
+    void                Reset();
+    void                RegisterShot(struct camera2_shot_ext *shot_ext, nsecs_t timeStamp);
+    void                MarkSvcBuffer(int frameCnt, int svcBufIndex);
+    bool                SelectFrame(int svcBufIndex, nsecs_t timeStamp, zsl_buf_entry_t *selected);
+
+private:
+    int                 FindNearest(nsecs_t timeStamp);
+
+    Mutex               m_lock;
+    int                 m_head;
+    int                 m_count;
+    zsl_buf_entry_t     m_entries[NUM_ZSL_ENTRIES];
+};
+
+
+#define JPEG_JOB_FREE           (0)
+#define JPEG_JOB_PREPARING      (1)
+#define JPEG_JOB_QUEUED         (2)
+#define JPEG_JOB_ENCODING       (3)
+#define JPEG_JOB_DONE           (4)
+
+/* one still capture handed from the SCC stream thread to a JPEG worker */
+typedef struct jpeg_job {
+    int                     status;
+    int                     seq;
+    int                     svcBufIndex;
+    int                     jpegBufSize;
+    nsecs_t                 timeStamp;
+    bool                    encoded;
+    ExynosRect              rect;
+    ExynosBuffer            resizeBuf;
+    ExynosBuffer            yuvBuf;
+    struct camera2_shot_ext shot;
+} jpeg_job_t;
+
+
 #define NOT_AVAILABLE           (0)
 #define REQUIRES_DQ_FROM_SVC    (1)
 #define ON_DRIVER               (2)
 #define ON_HAL                  (3)
 #define ON_SERVICE              (4)
+#define ON_JPEG_ENCODER         (5)
 
 #define BAYER_NOT_AVAILABLE     (0)
 #define BAYER_ON_SENSOR         (1)
@@ -426,6 +508,7 @@ typedef struct substream_parameters {
             int                     internalFormat;
             int                     internalPlanes;
             int                     svcPlanes;
+            int                     svcBufStride;
             buffer_handle_t         svcBufHandle[NUM_MAX_CAMERA_BUFFERS];
             ExynosBuffer            svcBuffers[NUM_MAX_CAMERA_BUFFERS];
             int                     svcBufStatus[NUM_MAX_CAMERA_BUFFERS];
@@ -476,7 +559,11 @@ class MainThread : public SignalDrivenThread {
     public:
         MainThread(ExynosCameraHWInterface2 *hw):
             SignalDrivenThread(),
-            mHardware(hw) { }
+            mHardware(hw)
+        {
+            SetDispatchTable(m_mainSignalTable, NUM_MAIN_SIGNAL_ENTRIES);
+            SetCoalescedSignals(SIGNAL_MAIN_REQ_Q_NOT_EMPTY);
+        }
         ~MainThread();
         void threadFunctionInternal()
 	    {
@@ -492,7 +579,10 @@ class MainThread : public SignalDrivenThread {
     public:
         SensorThread(ExynosCameraHWInterface2 *hw):
             SignalDrivenThread(),
-            mHardware(hw) { }
+            mHardware(hw)
+        {
+            SetDispatchTable(m_sensorSignalTable, NUM_SENSOR_SIGNAL_ENTRIES);
+        }
         ~SensorThread();
         void threadFunctionInternal() {
             mHardware->m_sensorThreadFunc(this);
@@ -509,7 +599,10 @@ class MainThread : public SignalDrivenThread {
         StreamThread(ExynosCameraHWInterface2 *hw, uint8_t new_index):
             SignalDrivenThread(),
             mHardware(hw),
-            m_index(new_index) { }
+            m_index(new_index)
+        {
+            SetDispatchTable(m_streamSignalTable, NUM_STREAM_SIGNAL_ENTRIES);
+        }
         ~StreamThread();
         void threadFunctionInternal() {
             mHardware->m_streamThreadFunc(this);
@@ -534,21 +627,45 @@ class MainThread : public SignalDrivenThread {
         int                             m_numRegisteredStream;
      };
 
+    class JpegWorkerThread : public SignalDrivenThread {
+        ExynosCameraHWInterface2 *mHardware;
+    public:
+        JpegWorkerThread(ExynosCameraHWInterface2 *hw, uint8_t new_index):
+            SignalDrivenThread(),
+            mHardware(hw),
+            m_index(new_index)
+        {
+            SetDispatchTable(m_jpegSignalTable, NUM_JPEG_SIGNAL_ENTRIES);
+        }
+        ~JpegWorkerThread();
+        void threadFunctionInternal() {
+            mHardware->m_jpegWorkerThreadFunc(this);
+            return;
+        }
+        void            release(void);
+
+        uint8_t                         m_index;
+        ExynosJpegEncoderForCamera      m_jpegEnc;
+    };
+
     sp<MainThread>      m_mainThread;
     sp<SensorThread>    m_sensorThread;
     sp<StreamThread>    m_streamThreads[NUM_MAX_STREAM_THREAD];
+    sp<JpegWorkerThread>    m_jpegWorkers[NUM_JPEG_WORKERS];
     substream_parameters_t  m_subStreams[STREAM_ID_LAST+1];
 
 
 
     RequestManager      *m_requestManager;
     BayerBufManager     *m_BayerManager;
+    ZslBufManager       *m_zslManager;
     ExynosCamera2       *m_camera2;
 
     void                m_mainThreadFunc(SignalDrivenThread * self);
     void                m_sensorThreadFunc(SignalDrivenThread * self);
     void                m_streamThreadFunc(SignalDrivenThread * self);
     void                m_streamThreadInitialize(SignalDrivenThread * self);
+    void                m_jpegWorkerThreadFunc(SignalDrivenThread * self);
 
     void                m_streamFunc_direct(SignalDrivenThread *self);
     void                m_streamFunc_indirect(SignalDrivenThread *self);
@@ -558,6 +675,11 @@ class MainThread : public SignalDrivenThread {
     int                 m_runSubStreamFunc(StreamThread *selfThread, ExynosBuffer *srcImageBuf,
                             int stream_id, nsecs_t frameTimeStamp);
     int                 m_jpegCreator(StreamThread *selfThread, ExynosBuffer *srcImageBuf, nsecs_t frameTimeStamp);
+    jpeg_job_t *        m_jpegTakeJob(void);
+    void                m_jpegDeliverJobs(void);
+    void                m_jpegWaitIdle(void);
+    void                m_jpegAllocJobBuffers(unsigned int size);
+    void                m_jpegFreeJobBuffers(void);
     int                 m_recordCreator(StreamThread *selfThread, ExynosBuffer *srcImageBuf, nsecs_t frameTimeStamp);
     int                 m_prvcbCreator(StreamThread *selfThread, ExynosBuffer *srcImageBuf, nsecs_t frameTimeStamp);
     void                m_getAlignedYUVSize(int colorFormat, int w, int h,
@@ -571,15 +693,17 @@ class MainThread : public SignalDrivenThread {
 	int					deleteIonClient(ion_client ionClient);
 
     int				allocCameraMemory(ion_client ionClient, ExynosBuffer *buf, int iMemoryNum);
-    int             allocCameraMemory(ion_client ionClient, ExynosBuffer *buf, int iMemoryNum, int cacheFlag);
+    int             allocCameraMemory(ion_client ionClient, ExynosBuffer *buf, int iMemoryNum, int cacheFlag, bool usePool = true);
 	void				freeCameraMemory(ExynosBuffer *buf, int iMemoryNum);
 	void				initCameraMemory(ExynosBuffer *buf, int iMemoryNum);
 
     void            DumpInfoWithShot(struct camera2_shot_ext * shot_ext);
     bool            m_checkThumbnailSize(int w, int h);
-    bool            yuv2Jpeg(ExynosBuffer *yuvBuf,
+    bool            yuv2Jpeg(ExynosJpegEncoderForCamera *jpegEnc,
+                            ExynosBuffer *yuvBuf,
                             ExynosBuffer *jpegBuf,
-                            ExynosRect *rect);
+                            ExynosRect *rect,
+                            struct camera2_shot_ext *shot);
     int             InitializeISPChain();
     void            StartISP();
     void            StartSCCThread(bool threadExists);
@@ -628,10 +752,16 @@ class MainThread : public SignalDrivenThread {
     camera2_device_t                    *m_halDevice;
     static gralloc_module_t const*      m_grallocHal;
 
+    static const signal_dispatch_entry_t m_mainSignalTable[NUM_MAIN_SIGNAL_ENTRIES];
+    static const signal_dispatch_entry_t m_sensorSignalTable[NUM_SENSOR_SIGNAL_ENTRIES];
+    static const signal_dispatch_entry_t m_streamSignalTable[NUM_STREAM_SIGNAL_ENTRIES];
+    static const signal_dispatch_entry_t m_jpegSignalTable[NUM_JPEG_SIGNAL_ENTRIES];
+
 
     camera_hw_info_t                     m_camera_info;
 
 	ion_client m_ionCameraClient;
+    ExynosCameraMemoryPool              *m_memoryPool;
 
     bool                                m_isIspStarted;
 
@@ -643,7 +773,6 @@ class MainThread : public SignalDrivenThread {
 
     bool                                m_scp_flushing;
     bool                                m_closing;
-    ExynosBuffer                        m_resizeBuf;
 #ifndef ENABLE_FRAME_SYNC
     int                                 m_currentOutputStreams;
 #endif
@@ -661,6 +790,10 @@ class MainThread : public SignalDrivenThread {
 
     mutable Mutex                       m_qbufLock;
     mutable Mutex                       m_jpegEncoderLock;
+    Condition                           m_jpegJobCondition;
+    jpeg_job_t                          m_jpegJobs[NUM_JPEG_JOBS];
+    int                                 m_jpegSubmitSeq;
+    int                                 m_jpegOutputSeq;
     int                                 m_jpegEncodingCount;
     mutable Mutex                       m_afModeTriggerLock;
 
@@ -0,0 +1,267 @@
+/*
+**
+** Copyright 2008, The Android Open Source Project
+** Copyright 2012, Samsung Electronics Co. LTD
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+/*!
+ * \file      ExynosCameraMemoryPool.cpp
+ * \brief     source file for ION buffer pool ( for camera hal2 implementation )
+ * \date      2012/11/20
+ *
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "ExynosCameraMemoryPool"
+#include <sys/mman.h>
+#include <utils/Log.h>
+
+#include "ExynosCameraMemoryPool.h"
+
+namespace android {
+
+ExynosCameraMemoryPool::ExynosCameraMemoryPool(ion_client ionClient):
+    m_ionClient(ionClient),
+    m_useStamp(0),
+    m_hitCount(0),
+    m_missCount(0),
+    m_residentSize(0),
+    m_idleSize(0)
+{
+    for (int i = 0 ; i < POOL_MAX_ENTRIES ; i++) {
+        m_entries[i].fd = -1;
+        m_entries[i].virt = (char *)MAP_FAILED;
+        m_entries[i].size = 0;
+        m_entries[i].inUse = false;
+    }
+}
+
+ExynosCameraMemoryPool::~ExynosCameraMemoryPool()
+{
+    Mutex::Autolock lock(m_lock);
+
+    DumpStats();
+    for (int i = 0 ; i < POOL_MAX_ENTRIES ; i++) {
+        if (m_entries[i].fd == -1)
+            continue;
+        if (m_entries[i].inUse)
+            ALOGW("WARN(%s): fd(%d) size(%d) still in use", __FUNCTION__, m_entries[i].fd, m_entries[i].size);
+        ReleaseEntry(i);
+    }
+}
+
+int ExynosCameraMemoryPool::Alloc(unsigned int size, unsigned int heapMask, unsigned int flags,
+                                  int *fd, char **virt)
+{
+    Mutex::Autolock lock(m_lock);
+    unsigned int allocSize;
+    int index;
+
+    if (m_ionClient == 0 || size == 0)
+        return -1;
+
+    index = FindIdle(size, heapMask, flags);
+    if (index >= 0) {
+        pool_entry_t *entry = &m_entries[index];
+
+        entry->inUse = true;
+        entry->lastUse = ++m_useStamp;
+        m_idleSize -= entry->size;
+        m_hitCount++;
+        *fd = entry->fd;
+        *virt = entry->virt;
+        ALOGV("DEBUG(%s): hit fd(%d) size(%d/%d)", __FUNCTION__, entry->fd, size, entry->size);
+        return 0;
+    }
+
+    index = FindEmpty();
+    if (index < 0) {
+        // every slot holds a buffer, give up the oldest idle one
+        EvictIdle(m_idleSize ? m_idleSize - 1 : 0);
+        index = FindEmpty();
+        if (index < 0)
+            return -1;
+    }
+
+    allocSize = (size + POOL_SIZE_ALIGN - 1) & ~(POOL_SIZE_ALIGN - 1);
+    pool_entry_t *entry = &m_entries[index];
+
+    entry->fd = ion_alloc(m_ionClient, allocSize, 0, heapMask, flags);
+    if ((entry->fd == -1) || (entry->fd == 0)) {
+        // idle buffers may be what the heap is short of
+        EvictIdle(0);
+        entry->fd = ion_alloc(m_ionClient, allocSize, 0, heapMask, flags);
+    }
+    if ((entry->fd == -1) || (entry->fd == 0)) {
+        ALOGE("ERR(%s): ion_alloc(%d) failed", __FUNCTION__, allocSize);
+        entry->fd = -1;
+        return -1;
+    }
+
+    entry->virt = (char *)ion_map(entry->fd, allocSize, 0);
+    if ((entry->virt == (char *)MAP_FAILED) || (entry->virt == NULL)) {
+        ALOGE("ERR(%s): ion_map(%d) failed", __FUNCTION__, allocSize);
+        ion_free(entry->fd);
+        entry->fd = -1;
+        entry->virt = (char *)MAP_FAILED;
+        return -1;
+    }
+
+    entry->size = allocSize;
+    entry->heapMask = heapMask;
+    entry->flags = flags;
+    entry->inUse = true;
+    entry->lastUse = ++m_useStamp;
+    m_residentSize += allocSize;
+    m_missCount++;
+
+    *fd = entry->fd;
+    *virt = entry->virt;
+    ALOGV("DEBUG(%s): miss fd(%d) size(%d/%d)", __FUNCTION__, entry->fd, size, allocSize);
+    return 0;
+}
+
+bool ExynosCameraMemoryPool::Free(int fd)
+{
+    Mutex::Autolock lock(m_lock);
+
+    for (int i = 0 ; i < POOL_MAX_ENTRIES ; i++) {
+        pool_entry_t *entry = &m_entries[i];
+
+        if (entry->fd != fd || !entry->inUse)
+            continue;
+
+        entry->inUse = false;
+        entry->lastUse = ++m_useStamp;
+        m_idleSize += entry->size;
+        if (m_idleSize > POOL_MAX_IDLE_SIZE)
+            EvictIdle(POOL_MAX_IDLE_SIZE);
+        return true;
+    }
+
+    return false;
+}
+
+void ExynosCameraMemoryPool::Trim()
+{
+    Mutex::Autolock lock(m_lock);
+
+    EvictIdle(0);
+}
+
+void ExynosCameraMemoryPool::DumpStats()
+{
+    ALOGD("DEBUG(%s): hit(%d) miss(%d) resident(%d) idle(%d)", __FUNCTION__,
+        m_hitCount, m_missCount, m_residentSize, m_idleSize);
+}
+
+uint32_t ExynosCameraMemoryPool::GetHitCount()
+{
+    Mutex::Autolock lock(m_lock);
+    return m_hitCount;
+}
+
+uint32_t ExynosCameraMemoryPool::GetMissCount()
+{
+    Mutex::Autolock lock(m_lock);
+    return m_missCount;
+}
+
+uint32_t ExynosCameraMemoryPool::GetResidentSize()
+{
+    Mutex::Autolock lock(m_lock);
+    return m_residentSize;
+}
+
+uint32_t ExynosCameraMemoryPool::GetIdleSize()
+{
+    Mutex::Autolock lock(m_lock);
+    return m_idleSize;
+}
+
+int ExynosCameraMemoryPool::FindIdle(unsigned int size, unsigned int heapMask, unsigned int flags)
+{
+    unsigned int maxSize = size + (size >> POOL_MAX_SLACK_SHIFT);
+    int found = -1;
+
+    // smallest idle buffer that fits without wasting more than the slack
+    for (int i = 0 ; i < POOL_MAX_ENTRIES ; i++) {
+        pool_entry_t *entry = &m_entries[i];
+
+        if (entry->fd == -1 || entry->inUse)
+            continue;
+        if (entry->heapMask != heapMask || entry->flags != flags)
+            continue;
+        if (entry->size < size || entry->size > ((maxSize + POOL_SIZE_ALIGN - 1) & ~(POOL_SIZE_ALIGN - 1)))
+            continue;
+        if (found == -1 || entry->size < m_entries[found].size)
+            found = i;
+    }
+
+    return found;
+}
+
+int ExynosCameraMemoryPool::FindEmpty()
+{
+    for (int i = 0 ; i < POOL_MAX_ENTRIES ; i++) {
+        if (m_entries[i].fd == -1)
+            return i;
+    }
+
+    return -1;
+}
+
+void ExynosCameraMemoryPool::ReleaseEntry(int index)
+{
+    pool_entry_t *entry = &m_entries[index];
+
+    if (entry->virt != (char *)MAP_FAILED) {
+        if (ion_unmap(entry->virt, entry->size) < 0)
+            ALOGE("ERR(%s): ion_unmap failed", __FUNCTION__);
+    }
+    ion_free(entry->fd);
+
+    m_residentSize -= entry->size;
+    if (!entry->inUse)
+        m_idleSize -= entry->size;
+
+    entry->fd = -1;
+    entry->virt = (char *)MAP_FAILED;
+    entry->size = 0;
+    entry->inUse = false;
+}
+
+void ExynosCameraMemoryPool::EvictIdle(unsigned int limit)
+{
+    while (m_idleSize > limit) {
+        int oldest = -1;
+
+        for (int i = 0 ; i < POOL_MAX_ENTRIES ; i++) {
+            pool_entry_t *entry = &m_entries[i];
+
+            if (entry->fd == -1 || entry->inUse)
+                continue;
+            if (oldest == -1 || (int32_t)(entry->lastUse - m_entries[oldest].lastUse) < 0)
+                oldest = i;
+        }
+        if (oldest == -1)
+            break;
+
+        ALOGV("DEBUG(%s): release fd(%d) size(%d)", __FUNCTION__, m_entries[oldest].fd, m_entries[oldest].size);
+        ReleaseEntry(oldest);
+    }
+}
+
+}; // namespace android
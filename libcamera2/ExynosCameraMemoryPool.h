@@ -0,0 +1,93 @@
+/*
+**
+** Copyright 2008, The Android Open Source Project
+** Copyright 2012, Samsung Electronics Co. LTD
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+/*!
+ * \file      ExynosCameraMemoryPool.h
+ * \brief     header file for ION buffer pool ( for camera hal2 implementation )
+ * \date      2012/11/20
+ *
+ */
+
+#ifndef EXYNOS_CAMERA_MEMORY_POOL_H
+#define EXYNOS_CAMERA_MEMORY_POOL_H
+
+#include <utils/threads.h>
+
+#include "ion.h"
+
+namespace android {
+
+#define POOL_MAX_ENTRIES            (64)
+#define POOL_SIZE_ALIGN             (64 * 1024)
+#define POOL_MAX_SLACK_SHIFT        (3)     /* reuse a buffer at most 1/8 larger than asked */
+#define POOL_MAX_IDLE_SIZE          (64 * 1024 * 1024)
+
+typedef struct pool_entry {
+    int             fd;
+    char            *virt;
+    unsigned int    size;       /* size actually allocated and mapped */
+    unsigned int    heapMask;
+    unsigned int    flags;
+    bool            inUse;
+    uint32_t        lastUse;
+} pool_entry_t;
+
+/*
+ * Keeps ION buffers mapped across stream reconfigurations of one camera
+ * session. Freed buffers stay idle in the pool and serve the next request
+ * of the same heap, flags and size class, until the idle total passes
+ * POOL_MAX_IDLE_SIZE and the least recently used ones are released.
+ * A reused buffer keeps its old contents; callers that depend on zeroed
+ * memory clear what they need. Buffers that live for the whole session,
+ * like the sensor and capture buffers, are allocated around the pool.
+ */
+class ExynosCameraMemoryPool {
+public:
+    ExynosCameraMemoryPool(ion_client ionClient);
+    ~ExynosCameraMemoryPool();
+
+    int                 Alloc(unsigned int size, unsigned int heapMask, unsigned int flags,
+                              int *fd, char **virt);
+    bool                Free(int fd);
+    void                Trim();
+    void                DumpStats();
+
+    uint32_t            GetHitCount();
+    uint32_t            GetMissCount();
+    uint32_t            GetResidentSize();
+    uint32_t            GetIdleSize();
+
+private:
+    int                 FindIdle(unsigned int size, unsigned int heapMask, unsigned int flags);
+    int                 FindEmpty();
+    void                ReleaseEntry(int index);
+    void                EvictIdle(unsigned int limit);
+
+    Mutex               m_lock;
+    ion_client          m_ionClient;
+    pool_entry_t        m_entries[POOL_MAX_ENTRIES];
+    uint32_t            m_useStamp;
+    uint32_t            m_hitCount;
+    uint32_t            m_missCount;
+    uint32_t            m_residentSize;
+    uint32_t            m_idleSize;
+};
+
+}; // namespace android
+
+#endif
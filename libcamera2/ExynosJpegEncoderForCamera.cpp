@@ -18,6 +18,8 @@
 #include <utils/Log.h>
 
 #include "ExynosJpegEncoderForCamera.h"
+#include "ExynosCameraMemoryPool.h"
+#include "swconverter.h"
 
 static const char ExifAsciiPrefix[] = { 0x41, 0x53, 0x43, 0x49, 0x49, 0x0, 0x0, 0x0 };
 
@@ -42,6 +44,10 @@ ExynosJpegEncoderForCamera::ExynosJpegEncoderForCamera()
     m_thumbnailH = 0;
     m_thumbnailQuality = JPEG_THUMBNAIL_QUALITY;
     m_ionJpegClient = 0;
+    m_memoryPool = NULL;
+    m_thumbRet = ERROR_NONE;
+    m_thumbLen = 0;
+    memset(&m_stThumbSrcConfig, 0, sizeof(m_stThumbSrcConfig));
     initJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM);
     initJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM);
     initJpegMemory(&m_stMainInBuf, MAX_IMAGE_PLANE_NUM);
@@ -55,6 +61,11 @@ ExynosJpegEncoderForCamera::~ExynosJpegEncoderForCamera()
     }
 }
 
+void ExynosJpegEncoderForCamera::setMemoryPool(android::ExynosCameraMemoryPool *pool)
+{
+    m_memoryPool = pool;
+}
+
 bool ExynosJpegEncoderForCamera::flagCreate(void)
 {
     return m_flagCreate;
@@ -242,8 +253,37 @@ int ExynosJpegEncoderForCamera::encode(int *size, exif_attribute_t *exifInfo)
         return ERROR_NOT_YET_CREATED;
     }
 
+    /*
+     * The thumbnail scale and encode only read the main input buffer, so
+     * they run on their own thread and encoder instance while the main
+     * image is encoded. If the thread cannot be started the thumbnail is
+     * encoded inline after the main image as before.
+     */
+    bool bThumbStarted = false;
+
+    if ((exifInfo != NULL) && exifInfo->enableThumb) {
+        void *pConfig = m_jpegMain->getJpegConfig();
+        if (pConfig == NULL) {
+            JPEG_ERROR_LOG("ERR(%s):Fail getJpegConfig\n", __func__);
+            return ERROR_BUFFR_IS_NULL;
+        }
+        memcpy(&m_stThumbSrcConfig, pConfig, sizeof(m_stThumbSrcConfig));
+
+        m_thumbRet = ERROR_FAIL;
+        m_thumbLen = 0;
+        if (pthread_create(&m_thumbThread, NULL, thumbnailThreadFunc, this) == 0) {
+            bThumbStarted = true;
+        } else {
+            JPEG_ERROR_LOG("%s::Fail to start thumbnail thread, encode inline\n", __func__);
+        }
+    }
 
     ret = m_jpegMain->encode();
+
+    if (bThumbStarted) {
+        pthread_join(m_thumbThread, NULL);
+    }
+
     if (ret) {
         JPEG_ERROR_LOG("encode failed\n");
         return ret;
@@ -270,7 +310,12 @@ int ExynosJpegEncoderForCamera::encode(int *size, exif_attribute_t *exifInfo)
 
         unsigned int bufSize = 0;
         if (exifInfo->enableThumb) {
-            if (encodeThumbnail(&thumbLen)) {
+            if (bThumbStarted == false) {
+                m_thumbRet = encodeThumbnail(&m_thumbLen);
+            }
+            thumbLen = m_thumbLen;
+
+            if (m_thumbRet != ERROR_NONE) {
                 bufSize = EXIF_FILE_SIZE;
                 exifInfo->enableThumb = false;
             } else {
@@ -653,33 +698,13 @@ inline void ExynosJpegEncoderForCamera::writeExifIfd(unsigned char **pCur,
 
 int ExynosJpegEncoderForCamera::scaleDownYuv422(char **srcBuf, unsigned int srcW, unsigned int srcH,  char **dstBuf, unsigned int dstW, unsigned int dstH)
 {
-    int step_x, step_y;
-    int src_y_start_pos, dst_pos, src_pos;
-    char *src_buf = srcBuf[0];
-    char *dst_buf = dstBuf[0];
-
     if (dstW & 0x01 || dstH & 0x01) {
         return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
     }
 
-    step_x = srcW / dstW;
-    step_y = srcH / dstH;
-
-    unsigned int srcWStride = srcW * 2;
-    unsigned int stepXStride = step_x * 2;
-
-    dst_pos = 0;
-    for (unsigned int y = 0; y < dstH; y++) {
-        src_y_start_pos = srcWStride * step_y * y;
-
-        for (unsigned int x = 0; x < dstW; x += 2) {
-            src_pos = src_y_start_pos + (stepXStride * x);
-
-            dst_buf[dst_pos++] = src_buf[src_pos    ];
-            dst_buf[dst_pos++] = src_buf[src_pos + 1];
-            dst_buf[dst_pos++] = src_buf[src_pos + 2];
-            dst_buf[dst_pos++] = src_buf[src_pos + 3];
-        }
+    if (csc_scale_down_YUYV((unsigned char *)dstBuf[0], dstW, dstH,
+                            (unsigned char *)srcBuf[0], srcW, srcH) != 0) {
+        return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
     }
 
     return ERROR_NONE;
@@ -687,43 +712,13 @@ int ExynosJpegEncoderForCamera::scaleDownYuv422(char **srcBuf, unsigned int srcW
 
 int ExynosJpegEncoderForCamera::scaleDownYuv422_2p(char **srcBuf, unsigned int srcW, unsigned int srcH, char **dstBuf, unsigned int dstW, unsigned int dstH)
 {
-    int32_t step_x, step_y;
-    int32_t src_y_start_pos, dst_pos, src_pos;
-    int32_t src_Y_offset;
-    char *src_buf;
-    char *dst_buf;
-
     if (dstW % 2 != 0 || dstH % 2 != 0) {
         return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
     }
 
-    step_x = srcW / dstW;
-    step_y = srcH / dstH;
-
-    // Y scale down
-    src_buf = srcBuf[0];
-    dst_buf = dstBuf[0];
-    dst_pos = 0;
-    for (uint32_t y = 0; y < dstH; y++) {
-        src_y_start_pos = y * step_y * srcW;
-
-        for (uint32_t x = 0; x < dstW; x++) {
-            src_pos = src_y_start_pos + (x * step_x);
-
-            dst_buf[dst_pos++] = src_buf[src_pos];
-        }
-    }
-
-    // UV scale down
-    for (uint32_t i = 0; i < dstH; i++) {
-        src_y_start_pos = i * step_y * srcW + (srcW*srcH);
-
-        for (uint32_t j = 0; j < dstW; j += 2) {
-            src_pos = src_y_start_pos + (j * step_x);
-
-            dst_buf[dst_pos++] = src_buf[src_pos    ];
-            dst_buf[dst_pos++] = src_buf[src_pos + 1];
-        }
+    if (csc_scale_down_YUV422SP((unsigned char *)dstBuf[0], (unsigned char *)(dstBuf[0] + (dstW * dstH)), dstW, dstH,
+                                (unsigned char *)srcBuf[0], (unsigned char *)(srcBuf[0] + (srcW * srcH)), srcW, srcH) != 0) {
+        return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
     }
 
     return ERROR_NONE;
@@ -771,7 +766,7 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
         return ERROR_CANNOT_CREATE_EXYNOS_JPEG_ENC_HAL;
     }
 
-    // create jpeg thumbnail class
+    // create jpeg thumbnail class once, it is kept open until destroy()
     if (m_jpegThumb == NULL) {
         m_jpegThumb = new ExynosJpegEncoder;
 
@@ -779,27 +774,26 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
             JPEG_ERROR_LOG("ERR(%s):Cannot open a jpeg device file\n", __func__);
             return ERROR_CANNOT_CREATE_SEC_THUMB;
         }
-    }
 
-    ret = m_jpegThumb->create();
-    if (ret) {
-        JPEG_ERROR_LOG("ERR(%s):Fail create\n", __func__);
-        return ret;
-    }
+        ret = m_jpegThumb->create();
+        if (ret) {
+            JPEG_ERROR_LOG("ERR(%s):Fail create\n", __func__);
+            delete m_jpegThumb;
+            m_jpegThumb = NULL;
+            return ret;
+        }
 
         ret = m_jpegThumb->setCache(JPEG_CACHE_ON);
-    if (ret) {
-        JPEG_ERROR_LOG("ERR(%s):Fail cache set\n", __func__);
-        return ret;
-    }
-
-    void *pConfig = m_jpegMain->getJpegConfig();
-    if (pConfig == NULL) {
-        JPEG_ERROR_LOG("ERR(%s):Fail getJpegConfig\n", __func__);
-        return ERROR_BUFFR_IS_NULL;
+        if (ret) {
+            JPEG_ERROR_LOG("ERR(%s):Fail cache set\n", __func__);
+            m_jpegThumb->destroy();
+            delete m_jpegThumb;
+            m_jpegThumb = NULL;
+            return ret;
+        }
     }
 
-    ret = m_jpegThumb->setJpegConfig(pConfig);
+    ret = m_jpegThumb->setJpegConfig(&m_stThumbSrcConfig);
     if (ret) {
         JPEG_ERROR_LOG("ERR(%s):Fail setJpegConfig\n", __func__);
         return ret;
@@ -818,21 +812,30 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
         return ret;
     }
 
-    freeJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM);
-    freeJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM);
+    int iInSize[MAX_IMAGE_PLANE_NUM] = {0, };
+    int iOutSize = sizeof(char)*m_thumbnailW*m_thumbnailH*THUMBNAIL_IMAGE_PIXEL_SIZE;
 
-    if (m_jpegThumb->setColorBufSize(m_stThumbInBuf.iSize, MAX_IMAGE_PLANE_NUM) != ERROR_NONE) {
+    if (m_jpegThumb->setColorBufSize(iInSize, MAX_IMAGE_PLANE_NUM) != ERROR_NONE) {
         return ERROR_INVALID_COLOR_FORMAT;
     }
-    m_stThumbOutBuf.iSize[0] = sizeof(char)*m_thumbnailW*m_thumbnailH*THUMBNAIL_IMAGE_PIXEL_SIZE;
-
 
-    if (allocJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM) != ERROR_NONE) {
-        return ERROR_MEM_ALLOC_FAIL;
+    // keep the previous thumbnail buffers while the layout is unchanged
+    if ((memcmp(iInSize, m_stThumbInBuf.iSize, sizeof(iInSize)) != 0) ||
+        (m_stThumbInBuf.pcBuf[0] == (char *)MAP_FAILED)) {
+        freeJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM);
+        memcpy(m_stThumbInBuf.iSize, iInSize, sizeof(iInSize));
+        if (allocJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM) != ERROR_NONE) {
+            return ERROR_MEM_ALLOC_FAIL;
+        }
     }
 
-    if (allocJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM) != ERROR_NONE) {
-        return ERROR_MEM_ALLOC_FAIL;
+    if ((m_stThumbOutBuf.iSize[0] != iOutSize) ||
+        (m_stThumbOutBuf.pcBuf[0] == (char *)MAP_FAILED)) {
+        freeJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM);
+        m_stThumbOutBuf.iSize[0] = iOutSize;
+        if (allocJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM) != ERROR_NONE) {
+            return ERROR_MEM_ALLOC_FAIL;
+        }
     }
 
     ret = m_jpegThumb->setInBuf(m_stThumbInBuf.ionBuffer, m_stThumbInBuf.iSize);
@@ -858,12 +861,12 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
         int iTempHeight=0;
         int iTempColorformat = 0;
 
-        iTempColorformat = m_jpegMain->getColorFormat();
-
-        ret = m_jpegMain->getSize(&iTempWidth, &iTempHeight);
-        if (ret) {
+        iTempColorformat = m_stThumbSrcConfig.pix.enc_fmt.in_fmt;
+        iTempWidth = m_stThumbSrcConfig.width;
+        iTempHeight = m_stThumbSrcConfig.height;
+        if (iTempWidth == 0 && iTempHeight == 0) {
             JPEG_ERROR_LOG("ERR(%s):Fail getSize\n", __func__);
-            return ret;
+            return ERROR_SIZE_NOT_SET_YET;
         }
 
         switch (iTempColorformat) {
@@ -917,6 +920,15 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
 
 }
 
+void *ExynosJpegEncoderForCamera::thumbnailThreadFunc(void *data)
+{
+    ExynosJpegEncoderForCamera *pEnc = (ExynosJpegEncoderForCamera *)data;
+
+    pEnc->m_thumbRet = pEnc->encodeThumbnail(&pEnc->m_thumbLen);
+
+    return NULL;
+}
+
 int ExynosJpegEncoderForCamera::createIonClient(ion_client ionClient)
 {
     if (ionClient == 0) {
@@ -957,6 +969,12 @@ int ExynosJpegEncoderForCamera::allocJpegMemory(struct stJpegMem *pstMem, int iM
             break;
         }
 
+        if (m_memoryPool != NULL &&
+            m_memoryPool->Alloc(pstMem->iSize[i], ION_HEAP_SYSTEM_MASK, 0,
+                                &pstMem->ionBuffer[i], &pstMem->pcBuf[i]) == 0) {
+            continue;
+        }
+
         pstMem->ionBuffer[i] = ion_alloc(pstMem->ionClient, \
                                                         pstMem->iSize[i], 0, ION_HEAP_SYSTEM_MASK, 0);
         if ((pstMem->ionBuffer[i] == -1) ||(pstMem->ionBuffer[i] == 0)) {
@@ -989,10 +1007,14 @@ void ExynosJpegEncoderForCamera::freeJpegMemory(struct stJpegMem *pstMem, int iM
 
     for (i=0;i<iMemoryNum;i++) {
         if (pstMem->ionBuffer[i] != -1) {
-            if (pstMem->pcBuf[i] != (char *)MAP_FAILED) {
-                ion_unmap(pstMem->pcBuf[i], pstMem->iSize[i]);
+            if (m_memoryPool != NULL && m_memoryPool->Free(pstMem->ionBuffer[i])) {
+                // stays mapped in the camera pool
+            } else {
+                if (pstMem->pcBuf[i] != (char *)MAP_FAILED) {
+                    ion_unmap(pstMem->pcBuf[i], pstMem->iSize[i]);
+                }
+                ion_free(pstMem->ionBuffer[i]);
             }
-            ion_free(pstMem->ionBuffer[i]);
         }
         pstMem->ionBuffer[i] = -1;
         pstMem->pcBuf[i] = (char *)MAP_FAILED;
@@ -23,10 +23,15 @@
 #include "ExynosJpegApi.h"
 
 #include <sys/mman.h>
+#include <pthread.h>
 #include "ion.h"
 
 #define MAX_IMAGE_PLANE_NUM (3)
 
+namespace android {
+class ExynosCameraMemoryPool;
+};
+
 class ExynosJpegEncoderForCamera {
 public :
     ;
@@ -75,6 +80,7 @@ public :
     bool   flagCreate();
     int     create(void);
     int     destroy(void);
+    void    setMemoryPool(android::ExynosCameraMemoryPool *pool);
 
     int     setSize(int w, int h);
     int     setQuality(int quality);
@@ -127,6 +133,7 @@ private:
                                                         char **dstBuf, unsigned int dstW, unsigned int dstH);
     // thumbnail
     int     encodeThumbnail(unsigned int *size, bool useMain = true);
+    static void *thumbnailThreadFunc(void *data);
 
     struct stJpegMem {
         ion_client ionClient;
@@ -147,6 +154,7 @@ private:
     ExynosJpegEncoder *m_jpegThumb;
 
     ion_client m_ionJpegClient;
+    android::ExynosCameraMemoryPool *m_memoryPool;
     struct stJpegMem m_stThumbInBuf;
     struct stJpegMem m_stThumbOutBuf;
     struct stJpegMem m_stMainInBuf;
@@ -155,6 +163,13 @@ private:
     int m_thumbnailW;
     int m_thumbnailH;
     int m_thumbnailQuality;
+
+    /* snapshot of the main image config taken before the main encode starts,
+     * so the thumbnail thread never reads state the main session is updating */
+    struct ExynosJpegBase::CONFIG m_stThumbSrcConfig;
+    pthread_t m_thumbThread;
+    int m_thumbRet;
+    unsigned int m_thumbLen;
 };
 
 #endif /* __SEC_JPG_ENC_H__ */
@@ -30,15 +30,257 @@
 //#define LOG_NDEBUG 0
 #define LOG_TAG "MetadataConverter"
 #include <utils/Log.h>
+#include <stddef.h>
 
 #include "MetadataConverter.h"
 #include "exynos_format.h"
 
 namespace android {
 
+#define SHOT_EXT_OFFSET(field)  offsetof(struct camera2_shot_ext, field)
+#define SHOT_EXT_FIELD(shot_ext, offset, type)  ((type *)((uint8_t *)(shot_ext) + (offset)))
+
+struct request_tag_desc;
+
+typedef void (*request_tag_converter)(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext);
+
+/*
+ * One row per request tag understood by the ISP. count 0 accepts any number
+ * of elements. Every converter writes all the fields it owns, so an entry can
+ * be re-applied on top of the previous request's result.
+ */
+struct request_tag_desc {
+    uint32_t                tag;
+    uint8_t                 type;
+    size_t                  count;
+    size_t                  offset;
+    int32_t                 bias;
+    request_tag_converter   convert;
+};
+
+static void ConvertFloat(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    *SHOT_EXT_FIELD(dst_ext, desc->offset, float) = entry->data.f[0];
+}
+
+static void ConvertFloatToUint(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    *SHOT_EXT_FIELD(dst_ext, desc->offset, uint32_t) = entry->data.f[0];
+}
+
+/* byte enums are stored as 32-bit enums, shifted by bias */
+static void ConvertByteToUint(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    *SHOT_EXT_FIELD(dst_ext, desc->offset, uint32_t) = entry->data.u8[0] + desc->bias;
+}
+
+static void ConvertByte(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    *SHOT_EXT_FIELD(dst_ext, desc->offset, uint8_t) = entry->data.u8[0];
+}
+
+static void ConvertInt32Array(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    uint32_t * dst = SHOT_EXT_FIELD(dst_ext, desc->offset, uint32_t);
+
+    for (size_t i = 0 ; i < entry->count ; i++)
+        dst[i] = entry->data.i32[i] + desc->bias;
+}
+
+static void ConvertInt64(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    *SHOT_EXT_FIELD(dst_ext, desc->offset, uint64_t) = entry->data.i64[0];
+}
+
+static void ConvertDoubleArray(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    double * dst = SHOT_EXT_FIELD(dst_ext, desc->offset, double);
+
+    for (size_t i = 0 ; i < entry->count ; i++)
+        dst[i] = entry->data.d[i];
+}
+
+static void ConvertCropRegion(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    uint32_t * dst = SHOT_EXT_FIELD(dst_ext, desc->offset, uint32_t);
+
+    for (size_t i = 0 ; i < entry->count ; i++)
+        dst[i] = ALIGN(entry->data.i32[i], 2);
+}
+
+static void ConvertGpsProcessingMethod(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    size_t cnt = entry->count;
+
+    if (cnt > sizeof(dst_ext->gpsProcessingMethod))
+        cnt = sizeof(dst_ext->gpsProcessingMethod);
+    memset(dst_ext->gpsProcessingMethod, 0, sizeof(dst_ext->gpsProcessingMethod));
+    memcpy(dst_ext->gpsProcessingMethod, entry->data.u8, cnt);
+}
+
+static void ConvertAeMode(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    struct camera2_shot * dst = &dst_ext->shot;
+
+    dst->ctl.aa.aeMode = (enum aa_aemode)(entry->data.u8[0] + 2);
+    // skip locked mode
+    if (dst->ctl.aa.aeMode == AA_AEMODE_LOCKED)
+        dst->ctl.aa.aeMode = AA_AEMODE_OFF;
+    ALOGV("DEBUG(%s): ANDROID_CONTROL_AE_MODE (%d)",  __FUNCTION__, dst->ctl.aa.aeMode);
+}
+
+static void ConvertAwbMode(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    struct camera2_shot * dst = &dst_ext->shot;
+
+    dst->ctl.aa.awbMode = (enum aa_awbmode)(entry->data.u8[0] + 2);
+    // skip locked mode
+    if (dst->ctl.aa.awbMode == AA_AWBMODE_LOCKED)
+        dst->ctl.aa.awbMode = AA_AWBMODE_OFF;
+    dst_ext->awb_mode_dm = (enum aa_awbmode)(entry->data.u8[0] + 2);
+}
+
+static void ConvertAfMode(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    struct camera2_shot * dst = &dst_ext->shot;
+
+    dst->ctl.aa.afMode = (enum aa_afmode)(entry->data.u8[0] + 1);
+    if (dst->ctl.aa.afMode == AA_AFMODE_OFF)
+        dst->ctl.aa.afMode = AA_AFMODE_MANUAL;
+}
+
+static void ConvertOutputStreams(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    struct camera2_shot * dst = &dst_ext->shot;
+
+    dst->ctl.request.outputStreams[0] = 0;
+    for (size_t i = 0 ; i < entry->count ; i++) {
+        ALOGV("DEBUG(%s): OUTPUT_STREAM[%d] = %d ",  __FUNCTION__, i, entry->data.u8[i]);
+        dst->ctl.request.outputStreams[0] |= (1 << entry->data.u8[i]);
+    }
+}
+
+static void ConvertInputStreams(const camera_metadata_entry_t * entry,
+    const struct request_tag_desc * desc, struct camera2_shot_ext * dst_ext)
+{
+    dst_ext->reprocessInput = 0;
+    if (entry->count > 0)
+        dst_ext->reprocessInput = entry->data.u8[0];
+    ALOGV("DEBUG(%s): ANDROID_REQUEST_INPUT_STREAMS(%d) = %d ",  __FUNCTION__,
+        entry->count, dst_ext->reprocessInput);
+}
+
+static const struct request_tag_desc requestTagTable[] = {
+    { ANDROID_LENS_FOCUS_DISTANCE,              TYPE_FLOAT,  1, SHOT_EXT_OFFSET(shot.ctl.lens.focusDistance),          0, ConvertFloatToUint },
+    { ANDROID_LENS_APERTURE,                    TYPE_FLOAT,  1, SHOT_EXT_OFFSET(shot.ctl.lens.aperture),               0, ConvertFloat },
+    { ANDROID_LENS_FOCAL_LENGTH,                TYPE_FLOAT,  1, SHOT_EXT_OFFSET(shot.ctl.lens.focalLength),            0, ConvertFloat },
+    { ANDROID_LENS_FILTER_DENSITY,              TYPE_FLOAT,  1, SHOT_EXT_OFFSET(shot.ctl.lens.filterDensity),          0, ConvertFloat },
+    { ANDROID_LENS_OPTICAL_STABILIZATION_MODE,  TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.lens.opticalStabilizationMode), 0, ConvertByteToUint },
+    { ANDROID_SENSOR_TIMESTAMP,                 TYPE_INT64,  1, SHOT_EXT_OFFSET(shot.dm.sensor.timeStamp),             0, ConvertInt64 },
+    { ANDROID_SENSOR_SENSITIVITY,               TYPE_INT32,  1, SHOT_EXT_OFFSET(shot.dm.aa.isoValue),                  0, ConvertInt32Array },
+    { ANDROID_SENSOR_EXPOSURE_TIME,             TYPE_INT64,  1, SHOT_EXT_OFFSET(shot.dm.sensor.exposureTime),          0, ConvertInt64 },
+    { ANDROID_FLASH_MODE,                       TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.flash.flashMode),             1, ConvertByteToUint },
+    { ANDROID_FLASH_FIRING_POWER,               TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.flash.firingPower),           0, ConvertByteToUint },
+    { ANDROID_FLASH_FIRING_TIME,                TYPE_INT64,  1, SHOT_EXT_OFFSET(shot.ctl.flash.firingTime),            0, ConvertInt64 },
+    { ANDROID_SCALER_CROP_REGION,               TYPE_INT32,  3, SHOT_EXT_OFFSET(shot.ctl.scaler.cropRegion),           0, ConvertCropRegion },
+    { ANDROID_JPEG_QUALITY,                     TYPE_INT32,  1, SHOT_EXT_OFFSET(shot.ctl.jpeg.quality),                0, ConvertInt32Array },
+    { ANDROID_JPEG_THUMBNAIL_SIZE,              TYPE_INT32,  2, SHOT_EXT_OFFSET(shot.ctl.jpeg.thumbnailSize),          0, ConvertInt32Array },
+    { ANDROID_JPEG_THUMBNAIL_QUALITY,           TYPE_INT32,  1, SHOT_EXT_OFFSET(shot.ctl.jpeg.thumbnailQuality),       0, ConvertInt32Array },
+    { ANDROID_JPEG_GPS_COORDINATES,             TYPE_DOUBLE, 3, SHOT_EXT_OFFSET(shot.ctl.jpeg.gpsCoordinates),         0, ConvertDoubleArray },
+    { ANDROID_JPEG_GPS_PROCESSING_METHOD,       TYPE_BYTE,   0, SHOT_EXT_OFFSET(gpsProcessingMethod),                  0, ConvertGpsProcessingMethod },
+    { ANDROID_JPEG_GPS_TIMESTAMP,               TYPE_INT64,  1, SHOT_EXT_OFFSET(shot.ctl.jpeg.gpsTimestamp),           0, ConvertInt64 },
+    { ANDROID_JPEG_ORIENTATION,                 TYPE_INT32,  1, SHOT_EXT_OFFSET(shot.ctl.jpeg.orientation),            0, ConvertInt32Array },
+    { ANDROID_STATS_FACE_DETECT_MODE,           TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.stats.faceDetectMode),        1, ConvertByteToUint },
+    { ANDROID_CONTROL_CAPTURE_INTENT,           TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.aa.captureIntent),            0, ConvertByteToUint },
+    { ANDROID_CONTROL_MODE,                     TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.aa.mode),                     1, ConvertByteToUint },
+    { ANDROID_CONTROL_VIDEO_STABILIZATION_MODE, TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.aa.videoStabilizationMode),   0, ConvertByteToUint },
+    { ANDROID_CONTROL_AE_MODE,                  TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.aa.aeMode),                   0, ConvertAeMode },
+    { ANDROID_CONTROL_AE_LOCK,                  TYPE_BYTE,   1, SHOT_EXT_OFFSET(ae_lock),                              0, ConvertByteToUint },
+    { ANDROID_CONTROL_AE_EXP_COMPENSATION,      TYPE_INT32,  1, SHOT_EXT_OFFSET(shot.ctl.aa.aeExpCompensation),        5, ConvertInt32Array },
+    { ANDROID_CONTROL_AWB_MODE,                 TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.aa.awbMode),                  0, ConvertAwbMode },
+    { ANDROID_CONTROL_AWB_LOCK,                 TYPE_BYTE,   1, SHOT_EXT_OFFSET(awb_lock),                             0, ConvertByteToUint },
+    { ANDROID_CONTROL_AF_MODE,                  TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.aa.afMode),                   0, ConvertAfMode },
+    { ANDROID_CONTROL_AF_REGIONS,               TYPE_INT32,  5, SHOT_EXT_OFFSET(shot.ctl.aa.afRegions),                0, ConvertInt32Array },
+    { ANDROID_CONTROL_AE_REGIONS,               TYPE_INT32,  5, SHOT_EXT_OFFSET(shot.ctl.aa.aeRegions),                0, ConvertInt32Array },
+    { ANDROID_REQUEST_ID,                       TYPE_INT32,  1, SHOT_EXT_OFFSET(shot.ctl.request.id),                  0, ConvertInt32Array },
+    { ANDROID_REQUEST_METADATA_MODE,            TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.request.metadataMode),        0, ConvertByteToUint },
+    { ANDROID_REQUEST_OUTPUT_STREAMS,           TYPE_BYTE,   0, SHOT_EXT_OFFSET(shot.ctl.request.outputStreams),       0, ConvertOutputStreams },
+    { ANDROID_REQUEST_INPUT_STREAMS,            TYPE_BYTE,   0, SHOT_EXT_OFFSET(reprocessInput),                       0, ConvertInputStreams },
+    { ANDROID_REQUEST_TYPE,                     TYPE_BYTE,   1, SHOT_EXT_OFFSET(isReprocessing),                       0, ConvertByte },
+    { ANDROID_REQUEST_FRAME_COUNT,              TYPE_INT32,  1, SHOT_EXT_OFFSET(shot.ctl.request.frameCount),          0, ConvertInt32Array },
+    { ANDROID_CONTROL_SCENE_MODE,               TYPE_BYTE,   1, SHOT_EXT_OFFSET(shot.ctl.aa.sceneMode),                1, ConvertByteToUint },
+    { ANDROID_CONTROL_AE_TARGET_FPS_RANGE,      TYPE_INT32,  2, SHOT_EXT_OFFSET(shot.ctl.aa.aeTargetFpsRange),         0, ConvertInt32Array },
+};
+
+#define NUM_REQUEST_TAGS    (sizeof(requestTagTable) / sizeof(requestTagTable[0]))
+
+enum dynamic_tag_kind {
+    DM_COPY,        /* field is added as is */
+    DM_BYTE,        /* 32-bit enum field, shifted down by bias into a byte */
+    DM_INT32,       /* 32-bit field, shifted down by bias */
+    DM_FACES,       /* face statistics, variable length */
+};
+
+struct dynamic_tag_desc {
+    uint32_t                tag;
+    size_t                  count;
+    size_t                  offset;
+    int32_t                 bias;
+    enum dynamic_tag_kind   kind;
+};
+
+static const struct dynamic_tag_desc dynamicTagTable[] = {
+    { ANDROID_REQUEST_ID,                   1,  SHOT_EXT_OFFSET(shot.ctl.request.id),              0, DM_COPY },
+    { ANDROID_REQUEST_METADATA_MODE,        1,  SHOT_EXT_OFFSET(shot.ctl.request.metadataMode),    0, DM_COPY },
+    { ANDROID_REQUEST_FRAME_COUNT,          1,  SHOT_EXT_OFFSET(shot.ctl.request.frameCount),      0, DM_COPY },
+    { ANDROID_SENSOR_TIMESTAMP,             1,  SHOT_EXT_OFFSET(shot.dm.sensor.timeStamp),         0, DM_COPY },
+    { ANDROID_SENSOR_EXPOSURE_TIME,         1,  SHOT_EXT_OFFSET(shot.dm.sensor.exposureTime),      0, DM_COPY },
+    { ANDROID_LENS_APERTURE,                1,  SHOT_EXT_OFFSET(shot.dm.lens.aperture),            0, DM_COPY },
+    { ANDROID_CONTROL_AE_TARGET_FPS_RANGE,  2,  SHOT_EXT_OFFSET(shot.ctl.aa.aeTargetFpsRange),     0, DM_COPY },
+    { ANDROID_CONTROL_AWB_MODE,             1,  SHOT_EXT_OFFSET(awb_mode_dm),                      2, DM_BYTE },
+    { ANDROID_CONTROL_AE_MODE,              1,  SHOT_EXT_OFFSET(shot.dm.aa.aeMode),                1, DM_BYTE },
+    { ANDROID_CONTROL_AF_MODE,              1,  SHOT_EXT_OFFSET(shot.ctl.aa.afMode),               1, DM_BYTE },
+    { ANDROID_CONTROL_SCENE_MODE,           1,  SHOT_EXT_OFFSET(shot.ctl.aa.sceneMode),            1, DM_BYTE },
+    { ANDROID_CONTROL_AE_EXP_COMPENSATION,  1,  SHOT_EXT_OFFSET(shot.ctl.aa.aeExpCompensation),    5, DM_INT32 },
+    { ANDROID_STATS_FACE_DETECT_MODE,       1,  SHOT_EXT_OFFSET(shot.dm.stats.faceDetectMode),     1, DM_BYTE },
+    { ANDROID_STATS_MAX_FACE_COUNT,         0,  0,                                                 0, DM_FACES },
+    { ANDROID_SENSOR_SENSITIVITY,           1,  SHOT_EXT_OFFSET(shot.dm.aa.isoValue),              0, DM_COPY },
+    { ANDROID_SCALER_CROP_REGION,           3,  SHOT_EXT_OFFSET(shot.ctl.scaler.cropRegion),       0, DM_COPY },
+    { ANDROID_CONTROL_AE_STATE,             1,  SHOT_EXT_OFFSET(shot.dm.aa.aeState),               1, DM_BYTE },
+    { ANDROID_CONTROL_AWB_STATE,            1,  SHOT_EXT_OFFSET(shot.dm.aa.awbState),              0, DM_COPY },
+    { ANDROID_JPEG_ORIENTATION,             1,  SHOT_EXT_OFFSET(shot.ctl.jpeg.orientation),        0, DM_COPY },
+    { ANDROID_JPEG_QUALITY,                 1,  SHOT_EXT_OFFSET(shot.ctl.jpeg.quality),            0, DM_COPY },
+    { ANDROID_JPEG_THUMBNAIL_SIZE,          2,  SHOT_EXT_OFFSET(shot.ctl.jpeg.thumbnailSize),      0, DM_COPY },
+    { ANDROID_JPEG_THUMBNAIL_QUALITY,       1,  SHOT_EXT_OFFSET(shot.ctl.jpeg.thumbnailQuality),   0, DM_COPY },
+    { ANDROID_JPEG_GPS_COORDINATES,         3,  SHOT_EXT_OFFSET(shot.ctl.jpeg.gpsCoordinates),     0, DM_COPY },
+    { ANDROID_JPEG_GPS_PROCESSING_METHOD,   32, SHOT_EXT_OFFSET(gpsProcessingMethod),              0, DM_COPY },
+    { ANDROID_JPEG_GPS_TIMESTAMP,           1,  SHOT_EXT_OFFSET(shot.ctl.jpeg.gpsTimestamp),       0, DM_COPY },
+};
+
+#define NUM_DYNAMIC_TAGS    (sizeof(dynamicTagTable) / sizeof(dynamicTagTable[0]))
 
 MetadataConverter::MetadataConverter()
 {
+    m_tagCache = new request_tag_cache_t[NUM_REQUEST_TAGS];
+    memset(m_tagCache, 0, sizeof(request_tag_cache_t) * NUM_REQUEST_TAGS);
+    for (int i = 0 ; i < MAX_TAG_SLOT_HINTS ; i++)
+        m_tagSlotHint[i] = -1;
+    m_generation = 0;
+    m_shotCacheValid = false;
     return;
 }
 
@@ -46,6 +288,7 @@ MetadataConverter::MetadataConverter()
 MetadataConverter::~MetadataConverter()
 {
     ALOGV("DEBUG(%s)destroy!!:", __FUNCTION__);
+    delete [] m_tagCache;
     return;
 }
 
@@ -73,317 +316,115 @@ status_t MetadataConverter::CheckEntryTypeMismatch(camera_metadata_entry_t * ent
     return NO_ERROR;
 }
 
-status_t MetadataConverter::ToInternalShot(camera_metadata_t * request, struct camera2_shot_ext * dst_ext)
+int MetadataConverter::FindRequestTagSlot(uint32_t index, uint32_t tag)
 {
-    uint32_t    num_entry = 0;
-    uint32_t    index = 0;
-    uint32_t    i = 0;
-    uint32_t    cnt = 0;
-    camera_metadata_entry_t curr_entry;
-    struct camera2_shot * dst = NULL;
-
-    if (request == NULL || dst_ext == NULL)
-        return BAD_VALUE;
+    // the framework sends the same tags in the same order frame after frame
+    if (index < MAX_TAG_SLOT_HINTS && m_tagSlotHint[index] >= 0
+            && requestTagTable[m_tagSlotHint[index]].tag == tag)
+        return m_tagSlotHint[index];
+
+    for (size_t slot = 0 ; slot < NUM_REQUEST_TAGS ; slot++) {
+        if (requestTagTable[slot].tag == tag) {
+            if (index < MAX_TAG_SLOT_HINTS)
+                m_tagSlotHint[index] = slot;
+            return slot;
+        }
+    }
+    return -1;
+}
 
-    memset((void*)dst_ext, 0, sizeof(struct camera2_shot_ext));
-    dst = &dst_ext->shot;
+void MetadataConverter::ResetShotCache()
+{
+    struct camera2_shot * dst = &m_shotCache.shot;
 
+    memset(&m_shotCache, 0, sizeof(struct camera2_shot_ext));
     dst->magicNumber = 0x23456789;
     dst->ctl.aa.aeTargetFpsRange[0] = 15;
     dst->ctl.aa.aeTargetFpsRange[1] = 30;
     dst->ctl.aa.aeExpCompensation = 5;
 
+    for (size_t slot = 0 ; slot < NUM_REQUEST_TAGS ; slot++)
+        m_tagCache[slot].cached = false;
+}
+
+void MetadataConverter::ApplyRequestEntries(camera_metadata_t * request)
+{
+    uint32_t    num_entry = 0;
+    uint32_t    index = 0;
+    size_t      dataSize;
+    int         slot;
+    camera_metadata_entry_t curr_entry;
+    const struct request_tag_desc * desc;
+    request_tag_cache_t * cache;
+
     num_entry = (uint32_t)get_camera_metadata_entry_count(request);
     for (index = 0 ; index < num_entry ; index++) {
+        if (get_camera_metadata_entry(request, index, &curr_entry) != 0)
+            continue;
+
+        slot = FindRequestTagSlot(index, curr_entry.tag);
+        if (slot < 0) {
+            ALOGV("DEBUG(%s):Bad Metadata tag (%d)",  __FUNCTION__, curr_entry.tag);
+            continue;
+        }
+        desc = &requestTagTable[slot];
+        if (desc->count == 0) {
+            if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, desc->type))
+                continue;
+        } else {
+            if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, desc->type, desc->count))
+                continue;
+        }
 
-        if (get_camera_metadata_entry(request, index, &curr_entry)==0) {
-            switch (curr_entry.tag) {
-
-            case ANDROID_LENS_FOCUS_DISTANCE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_FLOAT, 1))
-                    break;
-                dst->ctl.lens.focusDistance = curr_entry.data.f[0];
-                break;
-
-            case ANDROID_LENS_APERTURE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_FLOAT, 1))
-                    break;
-                dst->ctl.lens.aperture = curr_entry.data.f[0];
-                break;
-
-            case ANDROID_LENS_FOCAL_LENGTH:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_FLOAT, 1))
-                    break;
-                dst->ctl.lens.focalLength = curr_entry.data.f[0];
-                break;
-
-            case ANDROID_LENS_FILTER_DENSITY:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_FLOAT, 1))
-                    break;
-                dst->ctl.lens.filterDensity = curr_entry.data.f[0];
-                break;
-
-            case ANDROID_LENS_OPTICAL_STABILIZATION_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.lens.opticalStabilizationMode =
-                    (enum optical_stabilization_mode)curr_entry.data.u8[0];
-                break;
-
-
-            case ANDROID_SENSOR_TIMESTAMP:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT64, 1))
-                    break;
-                dst->dm.sensor.timeStamp = curr_entry.data.i64[0];
-                break;
-
-
-            case ANDROID_SENSOR_SENSITIVITY:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 1))
-                    break;
-                dst->dm.aa.isoValue = curr_entry.data.i32[0];
-                break;
-
-            case ANDROID_SENSOR_EXPOSURE_TIME:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT64, 1))
-                    break;
-                dst->dm.sensor.exposureTime = curr_entry.data.i64[0];
-                break;
-
-
-            case ANDROID_FLASH_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.flash.flashMode = (enum flash_mode)(curr_entry.data.u8[0] + 1);
-                break;
-
-            case ANDROID_FLASH_FIRING_POWER:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.flash.firingPower = curr_entry.data.u8[0];
-                break;
-
-            case ANDROID_FLASH_FIRING_TIME:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT64, 1))
-                    break;
-                dst->ctl.flash.firingTime = curr_entry.data.i64[0];
-                break;
-
-
-
-            case ANDROID_SCALER_CROP_REGION:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 3))
-                    break;
-                for (i=0 ; i<curr_entry.count ; i++)
-                    dst->ctl.scaler.cropRegion[i] = ALIGN(curr_entry.data.i32[i], 2);
-                break;
-
-
-            case ANDROID_JPEG_QUALITY:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 1))
-                    break;
-                dst->ctl.jpeg.quality= curr_entry.data.i32[0];
-                break;
-
-            case ANDROID_JPEG_THUMBNAIL_SIZE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 2))
-                    break;
-                for (i=0 ; i<curr_entry.count ; i++)
-                    dst->ctl.jpeg.thumbnailSize[i] = curr_entry.data.i32[i];
-                break;
-
-            case ANDROID_JPEG_THUMBNAIL_QUALITY:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 1))
-                    break;
-                dst->ctl.jpeg.thumbnailQuality= curr_entry.data.i32[0];
-                break;
-
-            case ANDROID_JPEG_GPS_COORDINATES:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_DOUBLE, 3))
-                    break;
-                for (i=0 ; i<curr_entry.count ; i++)
-                    dst->ctl.jpeg.gpsCoordinates[i] = curr_entry.data.d[i];
-                break;
-
-            case ANDROID_JPEG_GPS_PROCESSING_METHOD:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE))
-                    break;
-                if (curr_entry.count > 32)
-                    cnt = 32;
-                else
-                    cnt = curr_entry.count;
-                for (i = 0 ; i < cnt ; i++)
-                    dst_ext->gpsProcessingMethod[i] = curr_entry.data.u8[i];
-                break;
-
-            case ANDROID_JPEG_GPS_TIMESTAMP:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT64, 1))
-                    break;
-                dst->ctl.jpeg.gpsTimestamp = curr_entry.data.i64[0];
-                break;
-
-            case ANDROID_JPEG_ORIENTATION:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 1))
-                    break;
-                dst->ctl.jpeg.orientation = curr_entry.data.i32[0];
-                break;
-
-
-
-            case ANDROID_STATS_FACE_DETECT_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.stats.faceDetectMode = (enum facedetect_mode)(curr_entry.data.u8[0] + 1);
-                break;
-
-            case ANDROID_CONTROL_CAPTURE_INTENT:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.aa.captureIntent = (enum aa_capture_intent)curr_entry.data.u8[0];
-                break;
-
-            case ANDROID_CONTROL_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.aa.mode = (enum aa_mode)(curr_entry.data.u8[0] + 1);
-                break;
-
-
-            case ANDROID_CONTROL_VIDEO_STABILIZATION_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.aa.videoStabilizationMode = curr_entry.data.u8[0];
-                break;
-
-            case ANDROID_CONTROL_AE_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.aa.aeMode = (enum aa_aemode)(curr_entry.data.u8[0] + 2);
-                // skip locked mode
-                if (dst->ctl.aa.aeMode == AA_AEMODE_LOCKED)
-                    dst->ctl.aa.aeMode = AA_AEMODE_OFF;
-                ALOGV("DEBUG(%s): ANDROID_CONTROL_AE_MODE (%d)",  __FUNCTION__, dst->ctl.aa.aeMode);
-                break;
-
-            case ANDROID_CONTROL_AE_LOCK:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst_ext->ae_lock = (enum ae_lockmode)(curr_entry.data.u8[0]);
-                break;
-
-            case ANDROID_CONTROL_AE_EXP_COMPENSATION:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 1))
-                    break;
-                dst->ctl.aa.aeExpCompensation = curr_entry.data.i32[0] + 5;
-                break;
-
-            case ANDROID_CONTROL_AWB_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.aa.awbMode = (enum aa_awbmode)(curr_entry.data.u8[0] + 2);
-                // skip locked mode
-                if (dst->ctl.aa.awbMode == AA_AWBMODE_LOCKED)
-                    dst->ctl.aa.awbMode = AA_AWBMODE_OFF;
-                dst_ext->awb_mode_dm = (enum aa_awbmode)(curr_entry.data.u8[0] + 2);
-                break;
-
-            case ANDROID_CONTROL_AWB_LOCK:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst_ext->awb_lock = (enum awb_lockmode)(curr_entry.data.u8[0]);
-                break;
-
-            case ANDROID_CONTROL_AF_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.aa.afMode = (enum aa_afmode)(curr_entry.data.u8[0] + 1);
-                if (dst->ctl.aa.afMode == AA_AFMODE_OFF)
-                    dst->ctl.aa.afMode = AA_AFMODE_MANUAL;
-                break;
-
-            case ANDROID_CONTROL_AF_REGIONS:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 5))
-                    break;
-                for (i=0 ; i<curr_entry.count ; i++)
-                    dst->ctl.aa.afRegions[i] = curr_entry.data.i32[i];
-                break;
-
-            case ANDROID_CONTROL_AE_REGIONS:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 5))
-                    break;
-                for (i=0 ; i<curr_entry.count ; i++)
-                    dst->ctl.aa.aeRegions[i] = curr_entry.data.i32[i];
-                break;
-
-
-            case ANDROID_REQUEST_ID:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 1))
-                    break;
-                dst->ctl.request.id = curr_entry.data.i32[0];
-                ALOGV("DEBUG(%s): ANDROID_REQUEST_ID (%d)",  __FUNCTION__,  dst->ctl.request.id);
-                break;
-
-            case ANDROID_REQUEST_METADATA_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.request.metadataMode = (enum metadata_mode)curr_entry.data.u8[0];
-                ALOGV("DEBUG(%s): ANDROID_REQUEST_METADATA_MODE (%d)",  __FUNCTION__, (int)( dst->ctl.request.metadataMode));
-                break;
-
-            case ANDROID_REQUEST_OUTPUT_STREAMS:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE))
-                    break;
-
-                dst->ctl.request.outputStreams[0] = 0;
-                for (i=0 ; i<curr_entry.count ; i++) {
-                    ALOGV("DEBUG(%s): OUTPUT_STREAM[%d] = %d ",  __FUNCTION__, i, curr_entry.data.u8[i]);
-                    dst->ctl.request.outputStreams[0] |= (1 << curr_entry.data.u8[i]);
-                }
-                break;
-
-            case ANDROID_REQUEST_INPUT_STREAMS:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE))
-                    break;
-
-                for (i=0 ; i<curr_entry.count ; i++) {
-                    dst_ext->reprocessInput = curr_entry.data.u8[0];
-                    ALOGV("DEBUG(%s): ANDROID_REQUEST_INPUT_STREAMS[%d] = %d ",  __FUNCTION__, i, dst_ext->reprocessInput);
-                }
-                break;
-
-            case ANDROID_REQUEST_TYPE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst_ext->isReprocessing = curr_entry.data.u8[0];
-                ALOGV("DEBUG(%s): ANDROID_REQUEST_TYPE (%d)",  __FUNCTION__, dst_ext->isReprocessing);
-                break;
-
-            case ANDROID_REQUEST_FRAME_COUNT:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 1))
-                    break;
-                dst->ctl.request.frameCount = curr_entry.data.i32[0];
-                ALOGV("DEBUG(%s): ANDROID_REQUEST_FRAME_COUNT (%d)",  __FUNCTION__, dst->ctl.request.frameCount);
-                break;
-
-            case ANDROID_CONTROL_SCENE_MODE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_BYTE, 1))
-                    break;
-                dst->ctl.aa.sceneMode = (enum aa_scene_mode)(curr_entry.data.u8[0] + 1);
-                break;
-
-            case ANDROID_CONTROL_AE_TARGET_FPS_RANGE:
-                if (NO_ERROR != CheckEntryTypeMismatch(&curr_entry, TYPE_INT32, 2))
-                    break;
-                for (i=0 ; i<curr_entry.count ; i++)
-                    dst->ctl.aa.aeTargetFpsRange[i] = curr_entry.data.i32[i];
-                break;
-
-            default:
-                ALOGV("DEBUG(%s):Bad Metadata tag (%d)",  __FUNCTION__, curr_entry.tag);
-                break;
-            }
+        cache = &m_tagCache[slot];
+        cache->seenGeneration = m_generation;
+        dataSize = curr_entry.count * camera_metadata_type_size[curr_entry.type];
+        if (cache->cached && cache->count == curr_entry.count
+                && memcmp(cache->data, curr_entry.data.u8, dataSize) == 0)
+            continue;
+
+        desc->convert(&curr_entry, desc, &m_shotCache);
+
+        if (dataSize <= MAX_CACHED_TAG_DATA) {
+            memcpy(cache->data, curr_entry.data.u8, dataSize);
+            cache->count = curr_entry.count;
+            cache->cached = true;
+        } else {
+            cache->cached = false;
         }
     }
+}
+
+bool MetadataConverter::HasDroppedEntries()
+{
+    for (size_t slot = 0 ; slot < NUM_REQUEST_TAGS ; slot++) {
+        if (m_tagCache[slot].seenGeneration == m_generation - 1)
+            return true;
+    }
+    return false;
+}
+
+status_t MetadataConverter::ToInternalShot(camera_metadata_t * request, struct camera2_shot_ext * dst_ext)
+{
+    struct camera2_shot * dst = NULL;
+
+    if (request == NULL || dst_ext == NULL)
+        return BAD_VALUE;
+
+    // only the entries that differ from the previous request are converted again
+    m_generation++;
+    if (!m_shotCacheValid)
+        ResetShotCache();
+    ApplyRequestEntries(request);
+    if (m_shotCacheValid && HasDroppedEntries()) {
+        // a tag went away, its fields have to fall back to the defaults
+        ResetShotCache();
+        ApplyRequestEntries(request);
+    }
+    m_shotCacheValid = true;
+
+    memcpy(dst_ext, &m_shotCache, sizeof(struct camera2_shot_ext));
+    dst = &dst_ext->shot;
     if (dst->ctl.aa.mode != AA_CONTROL_USE_SCENE_MODE)
         dst->ctl.aa.sceneMode = AA_SCENE_MODE_UNSUPPORTED;
     ApplySceneModeParameters(request, dst_ext);
@@ -509,76 +550,8 @@ status_t MetadataConverter::ApplySceneModeParameters(camera_metadata_t * request
 }
 
 
-status_t MetadataConverter::ToDynamicMetadata(struct camera2_shot_ext * metadata_ext, camera_metadata_t * dst)
+status_t MetadataConverter::AddFaceEntries(struct camera2_shot * metadata, camera_metadata_t * dst)
 {
-    status_t    res;
-    struct camera2_shot * metadata = &metadata_ext->shot;
-    uint8_t  byteData;
-    uint32_t intData;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_REQUEST_ID,
-                &(metadata->ctl.request.id), 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_REQUEST_METADATA_MODE,
-                &(metadata->ctl.request.metadataMode), 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_REQUEST_FRAME_COUNT,
-                &(metadata->ctl.request.frameCount), 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_SENSOR_TIMESTAMP,
-                &metadata->dm.sensor.timeStamp, 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_SENSOR_EXPOSURE_TIME,
-                &metadata->dm.sensor.exposureTime, 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_LENS_APERTURE,
-                &metadata->dm.lens.aperture, 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_CONTROL_AE_TARGET_FPS_RANGE,
-                &(metadata->ctl.aa.aeTargetFpsRange), 2))
-        return NO_MEMORY;
-
-    ALOGV("(%s): ID(%d) METAMODE(%d) FrameCnt(%d) Timestamp(%lld) exposure(%lld) aper(%f)", __FUNCTION__,
-       metadata->ctl.request.id, metadata->ctl.request.metadataMode, metadata->ctl.request.frameCount,
-       metadata->dm.sensor.timeStamp, metadata->dm.sensor.exposureTime, metadata->dm.lens.aperture);
-
-
-    byteData = metadata_ext->awb_mode_dm- 2;
-    if (0 != add_camera_metadata_entry(dst, ANDROID_CONTROL_AWB_MODE,
-                &byteData, 1))
-        return NO_MEMORY;
-
-    byteData = metadata->dm.aa.aeMode - 1;
-    if (0 != add_camera_metadata_entry(dst, ANDROID_CONTROL_AE_MODE,
-                &byteData, 1))
-        return NO_MEMORY;
-
-    byteData = metadata->ctl.aa.afMode - 1;
-    if (0 != add_camera_metadata_entry(dst, ANDROID_CONTROL_AF_MODE,
-                &byteData, 1))
-        return NO_MEMORY;
-
-    byteData = metadata->ctl.aa.sceneMode - 1;
-    if (0 != add_camera_metadata_entry(dst, ANDROID_CONTROL_SCENE_MODE,
-                &byteData, 1))
-        return NO_MEMORY;
-
-    intData = metadata->ctl.aa.aeExpCompensation - 5;
-    if (0 != add_camera_metadata_entry(dst, ANDROID_CONTROL_AE_EXP_COMPENSATION,
-                &intData, 1))
-        return NO_MEMORY;
-
-    byteData = metadata->dm.stats.faceDetectMode - 1;
-    if (0 != add_camera_metadata_entry(dst, ANDROID_STATS_FACE_DETECT_MODE,
-                &byteData, 1))
-        return NO_MEMORY;
-
     int maxFacecount = CAMERA2_MAX_FACES;
     if (0 != add_camera_metadata_entry(dst, ANDROID_STATS_MAX_FACE_COUNT,
                 &maxFacecount, 1))
@@ -617,58 +590,47 @@ status_t MetadataConverter::ToDynamicMetadata(struct camera2_shot_ext * metadata
                     &metaFaceScores, tempFaceCount))
             return NO_MEMORY;
     }
-    if (0 != add_camera_metadata_entry(dst, ANDROID_SENSOR_SENSITIVITY,
-                &metadata->dm.aa.isoValue, 1))
-        return NO_MEMORY;
-
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_SCALER_CROP_REGION,
-                &metadata->ctl.scaler.cropRegion, 3))
-        return NO_MEMORY;
-
-    byteData = metadata->dm.aa.aeState - 1;
-    if (0 != add_camera_metadata_entry(dst, ANDROID_CONTROL_AE_STATE,
-                &byteData, 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_CONTROL_AWB_STATE,
-                &(metadata->dm.aa.awbState), 1))
-        return NO_MEMORY;
-
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_JPEG_ORIENTATION,
-                &metadata->ctl.jpeg.orientation, 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_JPEG_QUALITY,
-                &metadata->ctl.jpeg.quality, 1))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_JPEG_THUMBNAIL_SIZE,
-                &metadata->ctl.jpeg.thumbnailSize, 2))
-        return NO_MEMORY;
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_JPEG_THUMBNAIL_QUALITY,
-                &metadata->ctl.jpeg.thumbnailQuality, 1))
-        return NO_MEMORY;
-
-
-    if (0 != add_camera_metadata_entry(dst, ANDROID_JPEG_GPS_COORDINATES,
-                &(metadata->ctl.jpeg.gpsCoordinates), 3))
-        return NO_MEMORY;
+    return NO_ERROR;
+}
 
-    if (0 != add_camera_metadata_entry(dst, ANDROID_JPEG_GPS_PROCESSING_METHOD,
-                &(metadata_ext->gpsProcessingMethod), 32))
-        return NO_MEMORY;
+status_t MetadataConverter::ToDynamicMetadata(struct camera2_shot_ext * metadata_ext, camera_metadata_t * dst)
+{
+    struct camera2_shot * metadata = &metadata_ext->shot;
+    const struct dynamic_tag_desc * desc;
+    const void * data;
+    uint8_t  byteData;
+    int32_t  intData;
+
+    for (size_t i = 0 ; i < NUM_DYNAMIC_TAGS ; i++) {
+        desc = &dynamicTagTable[i];
+        switch (desc->kind) {
+        case DM_BYTE:
+            byteData = *SHOT_EXT_FIELD(metadata_ext, desc->offset, int32_t) - desc->bias;
+            data = &byteData;
+            break;
+        case DM_INT32:
+            intData = *SHOT_EXT_FIELD(metadata_ext, desc->offset, int32_t) - desc->bias;
+            data = &intData;
+            break;
+        case DM_FACES:
+            if (NO_ERROR != AddFaceEntries(metadata, dst))
+                return NO_MEMORY;
+            continue;
+        default:
+            data = SHOT_EXT_FIELD(metadata_ext, desc->offset, uint8_t);
+            break;
+        }
+        if (0 != add_camera_metadata_entry(dst, desc->tag, data, desc->count))
+            return NO_MEMORY;
+    }
 
-    if (0 != add_camera_metadata_entry(dst, ANDROID_JPEG_GPS_TIMESTAMP,
-                &(metadata->ctl.jpeg.gpsTimestamp), 1))
-        return NO_MEMORY;
+    ALOGV("(%s): ID(%d) METAMODE(%d) FrameCnt(%d) Timestamp(%lld) exposure(%lld) aper(%f)", __FUNCTION__,
+       metadata->ctl.request.id, metadata->ctl.request.metadataMode, metadata->ctl.request.frameCount,
+       metadata->dm.sensor.timeStamp, metadata->dm.sensor.exposureTime, metadata->dm.lens.aperture);
     ALOGV("(%s): AWB(%d) AE(%d) SCENE(%d)  AEComp(%d) AF(%d)", __FUNCTION__,
        metadata_ext->awb_mode_dm- 2, metadata->dm.aa.aeMode - 1, metadata->ctl.aa.sceneMode - 1,
        metadata->ctl.aa.aeExpCompensation, metadata->ctl.aa.afMode - 1);
 
-
     if (metadata->ctl.request.metadataMode == METADATA_MODE_NONE) {
         ALOGV("DEBUG(%s): METADATA_MODE_NONE", __FUNCTION__);
         return NO_ERROR;
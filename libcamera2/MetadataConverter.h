@@ -40,6 +40,16 @@
 
 namespace android {
 
+#define MAX_CACHED_TAG_DATA     (32)
+#define MAX_TAG_SLOT_HINTS      (64)
+
+/* raw payload of a request tag as last converted, used to skip unchanged entries */
+typedef struct request_tag_cache {
+    uint32_t    seenGeneration;
+    bool        cached;
+    uint32_t    count;
+    uint8_t     data[MAX_CACHED_TAG_DATA];
+} request_tag_cache_t;
 
 class MetadataConverter  {
 public:
@@ -53,6 +63,17 @@ private:
     status_t CheckEntryTypeMismatch(camera_metadata_entry_t * entry, uint8_t type);	
     status_t CheckEntryTypeMismatch(camera_metadata_entry_t * entry, uint8_t type, size_t count);
     status_t ApplySceneModeParameters(camera_metadata_t * request, struct camera2_shot_ext * dst_ext);
+    int      FindRequestTagSlot(uint32_t index, uint32_t tag);
+    void     ResetShotCache();
+    void     ApplyRequestEntries(camera_metadata_t * request);
+    bool     HasDroppedEntries();
+    status_t AddFaceEntries(struct camera2_shot * metadata, camera_metadata_t * dst);
+
+    struct camera2_shot_ext     m_shotCache;
+    bool                        m_shotCacheValid;
+    request_tag_cache_t         *m_tagCache;
+    uint32_t                    m_generation;
+    int16_t                     m_tagSlotHint[MAX_TAG_SLOT_HINTS];
 
     uint32_t    metaFaceRectangles[CAMERA2_MAX_FACES][4];
     uint8_t      metaFaceScores[CAMERA2_MAX_FACES];
@@ -33,12 +33,18 @@
 
 //#define LOG_NDEBUG 1
 #define LOG_TAG "SignalDrivenThread"
+#include <string.h>
 #include <utils/Log.h>
 
 #include "SignalDrivenThread.h"
 
 namespace android {
 
+/* upper bounds of the SetSignal to dispatch latency buckets, the last one is open */
+static const nsecs_t signalLatencyBound[NUM_SIGNAL_LATENCY_BUCKETS - 1] = {
+    100000, 500000, 1000000, 5000000, 10000000, 33000000, 100000000
+};
+
 
 SignalDrivenThread::SignalDrivenThread()
     :Thread(false)
@@ -47,6 +53,11 @@ SignalDrivenThread::SignalDrivenThread()
     m_processingSignal = 0;
     m_receivedSignal = 0;
     m_pendingSignal = 0;
+    m_coalescedSignal = 0;
+    m_coalescedCount = 0;
+    m_dispatchTable = NULL;
+    m_dispatchTableNum = 0;
+    memset(m_latencyHist, 0, sizeof(m_latencyHist));
     m_isTerminated = false;    
 }
 
@@ -64,6 +75,11 @@ SignalDrivenThread::SignalDrivenThread(const char* name,
     m_processingSignal = 0;
     m_receivedSignal = 0;
     m_pendingSignal = 0;
+    m_coalescedSignal = 0;
+    m_coalescedCount = 0;
+    m_dispatchTable = NULL;
+    m_dispatchTableNum = 0;
+    memset(m_latencyHist, 0, sizeof(m_latencyHist));
     m_isTerminated = false;
     run(name, priority, stack);
     return;
@@ -79,17 +95,85 @@ status_t SignalDrivenThread::SetSignal(uint32_t signal)
 {
     ALOGV("DEBUG(%s):Setting Signal (%x)", __FUNCTION__, signal);
 
+    nsecs_t now = systemTime();
     Mutex::Autolock lock(m_signalMutex);
     ALOGV("DEBUG(%s):Signal Set     (%x) - prev(%x)", __FUNCTION__, signal, m_receivedSignal);
-    if (m_receivedSignal & signal) {
-        m_pendingSignal |= signal;
-    } else {
-        m_receivedSignal |= signal;
+    uint32_t fresh = signal & ~m_receivedSignal;
+    uint32_t repeat = signal & m_receivedSignal;
+    uint32_t bits;
+
+    // a repeat of a coalesced signal is served by the wakeup already queued
+    if (repeat & m_coalescedSignal) {
+        m_coalescedCount++;
+        repeat &= ~m_coalescedSignal;
     }
+
+    for (bits = fresh; bits; bits &= bits - 1)
+        m_receivedTime[__builtin_ctz(bits)] = now;
+    for (bits = repeat & ~m_pendingSignal; bits; bits &= bits - 1)
+        m_pendingTime[__builtin_ctz(bits)] = now;
+
+    m_receivedSignal |= fresh;
+    m_pendingSignal |= repeat;
     m_threadCondition.signal();
     return NO_ERROR;
 }
 
+void SignalDrivenThread::SetDispatchTable(const signal_dispatch_entry_t *table, int num)
+{
+    Mutex::Autolock lock(m_signalMutex);
+    m_dispatchTable = table;
+    m_dispatchTableNum = num;
+}
+
+void SignalDrivenThread::SetCoalescedSignals(uint32_t signal)
+{
+    Mutex::Autolock lock(m_signalMutex);
+    m_coalescedSignal = signal;
+}
+
+void SignalDrivenThread::DumpSignalLatency()
+{
+    for (int i = 0 ; i < NUM_SIGNAL_BITS ; i++) {
+        uint32_t *hist = m_latencyHist[i];
+        uint32_t total = 0;
+
+        for (int j = 0 ; j < NUM_SIGNAL_LATENCY_BUCKETS ; j++)
+            total += hist[j];
+        if (total == 0)
+            continue;
+
+        ALOGD("DEBUG(%s): signal(%x) cnt(%d) <0.1ms(%d) <0.5ms(%d) <1ms(%d) <5ms(%d) <10ms(%d) <33ms(%d) <100ms(%d) over(%d)",
+            __FUNCTION__, 1 << i, total, hist[0], hist[1], hist[2], hist[3],
+            hist[4], hist[5], hist[6], hist[7]);
+    }
+    if (m_coalescedCount)
+        ALOGD("DEBUG(%s): coalesced signals (%d)", __FUNCTION__, m_coalescedCount);
+}
+
+void SignalDrivenThread::RecordLatency(uint32_t signal, nsecs_t now)
+{
+    for (uint32_t bits = signal; bits; bits &= bits - 1) {
+        int bit = __builtin_ctz(bits);
+        nsecs_t latency = now - m_processingTime[bit];
+        int bucket = 0;
+
+        while (bucket < NUM_SIGNAL_LATENCY_BUCKETS - 1 && latency >= signalLatencyBound[bucket])
+            bucket++;
+        m_latencyHist[bit][bucket]++;
+    }
+}
+
+void SignalDrivenThread::DispatchSignal(uint32_t signal)
+{
+    {
+        Mutex::Autolock lock(m_signalMutex);
+        m_processingSignal = signal;
+    }
+    RecordLatency(signal, systemTime());
+    threadFunctionInternal();
+}
+
 uint32_t SignalDrivenThread::GetProcessingSignal()
 {
     ALOGV("DEBUG(%s): Signal (%x)", __FUNCTION__, m_processingSignal);
@@ -126,6 +210,9 @@ bool SignalDrivenThread::threadLoop()
             m_threadCondition.wait(m_signalMutex);
         }
         m_processingSignal = m_receivedSignal;
+        memcpy(m_processingTime, m_receivedTime, sizeof(m_processingTime));
+        for (uint32_t bits = m_pendingSignal; bits; bits &= bits - 1)
+            m_receivedTime[__builtin_ctz(bits)] = m_pendingTime[__builtin_ctz(bits)];
         m_receivedSignal = m_pendingSignal;
         m_pendingSignal = 0;
     }
@@ -134,6 +221,7 @@ bool SignalDrivenThread::threadLoop()
     if (m_processingSignal & SIGNAL_THREAD_TERMINATE)
     {
         ALOGD("(%s): Thread Terminating by SIGNAL", __func__);
+        DumpSignalLatency();
         Mutex::Autolock lock(m_signalMutex);
         m_isTerminated = true;
         return (false);
@@ -147,7 +235,28 @@ bool SignalDrivenThread::threadLoop()
     if (m_isTerminated)
         m_isTerminated = false;
 
-    threadFunctionInternal();
+    if (m_dispatchTable == NULL) {
+        RecordLatency(m_processingSignal, systemTime());
+        threadFunctionInternal();
+        return true;
+    }
+
+    // one handler call per signal, in table order
+    uint32_t remaining = m_processingSignal;
+    for (int i = 0 ; i < m_dispatchTableNum && remaining ; i++) {
+        const signal_dispatch_entry_t *entry = &m_dispatchTable[i];
+
+        if (!(remaining & entry->signal))
+            continue;
+
+        DispatchSignal(entry->signal);
+        remaining &= ~entry->signal;
+        if (entry->exclusive)
+            remaining = 0;
+    }
+    if (remaining)
+        DispatchSignal(remaining);
+
     return true;
 }
 
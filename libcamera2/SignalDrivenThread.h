@@ -37,6 +37,7 @@
 #define SIGNAL_DRIVEN_THREAD_H
 
 #include <utils/threads.h>
+#include <utils/Timers.h>
 
 namespace android {
 
@@ -45,6 +46,15 @@ namespace android {
 
 #define SIGNAL_THREAD_COMMON_LAST   (1<<3)
 
+#define NUM_SIGNAL_BITS             (32)
+#define NUM_SIGNAL_LATENCY_BUCKETS  (8)
+
+/* one entry of a dispatch table, the table order is the dispatch priority */
+typedef struct signal_dispatch_entry {
+    uint32_t    signal;
+    bool        exclusive;      /* drops the rest of the wakeup once handled */
+} signal_dispatch_entry_t;
+
 class SignalDrivenThread:public Thread {
 public:
                         SignalDrivenThread();
@@ -59,6 +69,9 @@ public:
             void        Start(const char *name,
                             int32_t priority, size_t stack);
             bool        IsTerminated();
+            void        SetDispatchTable(const signal_dispatch_entry_t *table, int num);
+            void        SetCoalescedSignals(uint32_t signal);
+            void        DumpSignalLatency();
 
 private:
             status_t    readyToRun();
@@ -68,10 +81,22 @@ private:
     virtual void        threadFunctionInternal() = 0;
 
             void        ClearSignal();
+            void        DispatchSignal(uint32_t signal);
+            void        RecordLatency(uint32_t signal, nsecs_t now);
 
             uint32_t    m_receivedSignal;
             uint32_t    m_processingSignal;
             uint32_t    m_pendingSignal;
+            uint32_t    m_coalescedSignal;
+            uint32_t    m_coalescedCount;
+
+            const signal_dispatch_entry_t *m_dispatchTable;
+            int         m_dispatchTableNum;
+
+            nsecs_t     m_receivedTime[NUM_SIGNAL_BITS];
+            nsecs_t     m_pendingTime[NUM_SIGNAL_BITS];
+            nsecs_t     m_processingTime[NUM_SIGNAL_BITS];
+            uint32_t    m_latencyHist[NUM_SIGNAL_BITS][NUM_SIGNAL_LATENCY_BUCKETS];
 
             Mutex       m_signalMutex;
             Condition   m_threadCondition;
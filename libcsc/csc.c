@@ -355,16 +355,16 @@ static CSC_ERRORCODE csc_init_hw(
 #endif
         default:
             ALOGE("%s:: unsupported csc_hw_type, csc use sw", __func__);
-            csc_handle->csc_hw_handle == NULL;
+            csc_handle->csc_hw_handle = NULL;
             break;
         }
     }
 
     if (csc_handle->csc_method == CSC_METHOD_HW) {
+        /* keep the handle, the caller may retry or fall back to sw */
         if (csc_handle->csc_hw_handle == NULL) {
             ALOGE("%s:: CSC_METHOD_HW can't open HW", __func__);
-            free(csc_handle);
-            csc_handle = NULL;
+            ret = CSC_Error;
         }
     }
 
@@ -378,6 +378,8 @@ static CSC_ERRORCODE csc_set_format(
 {
     CSC_HANDLE *csc_handle;
     CSC_ERRORCODE ret = CSC_ErrorNone;
+    unsigned int dst_width;
+    unsigned int dst_height;
 
     if (handle == NULL)
         return CSC_ErrorNotInit;
@@ -389,6 +391,16 @@ static CSC_ERRORCODE csc_set_format(
             break;
 #ifdef ENABLE_GSCALER
         case CSC_HW_TYPE_GSCALER:
+            /* a single buffer YUV420 frame puts its chroma at the exact width * height */
+            if ((csc_handle->dst_format.color_format == HAL_PIXEL_FORMAT_YCrCb_420_SP) ||
+                (csc_handle->dst_format.color_format == HAL_PIXEL_FORMAT_YV12)) {
+                dst_width = csc_handle->dst_format.width;
+                dst_height = csc_handle->dst_format.height;
+            } else {
+                dst_width = ALIGN(csc_handle->dst_format.width, GSCALER_IMG_ALIGN);
+                dst_height = ALIGN(csc_handle->dst_format.height, GSCALER_IMG_ALIGN);
+            }
+
             exynos_gsc_set_src_format(
                 csc_handle->csc_hw_handle,
                 ALIGN(csc_handle->src_format.width, GSCALER_IMG_ALIGN),
@@ -403,8 +415,8 @@ static CSC_ERRORCODE csc_set_format(
 
             exynos_gsc_set_dst_format(
                 csc_handle->csc_hw_handle,
-                ALIGN(csc_handle->dst_format.width, GSCALER_IMG_ALIGN),
-                ALIGN(csc_handle->dst_format.height, GSCALER_IMG_ALIGN),
+                dst_width,
+                dst_height,
                 csc_handle->dst_format.crop_left,
                 csc_handle->dst_format.crop_top,
                 csc_handle->dst_format.crop_width,
@@ -711,8 +723,11 @@ CSC_ERRORCODE csc_convert(
         return CSC_ErrorNotInit;
 
     if ((csc_handle->csc_method == CSC_METHOD_HW) &&
-        (csc_handle->csc_hw_handle == NULL))
-        csc_init_hw(handle);
+        (csc_handle->csc_hw_handle == NULL)) {
+        ret = csc_init_hw(handle);
+        if (ret != CSC_ErrorNone)
+            return ret;
+    }
 
     csc_set_format(csc_handle);
     csc_set_buffer(csc_handle);
@@ -79,6 +79,10 @@ int HAL_PIXEL_FORMAT_2_V4L2_PIX(
         v4l2_pixel_format = V4L2_PIX_FMT_YVU420M;
         break;
 
+    case HAL_PIXEL_FORMAT_YV12:
+        v4l2_pixel_format = V4L2_PIX_FMT_YVU420;
+        break;
+
     case HAL_PIXEL_FORMAT_YCbCr_420_P:
         v4l2_pixel_format = V4L2_PIX_FMT_YUV420M;
         break;
@@ -117,6 +121,10 @@ int HAL_PIXEL_FORMAT_2_V4L2_PIX(
         v4l2_pixel_format = V4L2_PIX_FMT_NV21M;
         break;
 
+    case HAL_PIXEL_FORMAT_YCrCb_420_SP:
+        v4l2_pixel_format = V4L2_PIX_FMT_NV21;
+        break;
+
    case HAL_PIXEL_FORMAT_YCbCr_420_SP_TILED:
         v4l2_pixel_format = V4L2_PIX_FMT_NV12MT_16X16;
         break;
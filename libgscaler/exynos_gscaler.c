@@ -62,12 +62,13 @@ static unsigned int m_gsc_get_plane_count(
     case V4L2_PIX_FMT_UYVY:
     case V4L2_PIX_FMT_NV16:
     case V4L2_PIX_FMT_NV61:
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_YVU420:
         plane_count = 1;
         break;
     case V4L2_PIX_FMT_NV12M:
     case V4L2_PIX_FMT_NV12MT_16X16:
-    case V4L2_PIX_FMT_NV12:
-    case V4L2_PIX_FMT_NV21:
     case V4L2_PIX_FMT_NV21M:
         plane_count = 2;
         break;
@@ -114,10 +115,15 @@ static unsigned int m_gsc_get_plane_size(
         plane_size[1] = 0;
         plane_size[2] = 0;
         break;
-    /* 2 planes */
-    case V4L2_PIX_FMT_NV12M:
     case V4L2_PIX_FMT_NV12:
     case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_YVU420:
+        plane_size[0] = width * height * 3 / 2;
+        plane_size[1] = 0;
+        plane_size[2] = 0;
+        break;
+    /* 2 planes */
+    case V4L2_PIX_FMT_NV12M:
     case V4L2_PIX_FMT_NV21M:
         plane_size[0] = width * height;
         plane_size[1] = width * (height / 2);
@@ -274,6 +280,7 @@ static bool m_exynos_gsc_check_dst_size(
     case V4L2_PIX_FMT_NV21M:
     case V4L2_PIX_FMT_YUV420M:
     case V4L2_PIX_FMT_YVU420M:
+    case V4L2_PIX_FMT_YVU420:
         *new_w = m_exynos_gsc_multiple_of_n(*new_w, 2);
         *new_h = m_exynos_gsc_multiple_of_n(*new_h, 2);
         break;
@@ -194,7 +194,7 @@ int ExynosJpegBase::t_v4l2Reqbufs(int iFd, int iBufCount, struct BUF_INFO *pstBu
     return iRet;
 }
 
-int ExynosJpegBase::t_v4l2Qbuf(int iFd, struct BUF_INFO *pstBufInfo, struct BUFFER *pstBuf)
+int ExynosJpegBase::t_v4l2Qbuf(int iFd, struct BUF_INFO *pstBufInfo, struct BUFFER *pstBuf, int iIndex)
 {
     struct v4l2_buffer v4l2_buf;
     struct v4l2_plane plane[JPEG_MAX_PLANE_CNT];
@@ -204,7 +204,7 @@ int ExynosJpegBase::t_v4l2Qbuf(int iFd, struct BUF_INFO *pstBufInfo, struct BUFF
     memset(&v4l2_buf, 0, sizeof(struct v4l2_buffer));
     memset(plane, 0, (int)JPEG_MAX_PLANE_CNT * sizeof(struct v4l2_plane));
 
-    v4l2_buf.index = 0;
+    v4l2_buf.index = iIndex;
     v4l2_buf.type = pstBufInfo->buf_type;
     v4l2_buf.memory = pstBufInfo->memory;
     v4l2_buf.field = V4L2_FIELD_ANY;
@@ -317,6 +317,74 @@ int ExynosJpegBase::t_v4l2GetCtrl(int iFd, int iCid)
     return ctrl.value;
 }
 
+/*
+ * The S_FMT/REQBUFS negotiation only has to be redone when something the
+ * driver was told about changes. A decoder's compressed input may shrink
+ * freely, it only needs a new format when it outgrows the negotiated size.
+ */
+bool ExynosJpegBase::t_isConfigChanged(int iInBufs, int iOutBufs, int iInBufPlanes, int iOutBufPlanes)
+{
+    struct CONFIG *pstApplied = &t_stJpegConfigApplied;
+
+    if (t_bFlagConfigApplied == false)
+        return true;
+
+    if ((t_iInBufCnt != iInBufs) || (t_iOutBufCnt != iOutBufs))
+        return true;
+
+    if (pstApplied->numOfPlanes != iOutBufPlanes)
+        return true;
+
+    if ((pstApplied->mode != t_stJpegConfig.mode) ||
+        (pstApplied->width != t_stJpegConfig.width) ||
+        (pstApplied->height != t_stJpegConfig.height) ||
+        (pstApplied->pix.enc_fmt.in_fmt != t_stJpegConfig.pix.enc_fmt.in_fmt) ||
+        (pstApplied->pix.enc_fmt.out_fmt != t_stJpegConfig.pix.enc_fmt.out_fmt))
+        return true;
+
+    if (t_stJpegConfig.mode == MODE_DECODE) {
+        if ((pstApplied->scaled_width != t_stJpegConfig.scaled_width) ||
+            (pstApplied->scaled_height != t_stJpegConfig.scaled_height) ||
+            (pstApplied->sizeJpeg < t_stJpegConfig.sizeJpeg))
+            return true;
+    }
+
+    return false;
+}
+
+int ExynosJpegBase::t_releaseStream(void)
+{
+    struct BUF_INFO stBufInfo;
+    int iRet = ERROR_NONE;
+
+    if (t_bFlagStreamOn == true) {
+        if (t_v4l2StreamOff(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE) < 0)
+            iRet = ERROR_FAIL;
+        if (t_v4l2StreamOff(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) < 0)
+            iRet = ERROR_FAIL;
+        t_bFlagStreamOn = false;
+    }
+
+    if (t_bFlagConfigApplied == true) {
+        stBufInfo.memory = V4L2_MEMORY_DMABUF;
+
+        stBufInfo.numOfPlanes = t_iInBufCnt;
+        stBufInfo.buf_type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+        t_v4l2Reqbufs(t_iJpegFd, 0, &stBufInfo);
+
+        stBufInfo.numOfPlanes = t_iOutBufCnt;
+        stBufInfo.buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        t_v4l2Reqbufs(t_iJpegFd, 0, &stBufInfo);
+
+        t_bFlagConfigApplied = false;
+    }
+
+    t_iInBufIdx = 0;
+    t_iOutBufIdx = 0;
+
+    return iRet;
+}
+
 int ExynosJpegBase::create(enum MODE eMode)
 {
     if (t_bFlagCreate == true) {
@@ -367,9 +435,17 @@ int ExynosJpegBase::create(enum MODE eMode)
     t_bFlagCreateInBuf = false;
     t_bFlagCreateOutBuf = false;
     t_bFlagExcute = false;
+    t_bFlagStreamOn = false;
+    t_bFlagConfigApplied = false;
 
     t_iPlaneNum = 0;
 
+    t_iInBufCnt = 0;
+    t_iOutBufCnt = 0;
+    t_iInBufIdx = 0;
+    t_iOutBufIdx = 0;
+    memset(&t_stJpegConfigApplied, 0, sizeof(struct CONFIG));
+
     return ERROR_NONE;
 }
 
@@ -380,24 +456,7 @@ int ExynosJpegBase::destroy(int iInBufs, int iOutBufs)
     }
 
     if (t_iJpegFd > 0) {
-        struct BUF_INFO stBufInfo;
-
-        if (t_bFlagExcute) {
-            t_v4l2StreamOff(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE);
-            t_v4l2StreamOff(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
-        }
-
-        if (t_bFlagExcute) {
-            stBufInfo.numOfPlanes = iInBufs;
-            stBufInfo.memory = V4L2_MEMORY_MMAP;
-
-            stBufInfo.buf_type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
-            t_v4l2Reqbufs(t_iJpegFd, 0, &stBufInfo);
-
-            stBufInfo.numOfPlanes = iOutBufs;
-            stBufInfo.buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
-            t_v4l2Reqbufs(t_iJpegFd, 0, &stBufInfo);
-        }
+        t_releaseStream();
 
         close(t_iJpegFd);
     }
@@ -708,17 +767,29 @@ int ExynosJpegBase::updateConfig(enum MODE eMode, int iInBufs, int iOutBufs, int
 
     int iRet = ERROR_NONE;
 
-    if (eMode == MODE_ENCODE) {
+    if ((eMode == MODE_ENCODE) &&
+        ((t_bFlagConfigApplied == false) ||
+         (t_stJpegConfigApplied.enc_qual != t_stJpegConfig.enc_qual))) {
         iRet = t_v4l2SetJpegcomp(t_iJpegFd, t_stJpegConfig.enc_qual);
         if (iRet < 0) {
             JPEG_ERROR_LOG("[%s,%d]: S_JPEGCOMP failed\n", __func__,iRet);
             return ERROR_INVALID_JPEG_CONFIG;
         }
+        t_stJpegConfigApplied.enc_qual = t_stJpegConfig.enc_qual;
     }
 
-    t_stJpegConfig.numOfPlanes = iInBufPlanes;
     t_stJpegConfig.mode = eMode;
 
+    // keep the device streaming when the previous negotiation still holds
+    if (t_isConfigChanged(iInBufs, iOutBufs, iInBufPlanes, iOutBufPlanes) == false) {
+        t_stJpegConfig.numOfPlanes = iOutBufPlanes;
+        return ERROR_NONE;
+    }
+
+    t_releaseStream();
+
+    t_stJpegConfig.numOfPlanes = iInBufPlanes;
+
     iRet = t_v4l2SetFmt(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, &t_stJpegConfig);
     if (iRet < 0) {
         JPEG_ERROR_LOG("[%s,%d]: jpeg input S_FMT failed\n", __func__,iRet);
@@ -753,6 +824,13 @@ int ExynosJpegBase::updateConfig(enum MODE eMode, int iInBufs, int iOutBufs, int
         return ERROR_REQBUF_FAIL;
     }
 
+    memcpy(&t_stJpegConfigApplied, &t_stJpegConfig, sizeof(struct CONFIG));
+    t_iInBufCnt = iInBufs;
+    t_iOutBufCnt = iOutBufs;
+    t_iInBufIdx = 0;
+    t_iOutBufIdx = 0;
+    t_bFlagConfigApplied = true;
+
     return ERROR_NONE;
 }
 
@@ -762,6 +840,10 @@ int ExynosJpegBase::execute(int iInBufPlanes, int iOutBufPlanes)
         return ERROR_JPEG_DEVICE_NOT_CREATE_YET;
     }
 
+    if (t_bFlagConfigApplied == false) {
+        return ERROR_INVALID_JPEG_CONFIG;
+    }
+
     struct BUF_INFO stBufInfo;
     int iRet = ERROR_NONE;
 
@@ -772,43 +854,56 @@ int ExynosJpegBase::execute(int iInBufPlanes, int iOutBufPlanes)
 
     stBufInfo.memory = V4L2_MEMORY_DMABUF;
 
-    iRet = t_v4l2Qbuf(t_iJpegFd, &stBufInfo, &t_stJpegInbuf);
+    iRet = t_v4l2Qbuf(t_iJpegFd, &stBufInfo, &t_stJpegInbuf, t_iInBufIdx);
     if (iRet < 0) {
         JPEG_ERROR_LOG("[%s:%d]: Input QBUF failed\n", __func__, iRet);
+        t_releaseStream();
         return ERROR_EXCUTE_FAIL;
     }
 
     stBufInfo.numOfPlanes = iOutBufPlanes;
     stBufInfo.buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
 
-    iRet = t_v4l2Qbuf(t_iJpegFd, &stBufInfo, &t_stJpegOutbuf);
+    iRet = t_v4l2Qbuf(t_iJpegFd, &stBufInfo, &t_stJpegOutbuf, t_iOutBufIdx);
     if (iRet < 0) {
         JPEG_ERROR_LOG("[%s:%d]: Output QBUF failed\n", __func__, iRet);
+        t_releaseStream();
         return ERROR_EXCUTE_FAIL;
     }
 
-    iRet = t_v4l2StreamOn(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE);
-    if (iRet < 0) {
-        JPEG_ERROR_LOG("[%s:%d]: input stream on failed\n", __func__, iRet);
-        return ERROR_EXCUTE_FAIL;
-    }
-    iRet = t_v4l2StreamOn(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
-    if (iRet < 0) {
-        JPEG_ERROR_LOG("[%s:%d]: output stream on failed\n", __func__, iRet);
-        return ERROR_EXCUTE_FAIL;
+    t_iInBufIdx = (t_iInBufIdx + 1) % t_iInBufCnt;
+    t_iOutBufIdx = (t_iOutBufIdx + 1) % t_iOutBufCnt;
+
+    // the queues stay on across images until the configuration changes
+    if (t_bFlagStreamOn == false) {
+        iRet = t_v4l2StreamOn(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE);
+        if (iRet < 0) {
+            JPEG_ERROR_LOG("[%s:%d]: input stream on failed\n", __func__, iRet);
+            t_releaseStream();
+            return ERROR_EXCUTE_FAIL;
+        }
+        iRet = t_v4l2StreamOn(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
+        if (iRet < 0) {
+            JPEG_ERROR_LOG("[%s:%d]: output stream on failed\n", __func__, iRet);
+            t_v4l2StreamOff(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE);
+            t_releaseStream();
+            return ERROR_EXCUTE_FAIL;
+        }
+        t_bFlagStreamOn = true;
     }
 
     iRet = t_v4l2Dqbuf(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, V4L2_MEMORY_MMAP, iInBufPlanes);
     if (iRet < 0) {
         JPEG_ERROR_LOG("[%s:%d]: Intput DQBUF failed\n", __func__, iRet);
+        t_releaseStream();
         return ERROR_EXCUTE_FAIL;
     }
     iRet = t_v4l2Dqbuf(t_iJpegFd, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, V4L2_MEMORY_MMAP, iOutBufPlanes);
     if (iRet < 0) {
         JPEG_ERROR_LOG("[%s:%d]: Output DQBUF failed\n", __func__, iRet);
+        t_releaseStream();
         return ERROR_EXCUTE_FAIL;
     }
 
     return ERROR_NONE;
 }
-
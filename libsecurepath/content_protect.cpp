@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <pthread.h>
 
 #include "tlwvdrm_api.h"
 #define LOG_TAG "drm_content_protect"
@@ -22,12 +23,27 @@
 #include "tlc_communication.h"
 #include "content_protect.h"
 
+#define CP_PROTECT_IP_NUM	5
+
 mc_comm_ctx cp_ctx;
 
+/*
+ * The trustlet session is opened on first use and kept for the lifetime of
+ * the process, so toggling protection on every secure buffer cycle costs a
+ * single notify/wait round trip instead of a full device/WSM/session setup.
+ * Each protect_ip bit is reference counted; the trustlet is only told about
+ * bits whose count moves between zero and non-zero.
+ */
+static pthread_mutex_t cp_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t cp_ip_refcount[CP_PROTECT_IP_NUM];
+
 // -------------------------------------------------------------
 static mcResult_t tlc_initialize(void) {
 	mcResult_t	mcRet;
 
+	if (cp_ctx.initialized == true)
+		return MC_DRV_OK;
+
 	memset(&cp_ctx, 0x00, sizeof(cp_ctx));
 	cp_ctx.device_id	= MC_DEVICE_ID_DEFAULT;
 	cp_ctx.uuid 	= (mcUuid_t)TL_WV_DRM_UUID;
@@ -35,8 +51,8 @@ static mcResult_t tlc_initialize(void) {
 
 	mcRet = tlc_open(&cp_ctx);
 	if (MC_DRV_OK != mcRet) {
-		   
-		   return mcRet;
+		LOG_E("tlc_open failed: %d", mcRet);
+		return mcRet;
 	}
 
 	cp_ctx.initialized = true;
@@ -51,8 +67,8 @@ static mcResult_t tlc_terminate(void) {
 	if (cp_ctx.initialized == true) {
 		mcRet = tlc_close(&cp_ctx);
 		if (MC_DRV_OK != mcRet) {
-			  
-			   return mcRet;
+			LOG_E("tlc_close failed: %d", mcRet);
+			return mcRet;
 		}
 
 		memset(&cp_ctx, 0x00, sizeof(cp_ctx));
@@ -62,131 +78,113 @@ static mcResult_t tlc_terminate(void) {
 	return MC_DRV_OK;
 }
 
+// -------------------------------------------------------------
+static bool tlc_path_protection(uint32_t cmd_id, uint32_t protect_ip) {
+	mcResult_t mcRet;
+	tciMessage_t *tci = NULL;
+
+	// -------------------------------------------------------------
+	// Step 1: Reuse the cached Trustlet session, opening it if needed.
+	mcRet = tlc_initialize();
+	if (MC_DRV_OK != mcRet)
+		return false;
+
+	// -------------------------------------------------------------
+	// Step 2: Check TCI buffer.
+	tci = cp_ctx.tci_msg;
+	if (NULL == tci)
+		return false;
+
+	// -------------------------------------------------------------
+	// Step 3: Call the Trustlet functions
+	// Step 3.1: Prepare command message in TCI
+	tci->cmd.id = cmd_id;
+	memcpy(tci->cmd.data, &protect_ip, sizeof(protect_ip));
+	tci->cmd.data_len = sizeof(protect_ip);
+
+	// -------------------------------------------------------------
+	// Step 3.2: Send Trustlet TCI Message
+	mcRet = tlc_communicate(&cp_ctx);
+	if (MC_DRV_OK != mcRet) {
+		LOG_E("tlc_communicate failed: %d", mcRet);
+		// The session may be stale; reopen it on the next request.
+		tlc_terminate();
+		return false;
+	}
+
+	// -------------------------------------------------------------
+	// Step 3.3: Verify that the Trustlet sent a response
+	if ((RSP_ID(cmd_id) != tci->resp.id)) {
+		LOG_E("unexpected response id 0x%08x", tci->resp.id);
+		return false;
+	}
+
+	// -------------------------------------------------------------
+	// Step 3.4: Check the Trustlet return code
+	if (tci->resp.return_code != RET_TL_WV_DRM_OK) {
+		LOG_E("trustlet returned 0x%08x", tci->resp.return_code);
+		return false;
+	}
+
+	return true;
+}
+
 extern "C" cpResult_t CP_Enable_Path_Protection(uint32_t protect_ip)
 {
 	cpResult_t cp_result = CP_SUCCESS;
-	mcResult_t mcRet;
-	tciMessage_t *tci = NULL;
+	uint32_t new_ip = 0;
+	int i;
 
-	
-	do {
-		// -------------------------------------------------------------
-		// Step 1: Call the Trustlet Open function.
-		mcRet = tlc_initialize();
-		if (MC_DRV_OK != mcRet) {
-			
-			cp_result = CP_ERROR_ENABLE_PATH_PROTECTION_FAILED;
-			break;
-		}
+	pthread_mutex_lock(&cp_lock);
 
-		// -------------------------------------------------------------
-		// Step 2: Check TCI buffer.
-		tci = cp_ctx.tci_msg;
-		if (NULL == tci) {
-			
-			cp_result = CP_ERROR_ENABLE_PATH_PROTECTION_FAILED;
-			break;
-		}
-		
-		// -------------------------------------------------------------
-		// Step 3: Call the Trustlet functions
-		// Step 3.1: Prepare command message in TCI
-		tci->cmd.id = CMD_WV_DRM_ENABLE_PATH_PROTECTION;
-		memcpy(tci->cmd.data, &protect_ip, sizeof(protect_ip));
-		tci->cmd.data_len = sizeof(protect_ip);
-
-		// -------------------------------------------------------------
-		// Step 3.2: Send Trustlet TCI Message
-		mcRet = tlc_communicate(&cp_ctx);
-		if (MC_DRV_OK != mcRet) {
-			
-			cp_result = CP_ERROR_ENABLE_PATH_PROTECTION_FAILED;
-			break;
-		}
+	for (i = 0; i < CP_PROTECT_IP_NUM; i++) {
+		if ((protect_ip & (1 << i)) && cp_ip_refcount[i] == 0)
+			new_ip |= (1 << i);
+	}
 
-		// -------------------------------------------------------------
-		// Step 3.3: Verify that the Trustlet sent a response
-		if ((RSP_ID(CMD_WV_DRM_ENABLE_PATH_PROTECTION) != tci->resp.id)) {
-			
-			cp_result = CP_ERROR_ENABLE_PATH_PROTECTION_FAILED;
-			break;
+	if (new_ip != 0 &&
+	    tlc_path_protection(CMD_WV_DRM_ENABLE_PATH_PROTECTION, new_ip) == false)
+		cp_result = CP_ERROR_ENABLE_PATH_PROTECTION_FAILED;
+
+	if (cp_result == CP_SUCCESS) {
+		for (i = 0; i < CP_PROTECT_IP_NUM; i++) {
+			if (protect_ip & (1 << i))
+				cp_ip_refcount[i]++;
 		}
+	}
+
+	pthread_mutex_unlock(&cp_lock);
 
-		// -------------------------------------------------------------
-		// Step 3.4: Check the Trustlet return code
-		if (tci->resp.return_code != RET_TL_WV_DRM_OK) {
-			
-			cp_result = CP_ERROR_ENABLE_PATH_PROTECTION_FAILED;
-			break;
-		}		
-	} while(0);
-
-	tlc_terminate();
-	
 	return cp_result;
 }
 
 extern "C" cpResult_t CP_Disable_Path_Protection(uint32_t protect_ip)
 {
 	cpResult_t cp_result = CP_SUCCESS;
-	mcResult_t mcRet;
-	tciMessage_t *tci = NULL;
+	uint32_t last_ip = 0;
+	int i;
 
-	
-	do {
-		// -------------------------------------------------------------
-		// Step 1: Call the Trustlet Open function.
-		mcRet = tlc_initialize();
-		if (MC_DRV_OK != mcRet) {
-			
-			cp_result = CP_ERROR_DISABLE_PATH_PROTECTION_FAILED;
-			break;
-		}
+	pthread_mutex_lock(&cp_lock);
 
-		// -------------------------------------------------------------
-		// Step 2: Check TCI buffer.
-		tci = cp_ctx.tci_msg;
-		if (NULL == tci) {
-			
-			cp_result = CP_ERROR_DISABLE_PATH_PROTECTION_FAILED;
-			break;
-		}
-		
-		// -------------------------------------------------------------
-		// Step 3: Call the Trustlet functions
-		// Step 3.1: Prepare command message in TCI
-		tci->cmd.id = CMD_WV_DRM_DISABLE_PATH_PROTECTION;
-		memcpy(tci->cmd.data, &protect_ip, sizeof(protect_ip));
-		tci->cmd.data_len = sizeof(protect_ip);
-
-		// -------------------------------------------------------------
-		// Step 3.2: Send Trustlet TCI Message
-		mcRet = tlc_communicate(&cp_ctx);
-		if (MC_DRV_OK != mcRet) {
-			
-			cp_result = CP_ERROR_DISABLE_PATH_PROTECTION_FAILED;
-			break;
-		}
+	for (i = 0; i < CP_PROTECT_IP_NUM; i++) {
+		if ((protect_ip & (1 << i)) && cp_ip_refcount[i] == 1)
+			last_ip |= (1 << i);
+	}
 
-		// -------------------------------------------------------------
-		// Step 3.3: Verify that the Trustlet sent a response
-		if ((RSP_ID(CMD_WV_DRM_DISABLE_PATH_PROTECTION) != tci->resp.id)) {
-			
-			cp_result = CP_ERROR_DISABLE_PATH_PROTECTION_FAILED;
-			break;
-		}
+	if (last_ip != 0 &&
+	    tlc_path_protection(CMD_WV_DRM_DISABLE_PATH_PROTECTION, last_ip) == false)
+		cp_result = CP_ERROR_DISABLE_PATH_PROTECTION_FAILED;
+
+	/*
+	 * Drop the references even on failure: the caller treats the IP as
+	 * unprotected from here on and will not retry the disable.
+	 */
+	for (i = 0; i < CP_PROTECT_IP_NUM; i++) {
+		if ((protect_ip & (1 << i)) && cp_ip_refcount[i] > 0)
+			cp_ip_refcount[i]--;
+	}
+
+	pthread_mutex_unlock(&cp_lock);
 
-		// -------------------------------------------------------------
-		// Step 3.4: Check the Trustlet return code
-		if (tci->resp.return_code != RET_TL_WV_DRM_OK) {
-			
-			cp_result = CP_ERROR_DISABLE_PATH_PROTECTION_FAILED;
-			break;
-		}		
-	} while(0);
-
-	tlc_terminate();
-	
 	return cp_result;
 }
-
@@ -6,6 +6,7 @@ LOCAL_MODULE_TAGS := optional
 
 LOCAL_SRC_FILES := \
 	swconvertor.c \
+	csc_scale_down_yuv422.c \
 	csc_tiled_to_linear_y_neon.s \
 	csc_tiled_to_linear_uv_neon.s \
 	csc_tiled_to_linear_uv_deinterleave_neon.s \
@@ -0,0 +1,660 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file    csc_scale_down_yuv422.c
+ *
+ * @brief   Area averaging down scaler for YUV422 images, YUYV to NV21
+ *
+ * @version 1.0
+ *
+ * @history
+ *   2012.11.01 : Create
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "swconverter.h"
+
+/*
+ * Every destination sample is the average of the source rectangle it
+ * covers. The source is partitioned on whole-sample boundaries, so each
+ * destination row/column owns [bound[i], bound[i + 1]) of the source.
+ * Source rows are summed into a 16-bit row accumulator with SIMD, then
+ * every destination sample adds up its columns and is normalized with a
+ * Q16 reciprocal of the box area.
+ *
+ * When both ratios are whole numbers and a box holds a power of two
+ * samples (2x2, 4x4, ...), every box has the same shape, so its columns
+ * are added with a fixed count and normalized with a shift instead.
+ */
+#define SCALE_MAX_RATIO         (256)
+#define SCALE_MAX_THREADS       (4)
+#define SCALE_MIN_BAND_ROWS     (32)
+#define SCALE_MAX_COMPONENTS    (3)
+#define SCALE_RECIP_SHIFT       (16)
+
+typedef struct {
+    unsigned int  src_offset;   /* first byte of the component in a row */
+    unsigned int  src_step;     /* bytes between two samples */
+    unsigned int  dst_offset;
+    unsigned int  dst_step;
+    unsigned int  dst_count;    /* samples per destination row */
+    unsigned int *bound;        /* dst_count + 1 source sample boundaries */
+} SCALE_COMPONENT;
+
+typedef struct {
+    unsigned char   *src;
+    unsigned int     src_stride;
+    unsigned char   *dst;
+    unsigned int     dst_stride;
+    unsigned int     row_bytes;
+    unsigned int    *row_bound;
+    unsigned int    *recip;
+    SCALE_COMPONENT  comp[SCALE_MAX_COMPONENTS];
+    unsigned int     comp_num;
+    unsigned int     box_cols;      /* 0 unless every box is box_cols wide */
+    unsigned int     box_shift;     /* log2 of the box area */
+    unsigned int     dst_row_start;
+    unsigned int     dst_row_end;
+    int              ret;
+} SCALE_PLANE;
+
+static unsigned int *scale_make_bound(unsigned int src_count, unsigned int dst_count)
+{
+    unsigned int *bound;
+    unsigned int i;
+
+    bound = (unsigned int *)malloc((dst_count + 1) * sizeof(unsigned int));
+    if (bound == NULL)
+        return NULL;
+
+    for (i = 0; i <= dst_count; i++)
+        bound[i] = (unsigned int)(((unsigned long long)i * src_count) / dst_count);
+
+    return bound;
+}
+
+static unsigned int *scale_make_recip(unsigned int max_area)
+{
+    unsigned int *recip;
+    unsigned int i;
+
+    recip = (unsigned int *)malloc((max_area + 1) * sizeof(unsigned int));
+    if (recip == NULL)
+        return NULL;
+
+    recip[0] = 0;
+    for (i = 1; i <= max_area; i++)
+        recip[i] = ((1 << SCALE_RECIP_SHIFT) + (i >> 1)) / i;
+
+    return recip;
+}
+
+static void scale_accumulate_row(
+    unsigned short *acc,
+    unsigned char *src,
+    unsigned int size)
+{
+    unsigned int i = 0;
+
+#if defined(__ARM_NEON__)
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t pix = vld1q_u8(src + i);
+        uint16x8_t lo = vld1q_u16(acc + i);
+        uint16x8_t hi = vld1q_u16(acc + i + 8);
+
+        vst1q_u16(acc + i, vaddw_u8(lo, vget_low_u8(pix)));
+        vst1q_u16(acc + i + 8, vaddw_u8(hi, vget_high_u8(pix)));
+    }
+#elif defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i pix = _mm_loadu_si128((__m128i *)(src + i));
+        __m128i lo = _mm_loadu_si128((__m128i *)(acc + i));
+        __m128i hi = _mm_loadu_si128((__m128i *)(acc + i + 8));
+
+        _mm_storeu_si128((__m128i *)(acc + i), _mm_add_epi16(lo, _mm_unpacklo_epi8(pix, zero)));
+        _mm_storeu_si128((__m128i *)(acc + i + 8), _mm_add_epi16(hi, _mm_unpackhi_epi8(pix, zero)));
+    }
+#endif
+
+    for (; i < size; i++)
+        acc[i] += src[i];
+}
+
+static void scale_box_row(
+    unsigned char *dst,
+    unsigned int dst_step,
+    unsigned short *acc,
+    unsigned int src_step,
+    unsigned int count,
+    unsigned int cols,
+    unsigned int shift)
+{
+    unsigned int round = (1 << shift) >> 1;
+    unsigned int box_step = cols * src_step;
+    unsigned int x, i, sum;
+
+    switch (cols) {
+    case 1:
+        for (x = 0; x < count; x++, acc += box_step, dst += dst_step)
+            *dst = (unsigned char)((acc[0] + round) >> shift);
+        break;
+    case 2:
+        for (x = 0; x < count; x++, acc += box_step, dst += dst_step)
+            *dst = (unsigned char)((acc[0] + acc[src_step] + round) >> shift);
+        break;
+    case 4:
+        for (x = 0; x < count; x++, acc += box_step, dst += dst_step)
+            *dst = (unsigned char)((acc[0] + acc[src_step] + acc[src_step * 2] +
+                                    acc[src_step * 3] + round) >> shift);
+        break;
+    default:
+        for (x = 0; x < count; x++, acc += box_step, dst += dst_step) {
+            sum = 0;
+            for (i = 0; i < box_step; i += src_step)
+                sum += acc[i];
+            *dst = (unsigned char)((sum + round) >> shift);
+        }
+        break;
+    }
+}
+
+static int scale_plane_band(SCALE_PLANE *plane)
+{
+    unsigned short *acc;
+    unsigned char *dst_row;
+    SCALE_COMPONENT *comp;
+    unsigned int y, x, c, i;
+    unsigned int rows, sum, first, last;
+
+    acc = (unsigned short *)malloc(plane->row_bytes * sizeof(unsigned short));
+    if (acc == NULL)
+        return -1;
+
+    for (y = plane->dst_row_start; y < plane->dst_row_end; y++) {
+        memset(acc, 0, plane->row_bytes * sizeof(unsigned short));
+
+        for (i = plane->row_bound[y]; i < plane->row_bound[y + 1]; i++)
+            scale_accumulate_row(acc, plane->src + (i * plane->src_stride), plane->row_bytes);
+
+        rows = plane->row_bound[y + 1] - plane->row_bound[y];
+        dst_row = plane->dst + (y * plane->dst_stride);
+
+        for (c = 0; c < plane->comp_num; c++) {
+            comp = &plane->comp[c];
+
+            if (plane->box_cols != 0) {
+                scale_box_row(dst_row + comp->dst_offset, comp->dst_step,
+                              acc + comp->src_offset, comp->src_step,
+                              comp->dst_count, plane->box_cols, plane->box_shift);
+                continue;
+            }
+
+            for (x = 0; x < comp->dst_count; x++) {
+                first = comp->bound[x];
+                last = comp->bound[x + 1];
+
+                sum = 0;
+                for (i = first; i < last; i++)
+                    sum += acc[comp->src_offset + (i * comp->src_step)];
+
+                sum = (sum * plane->recip[rows * (last - first)] + (1 << (SCALE_RECIP_SHIFT - 1))) >> SCALE_RECIP_SHIFT;
+                dst_row[comp->dst_offset + (x * comp->dst_step)] = (unsigned char)((sum > 255) ? 255 : sum);
+            }
+        }
+    }
+
+    free(acc);
+
+    return 0;
+}
+
+static void *scale_plane_thread(void *arg)
+{
+    SCALE_PLANE *plane = (SCALE_PLANE *)arg;
+
+    plane->ret = scale_plane_band(plane);
+
+    return NULL;
+}
+
+static int scale_plane(SCALE_PLANE *plane, unsigned int dst_height)
+{
+    SCALE_PLANE band[SCALE_MAX_THREADS];
+    pthread_t thread[SCALE_MAX_THREADS];
+    int started[SCALE_MAX_THREADS];
+    unsigned int band_num, band_rows, i;
+    int ret;
+
+    band_num = dst_height / SCALE_MIN_BAND_ROWS;
+    if (band_num > SCALE_MAX_THREADS)
+        band_num = SCALE_MAX_THREADS;
+    if (band_num < 1)
+        band_num = 1;
+    band_rows = (dst_height + band_num - 1) / band_num;
+
+    for (i = 0; i < band_num; i++) {
+        band[i] = *plane;
+        band[i].dst_row_start = i * band_rows;
+        band[i].dst_row_end = (i + 1) * band_rows;
+        if (band[i].dst_row_end > dst_height)
+            band[i].dst_row_end = dst_height;
+        started[i] = 0;
+    }
+
+    /* band 0 runs on the calling thread */
+    for (i = 1; i < band_num; i++) {
+        if (pthread_create(&thread[i], NULL, scale_plane_thread, &band[i]) == 0)
+            started[i] = 1;
+    }
+
+    ret = scale_plane_band(&band[0]);
+
+    for (i = 1; i < band_num; i++) {
+        if (started[i])
+            pthread_join(thread[i], NULL);
+        else
+            band[i].ret = scale_plane_band(&band[i]);
+
+        if (band[i].ret != 0)
+            ret = -1;
+    }
+
+    return ret;
+}
+
+/* log2 of the box area when every box is the same power of two size, else -1 */
+static int scale_box_shift(
+    unsigned int dst_width,
+    unsigned int dst_height,
+    unsigned int src_width,
+    unsigned int src_height)
+{
+    unsigned int area;
+    int shift = 0;
+
+    if (((src_width % dst_width) != 0) || ((src_height % dst_height) != 0))
+        return -1;
+
+    area = (src_width / dst_width) * (src_height / dst_height);
+    if ((area & (area - 1)) != 0)
+        return -1;
+
+    while ((1U << shift) < area)
+        shift++;
+
+    return shift;
+}
+
+static int scale_check_size(
+    unsigned int dst_width,
+    unsigned int dst_height,
+    unsigned int src_width,
+    unsigned int src_height)
+{
+    if ((dst_width == 0) || (dst_height == 0) ||
+        (dst_width & 0x01) || (src_width & 0x01))
+        return -1;
+
+    if ((dst_width > src_width) || (dst_height > src_height))
+        return -1;
+
+    /* keeps a column of source rows within the 16-bit accumulator */
+    if ((src_width / dst_width >= SCALE_MAX_RATIO) ||
+        (src_height / dst_height >= SCALE_MAX_RATIO))
+        return -1;
+
+    return 0;
+}
+
+int csc_scale_down_YUYV(
+    unsigned char *dst,
+    unsigned int dst_width,
+    unsigned int dst_height,
+    unsigned char *src,
+    unsigned int src_width,
+    unsigned int src_height)
+{
+    SCALE_PLANE plane;
+    unsigned int *luma_bound, *chroma_bound;
+    unsigned int max_cols, max_rows;
+    int box_shift;
+    int ret = -1;
+
+    if (scale_check_size(dst_width, dst_height, src_width, src_height) != 0)
+        return -1;
+
+    memset(&plane, 0, sizeof(plane));
+    luma_bound = scale_make_bound(src_width, dst_width);
+    chroma_bound = scale_make_bound(src_width >> 1, dst_width >> 1);
+    plane.row_bound = scale_make_bound(src_height, dst_height);
+
+    max_cols = (src_width + dst_width - 1) / dst_width + 1;
+    max_rows = (src_height + dst_height - 1) / dst_height + 1;
+    plane.recip = scale_make_recip(max_cols * max_rows);
+
+    if ((luma_bound == NULL) || (chroma_bound == NULL) ||
+        (plane.row_bound == NULL) || (plane.recip == NULL))
+        goto EXIT;
+
+    box_shift = scale_box_shift(dst_width, dst_height, src_width, src_height);
+    if (box_shift >= 0) {
+        plane.box_cols = src_width / dst_width;
+        plane.box_shift = box_shift;
+    }
+
+    plane.src = src;
+    plane.src_stride = src_width * 2;
+    plane.dst = dst;
+    plane.dst_stride = dst_width * 2;
+    plane.row_bytes = src_width * 2;
+
+    /* Y0 U Y1 V */
+    plane.comp[0].src_offset = 0;
+    plane.comp[0].src_step = 2;
+    plane.comp[0].dst_offset = 0;
+    plane.comp[0].dst_step = 2;
+    plane.comp[0].dst_count = dst_width;
+    plane.comp[0].bound = luma_bound;
+
+    plane.comp[1].src_offset = 1;
+    plane.comp[1].src_step = 4;
+    plane.comp[1].dst_offset = 1;
+    plane.comp[1].dst_step = 4;
+    plane.comp[1].dst_count = dst_width >> 1;
+    plane.comp[1].bound = chroma_bound;
+
+    plane.comp[2] = plane.comp[1];
+    plane.comp[2].src_offset = 3;
+    plane.comp[2].dst_offset = 3;
+
+    plane.comp_num = 3;
+
+    ret = scale_plane(&plane, dst_height);
+
+EXIT:
+    free(luma_bound);
+    free(chroma_bound);
+    free(plane.row_bound);
+    free(plane.recip);
+
+    return ret;
+}
+
+int csc_scale_down_YUV422SP(
+    unsigned char *y_dst,
+    unsigned char *uv_dst,
+    unsigned int dst_width,
+    unsigned int dst_height,
+    unsigned char *y_src,
+    unsigned char *uv_src,
+    unsigned int src_width,
+    unsigned int src_height)
+{
+    SCALE_PLANE plane;
+    unsigned int *luma_bound, *chroma_bound;
+    unsigned int max_cols, max_rows;
+    int box_shift;
+    int ret = -1;
+
+    if (scale_check_size(dst_width, dst_height, src_width, src_height) != 0)
+        return -1;
+
+    memset(&plane, 0, sizeof(plane));
+    luma_bound = scale_make_bound(src_width, dst_width);
+    chroma_bound = scale_make_bound(src_width >> 1, dst_width >> 1);
+    plane.row_bound = scale_make_bound(src_height, dst_height);
+
+    max_cols = (src_width + dst_width - 1) / dst_width + 1;
+    max_rows = (src_height + dst_height - 1) / dst_height + 1;
+    plane.recip = scale_make_recip(max_cols * max_rows);
+
+    if ((luma_bound == NULL) || (chroma_bound == NULL) ||
+        (plane.row_bound == NULL) || (plane.recip == NULL))
+        goto EXIT;
+
+    box_shift = scale_box_shift(dst_width, dst_height, src_width, src_height);
+    if (box_shift >= 0) {
+        plane.box_cols = src_width / dst_width;
+        plane.box_shift = box_shift;
+    }
+
+    /* Y plane */
+    plane.src = y_src;
+    plane.src_stride = src_width;
+    plane.dst = y_dst;
+    plane.dst_stride = dst_width;
+    plane.row_bytes = src_width;
+
+    plane.comp[0].src_offset = 0;
+    plane.comp[0].src_step = 1;
+    plane.comp[0].dst_offset = 0;
+    plane.comp[0].dst_step = 1;
+    plane.comp[0].dst_count = dst_width;
+    plane.comp[0].bound = luma_bound;
+    plane.comp_num = 1;
+
+    if (scale_plane(&plane, dst_height) != 0)
+        goto EXIT;
+
+    /* interleaved chroma plane, full height for 4:2:2 */
+    plane.src = uv_src;
+    plane.dst = uv_dst;
+
+    plane.comp[0].src_step = 2;
+    plane.comp[0].dst_step = 2;
+    plane.comp[0].dst_count = dst_width >> 1;
+    plane.comp[0].bound = chroma_bound;
+
+    plane.comp[1] = plane.comp[0];
+    plane.comp[1].src_offset = 1;
+    plane.comp[1].dst_offset = 1;
+    plane.comp_num = 2;
+
+    ret = scale_plane(&plane, dst_height);
+
+EXIT:
+    free(luma_bound);
+    free(chroma_bound);
+    free(plane.row_bound);
+    free(plane.recip);
+
+    return ret;
+}
+
+static void convert_YUYV_row_pair(
+    unsigned char *y_dst0,
+    unsigned char *y_dst1,
+    unsigned char *vu_dst,
+    unsigned char *src0,
+    unsigned char *src1,
+    unsigned int width)
+{
+    unsigned int i = 0;
+
+#if defined(__ARM_NEON__)
+    for (; i + 16 <= width; i += 16) {
+        uint8x16x2_t row0 = vld2q_u8(src0 + (i * 2));
+        uint8x16x2_t row1 = vld2q_u8(src1 + (i * 2));
+
+        vst1q_u8(y_dst0 + i, row0.val[0]);
+        vst1q_u8(y_dst1 + i, row1.val[0]);
+        /* U V pairs, rounded average of both rows, swapped to V U */
+        vst1q_u8(vu_dst + i, vrev16q_u8(vrhaddq_u8(row0.val[1], row1.val[1])));
+    }
+#elif defined(__SSE2__)
+    __m128i luma_mask = _mm_set1_epi16(0x00ff);
+
+    for (; i + 16 <= width; i += 16) {
+        __m128i a0 = _mm_loadu_si128((__m128i *)(src0 + (i * 2)));
+        __m128i b0 = _mm_loadu_si128((__m128i *)(src0 + (i * 2) + 16));
+        __m128i a1 = _mm_loadu_si128((__m128i *)(src1 + (i * 2)));
+        __m128i b1 = _mm_loadu_si128((__m128i *)(src1 + (i * 2) + 16));
+        __m128i uv;
+
+        _mm_storeu_si128((__m128i *)(y_dst0 + i),
+            _mm_packus_epi16(_mm_and_si128(a0, luma_mask), _mm_and_si128(b0, luma_mask)));
+        _mm_storeu_si128((__m128i *)(y_dst1 + i),
+            _mm_packus_epi16(_mm_and_si128(a1, luma_mask), _mm_and_si128(b1, luma_mask)));
+
+        uv = _mm_avg_epu8(
+            _mm_packus_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(b0, 8)),
+            _mm_packus_epi16(_mm_srli_epi16(a1, 8), _mm_srli_epi16(b1, 8)));
+        uv = _mm_or_si128(_mm_slli_epi16(uv, 8), _mm_srli_epi16(uv, 8));
+        _mm_storeu_si128((__m128i *)(vu_dst + i), uv);
+    }
+#endif
+
+    for (; i < width; i += 2) {
+        y_dst0[i]     = src0[(i * 2)];
+        y_dst0[i + 1] = src0[(i * 2) + 2];
+        y_dst1[i]     = src1[(i * 2)];
+        y_dst1[i + 1] = src1[(i * 2) + 2];
+        vu_dst[i]     = (src0[(i * 2) + 3] + src1[(i * 2) + 3] + 1) >> 1;
+        vu_dst[i + 1] = (src0[(i * 2) + 1] + src1[(i * 2) + 1] + 1) >> 1;
+    }
+}
+
+int csc_YUYV_to_YUV420SP_NV21(
+    unsigned char *y_dst,
+    unsigned char *vu_dst,
+    unsigned char *src,
+    unsigned int width,
+    unsigned int height)
+{
+    unsigned int y;
+    unsigned int src_stride = width * 2;
+
+    if ((width == 0) || (height == 0) || (width & 0x01))
+        return -1;
+
+    for (y = 0; y + 1 < height; y += 2) {
+        convert_YUYV_row_pair(y_dst + (y * width), y_dst + ((y + 1) * width),
+                              vu_dst + ((y >> 1) * width),
+                              src + (y * src_stride), src + ((y + 1) * src_stride),
+                              width);
+    }
+
+    /* an odd last row has no partner, its chroma stands alone */
+    if (height & 0x01) {
+        convert_YUYV_row_pair(y_dst + (y * width), y_dst + (y * width),
+                              vu_dst + ((y >> 1) * width),
+                              src + (y * src_stride), src + (y * src_stride),
+                              width);
+    }
+
+    return 0;
+}
+
+int csc_scale_down_YUYV_to_YUV420SP_NV21(
+    unsigned char *y_dst,
+    unsigned char *vu_dst,
+    unsigned int dst_width,
+    unsigned int dst_height,
+    unsigned char *src,
+    unsigned int src_width,
+    unsigned int src_height)
+{
+    SCALE_PLANE plane;
+    unsigned int *luma_bound, *chroma_bound;
+    unsigned int *luma_row_bound, *chroma_row_bound;
+    unsigned int max_cols, max_rows;
+    int ret = -1;
+
+    if ((dst_width == src_width) && (dst_height == src_height))
+        return csc_YUYV_to_YUV420SP_NV21(y_dst, vu_dst, src, src_width, src_height);
+
+    if ((dst_height & 0x01) ||
+        (scale_check_size(dst_width, dst_height, src_width, src_height) != 0))
+        return -1;
+
+    /* chroma boxes span twice the rows, keep them within the accumulator too */
+    if (src_height / (dst_height >> 1) >= SCALE_MAX_RATIO)
+        return -1;
+
+    memset(&plane, 0, sizeof(plane));
+    luma_bound = scale_make_bound(src_width, dst_width);
+    chroma_bound = scale_make_bound(src_width >> 1, dst_width >> 1);
+    luma_row_bound = scale_make_bound(src_height, dst_height);
+    chroma_row_bound = scale_make_bound(src_height, dst_height >> 1);
+
+    max_cols = (src_width + dst_width - 1) / dst_width + 1;
+    max_rows = (src_height + (dst_height >> 1) - 1) / (dst_height >> 1) + 1;
+    plane.recip = scale_make_recip(max_cols * max_rows);
+
+    if ((luma_bound == NULL) || (chroma_bound == NULL) ||
+        (luma_row_bound == NULL) || (chroma_row_bound == NULL) ||
+        (plane.recip == NULL))
+        goto EXIT;
+
+    /* Y0 of every YUYV pair straight into the Y plane */
+    plane.src = src;
+    plane.row_bound = luma_row_bound;
+    plane.src_stride = src_width * 2;
+    plane.dst = y_dst;
+    plane.dst_stride = dst_width;
+    plane.row_bytes = src_width * 2;
+
+    plane.comp[0].src_offset = 0;
+    plane.comp[0].src_step = 2;
+    plane.comp[0].dst_offset = 0;
+    plane.comp[0].dst_step = 1;
+    plane.comp[0].dst_count = dst_width;
+    plane.comp[0].bound = luma_bound;
+    plane.comp_num = 1;
+
+    if (scale_plane(&plane, dst_height) != 0)
+        goto EXIT;
+
+    /* V and U averaged over two destination rows worth of source */
+    plane.dst = vu_dst;
+    plane.row_bound = chroma_row_bound;
+
+    plane.comp[0].src_offset = 3;
+    plane.comp[0].src_step = 4;
+    plane.comp[0].dst_offset = 0;
+    plane.comp[0].dst_step = 2;
+    plane.comp[0].dst_count = dst_width >> 1;
+    plane.comp[0].bound = chroma_bound;
+
+    plane.comp[1] = plane.comp[0];
+    plane.comp[1].src_offset = 1;
+    plane.comp[1].dst_offset = 1;
+    plane.comp_num = 2;
+
+    ret = scale_plane(&plane, dst_height >> 1);
+
+EXIT:
+    free(luma_bound);
+    free(chroma_bound);
+    free(luma_row_bound);
+    free(chroma_row_bound);
+    free(plane.recip);
+
+    return ret;
+}